@@ -0,0 +1,257 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief Delta compression of sample streams, see t1_delta.h.
+ */
+
+#include <Proj_library/h_files/t1_delta.h>
+
+/* Cycle costs charged through SIM_CYCLES(): modelled, not measured on the target. */
+#define SAMPLE_CYCLES   14u     ///< Modelled MCLK cycles of a difference and its zig-zag.
+#define BYTE_CYCLES     9u      ///< Modelled, a varint byte.
+#define BIT_CYCLES      7u      ///< Modelled, a Rice code bit.
+#define K_CYCLES        4u      ///< Modelled, a step of the search for k.
+
+#define RICE_ACC_INIT   64u     ///< Running mean of 4 to start with.
+#define RICE_U_MAX      4095u   ///< Largest value counted in the mean, acc stays below 2^16.
+#define RICE_K_MAX      11u
+
+// 0, -1, 1, -2, ... to 0, 1, 2, 3, ...
+static uint16_t zigzag(uint16_t d)
+{
+    return (uint16_t)((d << 1) ^ (0u - (d >> 15)));
+}
+
+static uint16_t unzigzag(uint16_t u)
+{
+    return (uint16_t)((u >> 1) ^ (0u - (u & 1u)));
+}
+
+#ifdef T1_DELTA_RICE
+
+//***** Rice codes ********************************************************************
+
+static uint8_t rice_k(uint16_t acc)
+{
+    uint8_t k = 0;
+
+    while ((k < RICE_K_MAX) && ((16u << k) < acc)) {
+        k++;
+    }
+    SIM_CYCLES(K_CYCLES * (k + 1u));
+    return k;
+}
+
+static uint16_t rice_mean(uint16_t acc, uint16_t u)
+{
+    return acc - (acc >> 4) + ((u < RICE_U_MAX) ? u : RICE_U_MAX);
+}
+
+// The n low bits of v, MSB first.
+static void put_bits(delta_enc_t *e, uint16_t v, uint8_t n)
+{
+    uint8_t *b, m;
+
+    SIM_CYCLES(BIT_CYCLES * n);
+    while (n--) {
+        b = &e->buf[e->pos >> 3];
+        m = 0x80u >> (e->pos & 7u);
+        if ((v >> n) & 1u) {
+            *b |= m;
+        }
+        else {
+            *b &= ~m;
+        }
+        e->pos++;
+    }
+}
+
+static uint16_t get_bits(delta_dec_t *d, uint8_t n)
+{
+    uint16_t v = 0;
+
+    SIM_CYCLES(BIT_CYCLES * n);
+    while (n--) {
+        v = (v << 1) | ((d->buf[d->pos >> 3] >> (7u - (d->pos & 7u))) & 1u);
+        d->pos++;
+    }
+    return v;
+}
+
+void delta_begin(delta_enc_t *e, uint8_t *buf, uint8_t size)
+{
+    e->buf = buf;
+    e->size = size;
+    e->pos = 0;
+    e->last = 0;
+    e->acc = RICE_ACC_INIT;
+}
+
+error_t delta_put(delta_enc_t *e, int16_t sample)
+{
+    uint16_t u = zigzag((uint16_t) sample - (uint16_t) e->last);
+    uint8_t k = rice_k(e->acc), bits;
+    uint16_t q = u >> k;
+
+    if (!e->pos) {
+        bits = 16u;     // The first sample as it is.
+    }
+    else {
+        bits = (q < DELTA_RICE_ESC) ? (uint8_t)(q + 1u + k) : DELTA_RICE_ESC + 16u;
+    }
+    if (e->pos + bits > 8u * e->size) {
+        return ERROR_NOBUFS;
+    }
+
+    if (!e->pos) {
+        put_bits(e, (uint16_t) sample, 16u);
+    }
+    else {
+        if (q < DELTA_RICE_ESC) {
+            put_bits(e, 0xFFFFu, (uint8_t) q);
+            put_bits(e, 0u, 1u);
+            put_bits(e, u, k);
+        }
+        else {
+            put_bits(e, 0xFFFFu, DELTA_RICE_ESC);
+            put_bits(e, u, 16u);
+        }
+        e->acc = rice_mean(e->acc, u);
+    }
+    e->last = sample;
+    SIM_CYCLES(SAMPLE_CYCLES);
+    return ERROR_OK;
+}
+
+uint8_t delta_end(delta_enc_t *e)
+{
+    // One bits to the end of the byte, read back as a code cut short.
+    put_bits(e, 0xFFFFu, (uint8_t)((8u - (e->pos & 7u)) & 7u));
+    return (uint8_t)(e->pos >> 3);
+}
+
+void delta_open(delta_dec_t *d, const uint8_t *buf, uint8_t len)
+{
+    d->buf = buf;
+    d->len = len;
+    d->pos = 0;
+    d->last = 0;
+    d->acc = RICE_ACC_INIT;
+}
+
+error_t delta_get(delta_dec_t *d, int16_t *sample)
+{
+    uint16_t end = 8u * d->len, start = d->pos, u;
+    uint8_t k, q;
+
+    if (d->pos >= end) {
+        return ERROR_NOBUFS;
+    }
+    if (!d->pos) {
+        if (end < 16u) {
+            return ERROR_RANGE;
+        }
+        d->last = (int16_t) get_bits(d, 16u);
+        *sample = d->last;
+        return ERROR_OK;
+    }
+
+    k = rice_k(d->acc);
+    for (q = 0; q < DELTA_RICE_ESC; q++) {
+        if (d->pos >= end) {
+            // Ones from inside the last byte to its end are the padding.
+            d->pos = end;
+            if ((start & 7u) && ((unsigned)(end - start) < 8u)) {
+                return ERROR_NOBUFS;
+            }
+            return ERROR_RANGE;
+        }
+        if (!get_bits(d, 1u)) {
+            break;
+        }
+    }
+    if ((unsigned)(end - d->pos) < ((q < DELTA_RICE_ESC) ? k : 16u)) {
+        d->pos = end;
+        return ERROR_RANGE;
+    }
+    if (q < DELTA_RICE_ESC) {
+        u = (uint16_t)(((uint16_t) q << k) | get_bits(d, k));
+    }
+    else {
+        u = get_bits(d, 16u);
+    }
+    d->acc = rice_mean(d->acc, u);
+    d->last = (int16_t)((uint16_t) d->last + unzigzag(u));
+    *sample = d->last;
+    SIM_CYCLES(SAMPLE_CYCLES);
+    return ERROR_OK;
+}
+
+#else
+
+//***** Varints ***********************************************************************
+
+void delta_begin(delta_enc_t *e, uint8_t *buf, uint8_t size)
+{
+    e->buf = buf;
+    e->size = size;
+    e->pos = 0;
+    e->last = 0;
+}
+
+error_t delta_put(delta_enc_t *e, int16_t sample)
+{
+    uint16_t u = zigzag((uint16_t) sample - (uint16_t) e->last);
+    uint8_t bytes = (u < 0x80u) ? 1u : (u < 0x4000u) ? 2u : 3u;
+
+    if (e->pos + bytes > e->size) {
+        return ERROR_NOBUFS;
+    }
+    while (u >= 0x80u) {
+        e->buf[e->pos++] = (uint8_t) u | 0x80u;
+        u >>= 7;
+    }
+    e->buf[e->pos++] = (uint8_t) u;
+    e->last = sample;
+    SIM_CYCLES(SAMPLE_CYCLES + BYTE_CYCLES * bytes);
+    return ERROR_OK;
+}
+
+uint8_t delta_end(delta_enc_t *e)
+{
+    return (uint8_t) e->pos;
+}
+
+void delta_open(delta_dec_t *d, const uint8_t *buf, uint8_t len)
+{
+    d->buf = buf;
+    d->len = len;
+    d->pos = 0;
+    d->last = 0;
+}
+
+error_t delta_get(delta_dec_t *d, int16_t *sample)
+{
+    uint16_t u = 0;
+    uint8_t b, shift = 0;
+
+    if (d->pos >= d->len) {
+        return ERROR_NOBUFS;
+    }
+    do {
+        if ((d->pos >= d->len) || (shift > 14u)) {
+            d->pos = d->len;
+            return ERROR_RANGE;
+        }
+        b = d->buf[d->pos++];
+        u |= (uint16_t)(b & 0x7Fu) << shift;
+        shift += 7u;
+        SIM_CYCLES(BYTE_CYCLES);
+    } while (b & 0x80u);
+    d->last = (int16_t)((uint16_t) d->last + unzigzag(u));
+    *sample = d->last;
+    SIM_CYCLES(SAMPLE_CYCLES);
+    return ERROR_OK;
+}
+
+#endif // T1_DELTA_RICE
@@ -0,0 +1,84 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief Stored energy and radio energy estimates, see t1_energy.h.
+ */
+
+#include <Proj_library/h_files/t1_energy.h>
+#include <Proj_library/h_files/t1_zeta.h>
+
+#define AIR_OVERHEAD 11u    ///< Preamble, sync, length and CRC bytes on air.
+
+// RF bit rates of zeta_set_baud_rf().
+static const uint32_t rf_bps[7] = {0, 4800, 9600, 38400, 128000, 256000, 500000};
+
+//*************************************************************************************
+error_t supply_mv(uint16_t *mv)
+{
+    uint16_t n;
+    uint16_t code;
+
+    // 2.0V reference.
+    REFCTL0 = REFVSEL_1 + REFON;
+    while (!(REFCTL0 & REFGENRDY))
+        ;
+
+    // Single conversion of AVCC/2, 12-bit, 16 MODOSC cycles of sampling.
+    ADC12CTL0 = ADC12SHT0_2 + ADC12ON;
+    ADC12CTL1 = ADC12SHP;
+    ADC12CTL2 = ADC12RES_2;
+    ADC12CTL3 = ADC12BATMAP;
+    ADC12MCTL0 = ADC12INCH_31 + ADC12VRSEL_1 + ADC12EOS;
+    ADC12IFGR0 = 0;
+    ADC12CTL0 |= ADC12ENC + ADC12SC;
+
+    for (n = 0; (n < ADC_TIMEOUT) && !(ADC12IFGR0 & ADC12IFG0); n++)
+        ;
+    code = ADC12MEM0;
+
+    ADC12CTL0 &= ~ADC12ENC;
+    ADC12CTL0 = 0;
+    REFCTL0 = 0;
+
+    if (n == ADC_TIMEOUT) {
+        return ERROR_TIMEOUT;
+    }
+    // mv = 2 * code * ADC_VREF_MV / 4096.
+    *mv = (uint16_t)(((uint32_t) code * ADC_VREF_MV) >> 11);
+    return ERROR_OK;
+}
+
+//*************************************************************************************
+uint32_t energy_available(uint16_t mv)
+{
+    uint32_t dv2;
+
+    if (mv <= STORE_MIN_MV) {
+        return 0;
+    }
+    dv2 = (uint32_t) mv * mv - (uint32_t) STORE_MIN_MV * STORE_MIN_MV;    // [mV^2]
+    return (uint32_t)((uint64_t) dv2 * STORE_UF / 2000000u);
+}
+
+uint32_t energy_airtime_us(uint8_t len, uint8_t baud)
+{
+    if ((baud < 1) || (baud > 6)) {
+        return 0;
+    }
+    return ((uint32_t) len + AIR_OVERHEAD) * 8000000UL / rf_bps[baud];
+}
+
+uint32_t energy_tx(uint8_t len, uint8_t baud, uint8_t power, uint16_t mv)
+{
+    uint32_t ua = ZETA_I_TX_MIN_UA
+                + (uint32_t)(ZETA_I_TX_MAX_UA - ZETA_I_TX_MIN_UA) * (power & 0x7F) / 127u;
+
+    // [us] * [uA] * [mV] = 1e-15 J.
+    return (uint32_t)((uint64_t) energy_airtime_us(len, baud) * ua * mv / 1000000000UL);
+}
+
+uint32_t energy_wait(uint16_t ua, uint32_t ms, uint16_t mv)
+{
+    // [uA] * [ms] * [mV] = 1e-12 J.
+    return (uint32_t)((uint64_t) ua * ms * mv / 1000000UL);
+}
@@ -0,0 +1,143 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief Cooperative event loop, see t1_event.h.
+ */
+
+#include <stddef.h>
+#include <Proj_library/h_files/t1_event.h>
+#include <Proj_library/h_files/t1_zeta.h>
+
+typedef struct {
+    uint8_t ev;
+    uint8_t arg;
+} event_entry_t;
+
+static event_entry_t queue[EVENT_QUEUE_LEN];
+static volatile uint8_t head, tail;
+static event_handler_t handlers[EVENTS];
+static uint16_t lpm = LPM3_bits;
+static uint8_t comp_level;
+static volatile uint8_t running;
+
+uint8_t event_dropped = 0;
+
+//*************************************************************************************
+void event_init(void)
+{
+    uint8_t k;
+
+    head = tail = 0;
+    for (k = 0; k < EVENTS; k++) {
+        handlers[k] = NULL;
+    }
+    lpm = LPM3_bits;
+    comp_level = COMPARATOR_ON ? 1 : 0;
+}
+
+void event_handler(event_t ev, event_handler_t handler)
+{
+    if (ev < EVENTS) {
+        handlers[ev] = handler;
+    }
+}
+
+error_t event_post(event_t ev, uint8_t arg)
+{
+    uint16_t gie = __get_SR_register() & GIE;
+    uint8_t next;
+    error_t err = ERROR_OK;
+
+    if (ev >= EVENTS) {
+        return ERROR_RANGE;
+    }
+    __disable_interrupt();
+    next = (head + 1) % EVENT_QUEUE_LEN;
+    if (next == tail) {
+        event_dropped++;
+        err = ERROR_NOBUFS;
+    }
+    else {
+        queue[head].ev = ev;
+        queue[head].arg = arg;
+        head = next;
+    }
+    __bis_SR_register(gie);
+    return err;
+}
+
+void event_lpm(uint16_t lpm_bits)
+{
+    lpm = lpm_bits & LPM4_bits;
+}
+
+void event_radio_arm(void)
+{
+    // High-to-low edge. Changing PxIES can set the flag, clear it afterwards.
+    P3IES |= IRQ;
+    P3IFG &= ~IRQ;
+    if (!(P3IN & IRQ)) {
+        SIM_MARK("nIRQ");
+        event_post(EVENT_RADIO, 0);     // Already low, there will be no edge.
+        return;
+    }
+    P3IE |= IRQ;
+}
+
+//*************************************************************************************
+void event_run(void)
+{
+    event_entry_t e;
+    uint8_t level;
+
+    running = 1;
+    while (running) {
+        __disable_interrupt();
+        if (head != tail) {
+            e = queue[tail];
+            tail = (tail + 1) % EVENT_QUEUE_LEN;
+        }
+        else if ((level = (COMPARATOR_ON ? 1 : 0)) != comp_level) {
+            comp_level = level;
+            e.ev = EVENT_COMPARATOR;
+            e.arg = level;
+        }
+        else if (handlers[EVENT_MAILBOX] && mailbox_count()) {
+            e.ev = EVENT_MAILBOX;
+            e.arg = 0;
+        }
+        else {
+            // Nothing to do. GIE and the LPM bits are set by one instruction, so an
+            // interrupt posting now cannot slip in between the test and the sleep.
+            __bis_SR_register(lpm + GIE);
+            continue;
+        }
+        __enable_interrupt();
+
+        if (handlers[e.ev]) {
+            handlers[e.ev](e.arg);
+        }
+    }
+    __enable_interrupt();
+}
+
+void event_stop(void)
+{
+    running = 0;
+}
+
+//*************************************************************************************
+#pragma vector=PORT3_VECTOR
+__interrupt void PORT3_ISR(void)
+{
+    switch (__even_in_range(P3IV, P3IV_P3IFG7)) {
+    case P3IV_P3IFG5:
+        SIM_MARK("nIRQ");
+        P3IE &= ~IRQ;       // One event per event_radio_arm().
+        event_post(EVENT_RADIO, 0);
+        __bic_SR_register_on_exit(LPM4_bits);
+        break;
+    default:
+        break;
+    }
+}
@@ -0,0 +1,92 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief Forward error correction of the radio packets, see t1_fec.h.
+ */
+
+#include <Proj_library/h_files/t1_fec.h>
+
+#ifdef T1_FEC
+
+/* Charged through SIM_CYCLES(); modelled from the instructions, not measured on the target. */
+#define CODE_CYCLES     6u      ///< Modelled MCLK cycles of a table lookup.
+#define BIT_CYCLES      6u      ///< Modelled, a bit moved by the interleaver.
+
+#define DEC_FIXED       0x10u   ///< decode[]: a bit error corrected.
+#define DEC_BAD         0x80u   ///< decode[]: two bit errors.
+
+// Codeword of each nibble.
+static const uint8_t encode[16] = {
+    0x00, 0x17, 0x2B, 0x3C, 0x4D, 0x5A, 0x66, 0x71,
+    0x8E, 0x99, 0xA5, 0xB2, 0xC3, 0xD4, 0xE8, 0xFF
+};
+
+// Nibble of each received byte, nearest codeword, with DEC_FIXED or DEC_BAD.
+static const uint8_t decode[256] = {
+    0x00, 0x10, 0x10, 0x80, 0x10, 0x80, 0x80, 0x11, 0x10, 0x80, 0x80, 0x12,
+    0x80, 0x14, 0x18, 0x80, 0x10, 0x80, 0x80, 0x11, 0x80, 0x11, 0x11, 0x01,
+    0x80, 0x19, 0x15, 0x80, 0x13, 0x80, 0x80, 0x11, 0x10, 0x80, 0x80, 0x12,
+    0x80, 0x1A, 0x16, 0x80, 0x80, 0x12, 0x12, 0x02, 0x13, 0x80, 0x80, 0x12,
+    0x80, 0x17, 0x1B, 0x80, 0x13, 0x80, 0x80, 0x11, 0x13, 0x80, 0x80, 0x12,
+    0x03, 0x13, 0x13, 0x80, 0x10, 0x80, 0x80, 0x1C, 0x80, 0x14, 0x16, 0x80,
+    0x80, 0x14, 0x15, 0x80, 0x14, 0x04, 0x80, 0x14, 0x80, 0x17, 0x15, 0x80,
+    0x1D, 0x80, 0x80, 0x11, 0x15, 0x80, 0x05, 0x15, 0x80, 0x14, 0x15, 0x80,
+    0x80, 0x17, 0x16, 0x80, 0x16, 0x80, 0x06, 0x16, 0x1E, 0x80, 0x80, 0x12,
+    0x80, 0x14, 0x16, 0x80, 0x17, 0x07, 0x80, 0x17, 0x80, 0x17, 0x16, 0x80,
+    0x80, 0x17, 0x15, 0x80, 0x13, 0x80, 0x80, 0x1F, 0x10, 0x80, 0x80, 0x1C,
+    0x80, 0x1A, 0x18, 0x80, 0x80, 0x19, 0x18, 0x80, 0x18, 0x80, 0x08, 0x18,
+    0x80, 0x19, 0x1B, 0x80, 0x1D, 0x80, 0x80, 0x11, 0x19, 0x09, 0x80, 0x19,
+    0x80, 0x19, 0x18, 0x80, 0x80, 0x1A, 0x1B, 0x80, 0x1A, 0x0A, 0x80, 0x1A,
+    0x1E, 0x80, 0x80, 0x12, 0x80, 0x1A, 0x18, 0x80, 0x1B, 0x80, 0x0B, 0x1B,
+    0x80, 0x1A, 0x1B, 0x80, 0x80, 0x19, 0x1B, 0x80, 0x13, 0x80, 0x80, 0x1F,
+    0x80, 0x1C, 0x1C, 0x0C, 0x1D, 0x80, 0x80, 0x1C, 0x1E, 0x80, 0x80, 0x1C,
+    0x80, 0x14, 0x18, 0x80, 0x1D, 0x80, 0x80, 0x1C, 0x0D, 0x1D, 0x1D, 0x80,
+    0x80, 0x19, 0x15, 0x80, 0x1D, 0x80, 0x80, 0x1F, 0x1E, 0x80, 0x80, 0x1C,
+    0x80, 0x1A, 0x16, 0x80, 0x0E, 0x1E, 0x1E, 0x80, 0x1E, 0x80, 0x80, 0x1F,
+    0x80, 0x17, 0x1B, 0x80, 0x1D, 0x80, 0x80, 0x1F, 0x1E, 0x80, 0x80, 0x1F,
+    0x80, 0x1F, 0x1F, 0x0F
+};
+
+void fec_encode(const uint8_t *data, uint8_t n, uint8_t *coded)
+{
+    uint8_t code[2u * FEC_BLOCK], k, b, p = 0;
+
+    for (k = 0; k < n; k++) {
+        code[2u * k] = encode[data[k] >> 4];
+        code[2u * k + 1u] = encode[data[k] & 0x0Fu];
+        coded[2u * k] = coded[2u * k + 1u] = 0;
+    }
+    // Bit b of each codeword in turn, MSB first.
+    n *= 2u;
+    for (b = 8; b-- > 0;) {
+        for (k = 0; k < n; k++, p++) {
+            if ((code[k] >> b) & 1u) {
+                coded[p >> 3] |= 0x80u >> (p & 7u);
+            }
+        }
+    }
+    SIM_CYCLES(n * (CODE_CYCLES + 8u * BIT_CYCLES));
+}
+
+error_t fec_decode(const uint8_t *coded, uint8_t n, uint8_t *data)
+{
+    uint8_t code[2u * FEC_BLOCK] = {0}, k, b, p = 0, hi, lo, bad = 0;
+
+    for (b = 8; b-- > 0;) {
+        for (k = 0; k < 2u * n; k++, p++) {
+            if ((coded[p >> 3] << (p & 7u)) & 0x80u) {
+                code[k] |= 1u << b;
+            }
+        }
+    }
+    for (k = 0; k < n; k++) {
+        hi = decode[code[2u * k]];
+        lo = decode[code[2u * k + 1u]];
+        bad |= hi | lo;
+        data[k] = (uint8_t)((hi << 4) | (lo & 0x0Fu));
+    }
+    SIM_CYCLES(2u * n * (CODE_CYCLES + 8u * BIT_CYCLES));
+    return (bad & DEC_BAD) ? ERROR_CRC : ERROR_OK;
+}
+
+#endif // T1_FEC
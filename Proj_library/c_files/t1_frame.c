@@ -0,0 +1,95 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief Binary payload frames, see t1_frame.h.
+ */
+
+#include <Proj_library/h_files/t1_frame.h>
+
+void frame_begin(frame_t *f, uint8_t *buf, uint8_t size, uint8_t node, uint8_t seq)
+{
+    f->buf = buf;
+    f->size = size;
+    buf[0] = FRAME_VERSION << 4;
+    buf[1] = node;
+    buf[2] = seq;
+    f->len = FRAME_HDR_LEN;
+}
+
+uint8_t *frame_reserve(frame_t *f, uint8_t type, uint8_t len)
+{
+    uint8_t *value;
+
+    if ((type == FRAME_PAD) || ((unsigned) f->size - f->len < FRAME_REC_LEN(len))) {
+        return 0;
+    }
+    f->buf[f->len] = type;
+    f->buf[f->len + 1] = len;
+    value = &f->buf[f->len + 2];
+    f->len += FRAME_REC_LEN(len);
+    return value;
+}
+
+error_t frame_put(frame_t *f, uint8_t type, const void *value, uint8_t len)
+{
+    uint8_t *p = frame_reserve(f, type, len);
+    uint8_t k;
+
+    if (!p) {
+        return ERROR_NOBUFS;
+    }
+    for (k = 0; k < len; k++) {
+        p[k] = ((const uint8_t *) value)[k];
+    }
+    return ERROR_OK;
+}
+
+void frame_trim(frame_t *f, uint8_t *value, uint8_t len)
+{
+    value[-1] = len;
+    f->len = (uint8_t)(value - f->buf) + len;
+}
+
+void frame_pad(frame_t *f, uint8_t len)
+{
+    if (len > f->size) {
+        len = f->size;
+    }
+    for (; f->len < len; f->len++) {
+        f->buf[f->len] = FRAME_PAD;
+    }
+}
+
+error_t frame_open(frame_reader_t *r, const uint8_t *buf, uint8_t len)
+{
+    uint8_t pos = FRAME_HDR_LEN;
+
+    if ((len < FRAME_HDR_LEN) || (buf[0] != (FRAME_VERSION << 4))) {
+        return ERROR_RANGE;
+    }
+    // Every record inside the payload, up to its end or the padding.
+    while ((pos < len) && (buf[pos] != FRAME_PAD)) {
+        if ((len - pos < 2) || (len - pos - 2 < buf[pos + 1])) {
+            return ERROR_RANGE;
+        }
+        pos += FRAME_REC_LEN(buf[pos + 1]);
+    }
+    r->buf = buf;
+    r->len = pos;
+    r->pos = FRAME_HDR_LEN;
+    r->node = buf[1];
+    r->seq = buf[2];
+    return ERROR_OK;
+}
+
+error_t frame_next(frame_reader_t *r, frame_rec_t *rec)
+{
+    if (r->pos >= r->len) {
+        return ERROR_NOBUFS;
+    }
+    rec->type = r->buf[r->pos];
+    rec->len = r->buf[r->pos + 1];
+    rec->value = &r->buf[r->pos + 2];
+    r->pos += FRAME_REC_LEN(rec->len);
+    return ERROR_OK;
+}
@@ -9,7 +9,7 @@
  * @date 02/12/2022
 **/
 
-#include <Proj_Library/h_files/t1_spi.h>
+#include <Proj_library/h_files/t1_spi.h>
 
 void spi_init(void){
 
@@ -50,13 +50,14 @@ void spi_init(void){
 #ifndef MANUAL
     UCB1CTLW0 |= (UCMODE1 | UCSTEM);
 #endif // MANUAL
-    // Running the SPI clk at 1MHz (@SMCLK SPEED).
+    // Running the SPI clk at 1MHz (@SMCLK SPEED), below the Zeta+ limit in every clock profile.
     UCB1CTLW0 |= UCSSEL_2;
+    UCB1BRW = SPI_BRW;
     // initialise the state-machine
     UCB1CTLW0 &= ~UCSWRST;
 }
 
-uint8_t spi_xfer(uint8_t byte)
+RAMFUNC uint8_t spi_xfer(uint8_t byte)
 {
     while (!(UCB1IFG & UCTXIFG0))
         ; // Wait until Tx buffer is ready.
@@ -0,0 +1,76 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief Field statistics in FRAM, see t1_stats.h.
+ */
+
+#include <Proj_library/h_files/t1_stats.h>
+
+#ifdef T1_STATS
+
+#define COUNT_CYCLES    8u      ///< Estimated MCLK cycles of a call and a 32-bit FRAM increment.
+#define RSSI_CYCLES     12u     ///< Estimated, a bin and its saturating increment.
+
+// Only initialised when flashing.
+#pragma PERSISTENT (field_stats)
+field_stats_t field_stats SIM_FRAM = {STATS_MAGIC, STATS_VERSION, STATS_COUNTERS,
+                                      STATS_RSSI_BINS, 0, {0}, {0}};
+
+//*************************************************************************************
+void stats_count(stats_id_t id)
+{
+    field_stats.count[id]++;
+    SIM_CYCLES(COUNT_CYCLES);
+}
+
+void stats_rssi(uint8_t rssi)
+{
+    uint16_t *bin = &field_stats.rssi[rssi / STATS_RSSI_STEP];
+
+    if (*bin != 0xFFFF) {
+        (*bin)++;
+    }
+    SIM_CYCLES(RSSI_CYCLES);
+}
+
+void stats_boot(void)
+{
+    field_stats.restoring = 0;  // A Restore() cut short by the power.
+    field_stats.count[STATS_BOOTS]++;
+    SIM_CYCLES(COUNT_CYCLES);
+}
+
+void stats_restore(void)
+{
+    field_stats.restoring = 1;
+}
+
+void stats_resumed(void)
+{
+    // A checkpoint passes here too, with restoring clear.
+    if (field_stats.restoring) {
+        field_stats.restoring = 0;
+        field_stats.count[STATS_RESTORES]++;
+    }
+}
+
+void stats_restore_failed(void)
+{
+    field_stats.restoring = 0;
+    field_stats.count[STATS_RESTORE_FAILED]++;
+}
+
+void stats_clear(void)
+{
+    uint8_t k;
+
+    for (k = 0; k < STATS_COUNTERS; k++) {
+        field_stats.count[k] = 0;
+    }
+    for (k = 0; k < STATS_RSSI_BINS; k++) {
+        field_stats.rssi[k] = 0;
+    }
+    field_stats.restoring = 0;
+}
+
+#endif // T1_STATS
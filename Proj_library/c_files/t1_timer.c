@@ -0,0 +1,198 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * Software timers sharing Timer_B0, see t1_timer.h.
+ */
+
+#include <stddef.h>
+#include <Proj_library/h_files/t1_timer.h>
+
+#define TIMER_MIN_TICKS 2   ///< Closer deadlines are taken straight away, by the ISR too.
+
+typedef struct {
+    uint32_t expiry;        ///< Tick of the next expiry.
+    uint32_t period;        ///< Ticks between expiries, 0 for one-shot.
+    timer_cb_t cb;          ///< NULL while the slot is free.
+    timer_id_t *owner;      ///< Set to TIMER_NONE when a one-shot timer expires.
+} sw_timer_t;
+
+static sw_timer_t timers[TIMER_SLOTS];
+static volatile uint16_t ticks_hi;     ///< Timer_B0 overflows.
+
+//*************************************************************************************
+static uint32_t ms_to_ticks(uint16_t ms)
+{
+    uint32_t ticks = ((uint32_t) ms * vlo_cal.hz + 500) / 1000;
+
+    return ticks ? ticks : 1;
+}
+
+// Interrupts must be off.
+static uint32_t now_locked(void)
+{
+    uint16_t hi = ticks_hi, lo;
+
+    // TB0R counts ACLK, asynchronous to MCLK: read until two reads agree.
+    do {
+        lo = TB0R;
+    } while (lo != TB0R);
+
+    // Overflow not served yet.
+    if ((TB0CTL & TBIFG) && (lo < 0x8000)) {
+        hi++;
+    }
+    return ((uint32_t) hi << 16) | lo;
+}
+
+// Program CCR0 for the nearest deadline. Interrupts must be off.
+static void schedule(void)
+{
+    uint32_t now = now_locked();
+    uint32_t next = 0xFFFFFFFF;
+    int32_t d;
+    uint8_t k;
+
+    for (k = 0; k < TIMER_SLOTS; k++) {
+        if (timers[k].cb == NULL) {
+            continue;
+        }
+        d = (int32_t)(timers[k].expiry - now);
+        if (d < 0) {
+            d = 0;
+        }
+        if ((uint32_t) d < next) {
+            next = d;
+        }
+    }
+
+    if (next < TIMER_MIN_TICKS) {
+        TB0CCTL0 = CCIE + CCIFG;            // Due, take the interrupt now.
+    }
+    else if (next <= 0xFFFF) {
+        TB0CCR0 = (uint16_t)(now + next);
+        TB0CCTL0 = CCIE;
+    }
+    else {
+        TB0CCTL0 = 0;                       // Far off (or none), overflow comes back to it.
+    }
+}
+
+//*************************************************************************************
+void timer_init(void)
+{
+    uint8_t k;
+
+    for (k = 0; k < TIMER_SLOTS; k++) {
+        timers[k].cb = NULL;
+    }
+    ticks_hi = 0;
+    TB0CCTL0 = 0;
+    TB0CTL = TBSSEL__ACLK + MC__CONTINUOUS + TBCLR + TBIE;
+}
+
+error_t timer_add(timer_id_t *id, uint16_t ms, uint16_t period_ms, timer_cb_t cb)
+{
+    uint16_t gie = __get_SR_register() & GIE;
+    uint8_t k;
+
+    __disable_interrupt();
+    for (k = 0; k < TIMER_SLOTS; k++) {
+        if (timers[k].cb == NULL) {
+            break;
+        }
+    }
+    if (k == TIMER_SLOTS) {
+        *id = TIMER_NONE;
+        __bis_SR_register(gie);
+        return ERROR_NOBUFS;
+    }
+
+    timers[k].expiry = now_locked() + ms_to_ticks(ms);
+    timers[k].period = period_ms ? ms_to_ticks(period_ms) : 0;
+    timers[k].cb = cb;
+    timers[k].owner = id;
+    *id = k;
+    schedule();
+    __bis_SR_register(gie);
+    return ERROR_OK;
+}
+
+void timer_cancel(timer_id_t *id)
+{
+    uint16_t gie = __get_SR_register() & GIE;
+
+    __disable_interrupt();
+    if ((*id >= 0) && (*id < (timer_id_t) TIMER_SLOTS) && (timers[*id].owner == id)) {
+        timers[*id].cb = NULL;
+        schedule();
+    }
+    *id = TIMER_NONE;
+    __bis_SR_register(gie);
+}
+
+uint32_t timer_now(void)
+{
+    uint16_t gie = __get_SR_register() & GIE;
+    uint32_t now;
+
+    __disable_interrupt();
+    now = now_locked();
+    __bis_SR_register(gie);
+    return now;
+}
+
+void timer_resync(void)
+{
+    uint16_t gie = __get_SR_register() & GIE;
+
+    __disable_interrupt();
+    TB0CTL |= MC__CONTINUOUS + TBIE;
+    schedule();
+    __bis_SR_register(gie);
+}
+
+//*************************************************************************************
+#pragma vector=TIMER0_B0_VECTOR
+RAMFUNC __interrupt void TIMER0_B0_ISR(void)
+{
+    uint32_t now = now_locked();
+    uint8_t k, wake = 0;
+    timer_cb_t cb;
+
+    for (k = 0; k < TIMER_SLOTS; k++) {
+        cb = timers[k].cb;
+        // As in schedule(), or a deadline 1 tick away would raise CCIFG again and again.
+        if ((cb == NULL) || ((int32_t)(timers[k].expiry - now) >= TIMER_MIN_TICKS)) {
+            continue;
+        }
+        if (timers[k].period) {
+            // Periods missed (interrupts off for long) are skipped, not made up.
+            do {
+                timers[k].expiry += timers[k].period;
+            } while ((int32_t)(timers[k].expiry - now) < TIMER_MIN_TICKS);
+        }
+        else {
+            timers[k].cb = NULL;
+            *timers[k].owner = TIMER_NONE;
+        }
+        wake |= cb();
+    }
+    schedule();
+
+    if (wake) {
+        __bic_SR_register_on_exit(LPM3_bits);
+    }
+}
+
+#pragma vector=TIMER0_B1_VECTOR
+RAMFUNC __interrupt void TIMER0_B1_ISR(void)
+{
+    switch (__even_in_range(TB0IV, TB0IV_TBIFG)) {
+    case TB0IV_TBIFG:
+        ticks_hi++;
+        schedule();
+        break;
+    default:
+        break;
+    }
+}
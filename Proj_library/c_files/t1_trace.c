@@ -0,0 +1,45 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief Event trace in a FRAM ring, see t1_trace.h.
+ */
+
+#include <Proj_library/h_files/t1_trace.h>
+#include <Proj_library/h_files/t1_timer.h>
+
+#ifdef T1_TRACE
+
+// Only initialised when flashing.
+#pragma PERSISTENT (trace_ring)
+trace_ring_t trace_ring SIM_FRAM = {TRACE_MAGIC, TRACE_VERSION, TRACE_LEN, 0, 0, {{0}}};
+
+//*************************************************************************************
+void trace_put(trace_id_t id, uint16_t arg)
+{
+    uint32_t now = timer_now();
+    uint16_t gie = __get_SR_register() & GIE;
+    trace_rec_t *r;
+
+    __disable_interrupt();
+    r = &trace_ring.rec[(uint16_t) trace_ring.count & (TRACE_LEN - 1)];
+    r->ticks = now;
+    r->id = id;
+    r->boot = (uint8_t) trace_ring.boots;
+    r->arg = arg;
+    trace_ring.count++;     // Last, a record cut short by a power failure is not counted.
+    __bis_SR_register(gie);
+}
+
+void trace_boot(void)
+{
+    trace_ring.boots++;
+    trace_put(TRACE_BOOT, vlo_cal.hz);
+}
+
+void trace_clear(void)
+{
+    trace_ring.boots = 0;
+    trace_ring.count = 0;
+}
+
+#endif // T1_TRACE
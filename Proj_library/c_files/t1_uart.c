@@ -0,0 +1,247 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief Telemetry on eUSCI_A0 fed by DMA, see t1_uart.h.
+ */
+
+#include <Proj_library/h_files/t1_uart.h>
+#include <Proj_library/h_files/t1_event.h>
+#include <Proj_library/h_files/t1_trace.h>
+#include <Proj_library/h_files/t1_stats.h>
+
+#ifdef T1_TELEMETRY
+
+static uint8_t tx_ring[UART_TX_LEN];
+static volatile uint16_t tx_head, tx_tail;  ///< Free-running, masked on use.
+static volatile uint16_t tx_run;    ///< Bytes DMA0 is sending from tx_tail, 0 when idle.
+
+uint16_t uart_dropped = 0;
+
+#ifdef T1_TRACE
+// Records of trace_ring already sent, so none goes out twice across power-ups.
+#pragma PERSISTENT (trace_sent)
+uint32_t trace_sent SIM_FRAM = 0;
+#endif // T1_TRACE
+
+// Send the bytes from tx_tail to tx_head or the end of the ring. Interrupts off.
+static void tx_start(void)
+{
+    uint16_t at = tx_tail & (UART_TX_LEN - 1);
+    uint16_t n = tx_head - tx_tail;
+
+    if (n > UART_TX_LEN - at) {
+        n = UART_TX_LEN - at;
+    }
+    tx_run = n;
+    if (!n) {
+        return;
+    }
+    DMA_ADDR(DMA0SA, &tx_ring[at]);
+    DMA0SZ = n;
+    DMA0CTL = DMADT_0 | DMASRCINCR_3 | DMASRCBYTE | DMADSTBYTE | DMAIE | DMAEN;
+
+    /* The trigger is UCTXIFG rising. With TXBUF empty the flag is already up, make the edge;
+     * with a byte still in TXBUF the flag rises by itself once it has moved on. */
+    if (UCA0IFG & UCTXIFG) {
+        UCA0IFG &= ~UCTXIFG;
+        UCA0IFG |= UCTXIFG;
+    }
+}
+
+//*************************************************************************************
+void uart_init(void)
+{
+    // P2.0 UCA0TXD, P2.1 UCA0RXD.
+    P2SEL1 |= BIT0 | BIT1;
+    P2SEL0 &= ~(BIT0 | BIT1);
+
+    UCA0CTLW0 = UCSWRST;
+    UCA0CTLW0 |= UCSSEL__SMCLK;
+    UCA0BRW = UART_BRW;
+    UCA0MCTLW = UART_MCTLW;
+
+    // Transfers wait for the CPU's read-modify-write instructions to finish.
+    DMACTL4 = DMARMWDIS;
+    DMACTL0 = (DMACTL0 & ~DMA0TSEL) | DMA0TSEL__UCA0TXIFG;
+    DMA0CTL = 0;
+    DMA_ADDR(DMA0DA, &UCA0TXBUF);
+    UCA0CTLW0 &= ~UCSWRST;
+
+    tx_head = tx_tail = tx_run = 0;
+}
+
+uint16_t uart_free(void)
+{
+    return UART_TX_LEN - (uint16_t)(tx_head - tx_tail);
+}
+
+error_t uart_write(const uint8_t *data, uint16_t len)
+{
+    uint16_t gie = __get_SR_register() & GIE;
+    uint16_t k;
+
+    if (len > uart_free()) {
+        uart_dropped++;
+        return ERROR_NOBUFS;
+    }
+    for (k = 0; k < len; k++) {
+        tx_ring[(uint16_t)(tx_head + k) & (UART_TX_LEN - 1)] = data[k];
+    }
+    SIM_CYCLES(6u * len);   // Host: estimated cost of the copy.
+
+    __disable_interrupt();
+    tx_head += len;
+    if (!tx_run) {
+        tx_start();
+    }
+    __bis_SR_register(gie);
+    return ERROR_OK;
+}
+
+void uart_drain(void)
+{
+    uint16_t gie = __get_SR_register() & GIE;
+
+    __disable_interrupt();
+    while (tx_run) {
+        __bis_SR_register(LPM0_bits + GIE);     // Woken by DMA_ISR with the ring empty.
+        __disable_interrupt();
+    }
+    __bis_SR_register(gie);
+    while (UCA0STATW & UCBUSY)
+        ;       // The last byte is still going out, a frame at most.
+}
+
+//***** Telemetry lines ***************************************************************
+
+static char *put_hex(char *p, uint32_t v, uint8_t digits)
+{
+    *p++ = ' ';
+    while (digits--) {
+        *p++ = "0123456789abcdef"[(v >> (4u * digits)) & 0x0F];
+    }
+    return p;
+}
+
+static void put_line(char *start, char *end)
+{
+    *end++ = '\n';
+    uart_write((const uint8_t *) start, (uint16_t)(end - start));
+}
+
+void telemetry_mailbox(void)
+{
+    char line[TELEMETRY_LINE], *p = line;
+    uint8_t k;
+
+    *p++ = 'M';
+    p = put_hex(p, mailbox_count(), 2);
+    for (k = mailbox.tail; k != mailbox.head; k = (k + 1) % BUFFER_SIZE) {
+        p = put_hex(p, mailbox.buffer[k], 2);
+    }
+    put_line(line, p);
+}
+
+void telemetry_rssi(uint8_t rssi)
+{
+    char line[TELEMETRY_LINE], *p = line;
+
+    *p++ = 'R';
+    p = put_hex(p, rssi, 2);
+    put_line(line, p);
+}
+
+void telemetry_stats(void)
+{
+    char line[TELEMETRY_LINE], *p = line;
+
+    *p++ = 'S';
+    p = put_hex(p, uart_dropped, 4);
+    p = put_hex(p, event_dropped, 2);
+    p = put_hex(p, vlo_cal.hz, 4);
+    put_line(line, p);
+}
+
+uint16_t telemetry_trace(void)
+{
+#ifdef T1_TRACE
+    char line[TELEMETRY_LINE], *p;
+    const trace_rec_t *r;
+
+    if (trace_ring.count - trace_sent > TRACE_LEN) {
+        trace_sent = trace_ring.count - TRACE_LEN;  // The rest has been overwritten.
+    }
+    // 'T', boot, ticks, id, arg and the newline.
+    while ((trace_sent != trace_ring.count) && (uart_free() >= 1u + 3u + 9u + 3u + 5u + 1u)) {
+        r = &trace_ring.rec[(uint16_t) trace_sent & (TRACE_LEN - 1)];
+        p = line;
+        *p++ = 'T';
+        p = put_hex(p, r->boot, 2);
+        p = put_hex(p, r->ticks, 8);
+        p = put_hex(p, r->id, 2);
+        p = put_hex(p, r->arg, 4);
+        put_line(line, p);
+        trace_sent++;
+    }
+    return (uint16_t)(trace_ring.count - trace_sent);
+#else
+    return 0;
+#endif // T1_TRACE
+}
+
+uint16_t telemetry_field(void)
+{
+#ifdef T1_STATS
+    static uint8_t field_sent;  ///< Lines sent by the calls so far, counters then bins.
+    const uint8_t lines = STATS_COUNTERS + STATS_RSSI_BINS;
+    char line[TELEMETRY_LINE], *p;
+    uint8_t bin;
+
+    // 'F', id, count and the newline, the longer line.
+    while ((field_sent < lines) && (uart_free() >= 1u + 3u + 9u + 1u)) {
+        p = line;
+        if (field_sent < STATS_COUNTERS) {
+            *p++ = 'F';
+            p = put_hex(p, field_sent, 2);
+            p = put_hex(p, field_stats.count[field_sent], 8);
+            put_line(line, p);
+        }
+        else {
+            bin = field_sent - STATS_COUNTERS;
+            if (field_stats.rssi[bin]) {
+                *p++ = 'H';
+                p = put_hex(p, bin, 2);
+                p = put_hex(p, field_stats.rssi[bin], 4);
+                put_line(line, p);
+            }
+        }
+        field_sent++;
+    }
+    if (field_sent == lines) {
+        field_sent = 0;
+        return 0;
+    }
+    return lines - field_sent;
+#else
+    return 0;
+#endif // T1_STATS
+}
+
+//*************************************************************************************
+#pragma vector=DMA_VECTOR
+__interrupt void DMA_ISR(void)
+{
+    switch (__even_in_range(DMAIV, DMAIV_DMA2IFG)) {
+    case DMAIV_DMA0IFG:
+        tx_tail += tx_run;
+        tx_start();
+        if (!tx_run) {
+            __bic_SR_register_on_exit(LPM4_bits);   // For uart_drain().
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+#endif // T1_TELEMETRY
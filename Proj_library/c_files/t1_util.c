@@ -9,15 +9,37 @@
  * @date 02/12/2022
 **/
 
-#include <Proj_Library/h_files/t1_util.h>
-#include <Proj_Library/h_files/t1_zeta.h>
-#include <Proj_Library/h_files/t1_spi.h>
+#include <Proj_library/h_files/t1_util.h>
+#include <Proj_library/h_files/t1_zeta.h>
+#include <Proj_library/h_files/t1_spi.h>
+#include <Proj_library/h_files/t1_timer.h>
+#include <Proj_library/h_files/t1_trace.h>
+#include <Proj_library/h_files/t1_stats.h>
 
 // Only initialised when flashing.
 #pragma PERSISTENT (mailbox)
-buffer_t mailbox = {0};
+buffer_t mailbox SIM_FRAM = {0};
 
-volatile uint8_t timerB_exit = 0;
+// Only initialised when flashing, the first power-up calibrates.
+#pragma PERSISTENT (vlo_cal)
+vlo_cal_t vlo_cal SIM_FRAM = {VLO_NOMINAL_HZ, VLO_CAL_BOOTS};
+
+static volatile uint8_t wait_done = 0;
+
+typedef struct {
+    uint16_t ctl1;      ///< CSCTL1, DCO range and frequency.
+    uint16_t ctl3;      ///< CSCTL3, dividers.
+    uint16_t nwaits;    ///< FRCTL0 wait states.
+} clock_cfg_t;
+
+// Indexed by clock_profile_t, SMCLK is SMCLK_HZ in all of them.
+static const clock_cfg_t clock_cfgs[CLOCK_PROFILES] = {
+    {DCOFSEL_0,             DIVA_0 + DIVS_0 + DIVM_0, NWAITS_0},    // CLOCK_LOW_POWER
+    {DCOFSEL_6,             DIVA_0 + DIVS_3 + DIVM_0, NWAITS_0},    // CLOCK_DEFAULT
+    {DCORSEL + DCOFSEL_4,   DIVA_0 + DIVS_4 + DIVM_0, NWAITS_1},    // CLOCK_BURST
+};
+
+static clock_profile_t clock_profile = CLOCK_DEFAULT;
 
 //*************************************************************************************
 void io_init(void)
@@ -65,74 +87,197 @@ void io_init(void)
 }
 
 //*************************************************************************************
-void clock_init(void)
+static void clock_setup(void)
 {
     // Unlock CS registers.
     CSCTL0_H = 0xA5;                        // 0xAH unlocks register, see family user guide
 
-    // Set DCORSEL = 0.
-    CSCTL1 &= ~(DCORSEL);
-
-    // Set DCO to 8MHz.
-    CSCTL1 |=  DCOFSEL_6;                   // if DCOR = 0, config DCOF_6 = 8MHz.
-
     // ACLK = VLO, SMCLK = MCLK = DCO
-    CSCTL2 |= SELA_1 + SELS_3 + SELM_3;     // SELx_1 uses VLOCLK, SELx_3 use DCOCLK.
-
-    // ACLK/1, SMCLK/8, MCLK/1
-    CSCTL3 |= DIVA_0 + DIVS_3 + DIVM_0;     // DIVx_0 = divide by 1, DIVx_3 divides by 8.
+    CSCTL2 = SELA_1 + SELS_3 + SELM_3;      // SELx_1 uses VLOCLK, SELx_3 use DCOCLK.
 
     // Power down clocks if not used by ACLK, MCLK or SMCLK.
     CSCTL4 |= HFXTOFF_1 + LFXTOFF_1;
 
     // Lock clock registers.
     CSCTL0_H = 0;
+
+    /* DCO 8MHz, ACLK/1, SMCLK/8, MCLK/1. The dividers are written, not OR-ed in: the reset
+     * value of CSCTL3 is /8 for SMCLK and MCLK, which left MCLK at 1MHz. */
+    clock_set_profile(CLOCK_DEFAULT);
+}
+
+void clock_init(void)
+{
+    clock_setup();
+    vlo_check();
+    timer_init();
+    TRACE_POWER_UP();
+    STATS_POWER_UP();
+}
+
+void clock_start(void)
+{
+    clock_setup();
+    timer_init();
+    TRACE_POWER_UP();
+    STATS_POWER_UP();
+}
+
+void vlo_check(void)
+{
+    // The VLO drifts with temperature and supply, re-measure it now and again.
+    if ((vlo_cal.age >= VLO_CAL_BOOTS) || (vlo_cal.hz < VLO_MIN_HZ) || (vlo_cal.hz > VLO_MAX_HZ)) {
+        if (vlo_calibrate() != ERROR_OK) {
+            vlo_cal.hz = VLO_NOMINAL_HZ;
+        }
+    }
+    else {
+        vlo_cal.age++;
+    }
 }
 
 //*************************************************************************************
-void timer_start(void)
+error_t clock_set_profile(clock_profile_t profile)
 {
-    // ACLK, upmode, clear.
-    TA0CCR0 = 0x6978; // ~3s delay. ACLK running at 9kHz (VLO),
-    //so 1/f = T for 1 increment in bits. 3 seconds/T = 27000 = 4E20 in hex.
-    TA0CTL |= (TASSEL__ACLK + MC_1);
-    TA0CCTL0 = CCIE; // CCR0 interrupt enabled.
-    __bis_SR_register(GIE); // Enable interrupts for timeout.
+    const clock_cfg_t *cfg;
+    uint16_t gie;
+
+    if (profile >= CLOCK_PROFILES) {
+        return ERROR_RANGE;
+    }
+    cfg = &clock_cfgs[profile];
+
+    gie = __get_SR_register() & GIE;
+    __disable_interrupt();
+
+    // Wait states first when speeding up.
+    if (cfg->nwaits > (FRCTL0 & NWAITS)) {
+        FRCTL0 = FRCTLPW | cfg->nwaits;
+        FRCTL0_H = 0;
+    }
+
+    CSCTL0_H = CSKEY_H;
+    /* The DCO overshoots while it changes frequency: run MCLK and SMCLK at /4 until it has
+     * settled (about 10us), see the device errata. ACLK (the VLO) is left alone. */
+    CSCTL3 = DIVA_0 + DIVS_2 + DIVM_2;
+    CSCTL1 = cfg->ctl1;
+    __delay_cycles(60);
+    CSCTL3 = cfg->ctl3;
+    CSCTL0_H = 0;
+
+    // And removed last when slowing down.
+    if (cfg->nwaits < (FRCTL0 & NWAITS)) {
+        FRCTL0 = FRCTLPW | cfg->nwaits;
+        FRCTL0_H = 0;
+    }
+
+    clock_profile = profile;
+    __bis_SR_register(gie);
+    return ERROR_OK;
 }
 
-void timer_stop(void)
+//*************************************************************************************
+clock_profile_t clock_get_profile(void)
 {
-    TA0CTL = MC_0; // Stop counting.
-    TA0R = 0;      // Reset counter.
-    __bic_SR_register(GIE);
+    return clock_profile;
 }
 
-void timerB_start (void){
-    TB0CCR0 = 0x2650; // ~1s delay. ACLK running at 9kHz (VLO),
-    //so 1/f = T for 1 increment in bits. 1 seconds/T = 18000 =  in hex.
-    TB0CTL |= (TBSSEL__ACLK + MC_1);
-    TB0CCTL0 = CCIE; // CCR0 interrupt enabled.
-    __bis_SR_register(GIE);
+clock_profile_t clock_profile_of(uint16_t ctl1)
+{
+    uint8_t k;
+
+    for (k = 0; k < CLOCK_PROFILES; k++) {
+        if ((ctl1 & (DCORSEL + DCOFSEL)) == clock_cfgs[k].ctl1) {
+            return (clock_profile_t) k;
+        }
+    }
+    return CLOCK_DEFAULT;
 }
 
-void timerB_stop (void){
-    TB0CTL = MC_0; // Stop counting.
-    TB0R = 0;      // Reset counter.
-    __bic_SR_register(GIE);
+//*************************************************************************************
+error_t vlo_calibrate(void)
+{
+    uint16_t count;
+    uint32_t hz;
+
+    // ACLK, upmode, VLO_CAL_TICKS per period.
+    TA0CTL = MC_0;
+    TA0CCTL0 = 0;
+    TA0CCR0 = VLO_CAL_TICKS - 1;
+    TA0CTL = TASSEL__ACLK + MC_1 + TACLR;
+
+    // Start counting SMCLK on an ACLK edge, stop one period later.
+    while (!(TA0CTL & TAIFG))
+        ;
+    TA1CTL = TASSEL__SMCLK + MC_2 + TACLR;
+    TA0CTL &= ~TAIFG;
+    while (!(TA0CTL & TAIFG))
+        ;
+    count = TA1R;
+    if (TA1CTL & TAIFG) {
+        count = 0;          // SMCLK count wrapped, VLO far too slow.
+    }
+    TA0CTL = MC_0;
+    TA1CTL = MC_0;
+
+    if (count == 0) {
+        return ERROR_RANGE;
+    }
+    hz = (SMCLK_HZ * VLO_CAL_TICKS + count / 2) / count;
+    if ((hz < VLO_MIN_HZ) || (hz > VLO_MAX_HZ)) {
+        return ERROR_RANGE;
+    }
+    vlo_cal.hz = (uint16_t) hz;
+    vlo_cal.age = 0;
+    return ERROR_OK;
 }
 
-void wait_one_second(void){
+uint16_t ms_to_aclk(uint16_t ms)
+{
+    uint32_t ticks = ((uint32_t) ms * vlo_cal.hz + 500) / 1000;
+
+    if (ticks == 0) {
+        return 1;
+    }
+    return (ticks > 0xFFFF) ? 0xFFFF : (uint16_t) ticks;
+}
 
-    TB0CCR0 = 0x2650; // ~1s delay. ACLK running at 9kHz (VLO),
-    //so 1/f = T for 1 increment in bits. 1 seconds/T = 18000 =  in hex.
-    TB0CTL |= (TBSSEL__ACLK + MC_1);
-    TB0CCTL0 = CCIE; // CCR0 interrupt enabled.
-    __bis_SR_register(GIE);
+//*************************************************************************************
+static uint8_t wait_expired(void)
+{
+    wait_done = 1;
+    return 1;   // Wake wait_ms().
+}
 
-    while(!timerB_exit){
-        ;   // do nothing
+error_t wait_ms(uint16_t ms){
+
+    timer_id_t id;
+    uint16_t gie = __get_SR_register() & GIE;
+    uint32_t start;
+
+    wait_done = 0;
+    if (timer_add(&id, ms, 0, wait_expired) != ERROR_OK) {
+        // No timer free: the same delay, awake, on the Timer_B0 count.
+        start = timer_now();
+        while (timer_now() - start < ((uint32_t) ms * vlo_cal.hz + 500) / 1000) {
+            SIM_CYCLES(20);
+        }
+        return ERROR_NOBUFS;
+    }
+
+    // Sleep until the timer sets the flag. GIE and LPM3 are set by one instruction,
+    // so the interrupt cannot slip in between the test and the sleep.
+    __disable_interrupt();
+    while(!wait_done){
+        __bis_SR_register(LPM3_bits + GIE);
+        __disable_interrupt();
     }
-    timerB_exit = 0;
+    __bis_SR_register(gie);
+    return ERROR_OK;
+}
+
+void wait_one_second(void){
+    wait_ms(1000);
 }
 
 //*************************************************************************************
@@ -150,10 +295,10 @@ void led_flash(void)
 {
     P8OUT   &=  ~(BIT1+BIT2);
     P8OUT   |=  (BIT0+BIT3);
-    __delay_cycles(4e5);
+    __delay_cycles((MCLK_HZ / 1000) * LED_FLASH_MS);
     P8OUT   &=  ~(BIT0+BIT3);
     P8OUT   |=  (BIT1+BIT2);
-    __delay_cycles(4e5);
+    __delay_cycles((MCLK_HZ / 1000) * LED_FLASH_MS);
 
 }
 //*************************************************************************************
@@ -174,6 +319,7 @@ inline void enter_lpm5(void)
 inline void power_off(void)
 {
     // Because PMOS GPIO is Active-low, power off occurs when GPIO is high.
+    TRACE(TRACE_POWER_OFF, 0);
      P2OUT |= PS_LATCH;
 }
 
@@ -184,27 +330,36 @@ error_t mailbox_push(uint8_t new)
     if (next != mailbox.tail) {
         mailbox.buffer[mailbox.head] = new;
         mailbox.head = next;
+        TRACE(TRACE_MAILBOX_PUSH, new | (ERROR_OK << 8));
         return ERROR_OK;
     }
+    TRACE(TRACE_MAILBOX_PUSH, new | (ERROR_NOBUFS << 8));
     return ERROR_NOBUFS;
 }
 
 error_t mailbox_pop(uint8_t *out)
 {
     if (mailbox.head == mailbox.tail) {
+        TRACE(TRACE_MAILBOX_POP, ERROR_NOBUFS << 8);
         return ERROR_NOBUFS;
     }
     uint8_t next = (mailbox.tail + 1) % BUFFER_SIZE;
     *out = mailbox.buffer[mailbox.tail];
     mailbox.tail = next;
+    TRACE(TRACE_MAILBOX_POP, *out | (ERROR_OK << 8));
     return ERROR_OK;
 }
 
-#pragma vector=TIMER0_B0_VECTOR
-__interrupt void TIMER0_B0_ISR(void)
+error_t mailbox_peek(uint8_t *out)
 {
-    /* Timer to count 1 seconds */
+    if (mailbox.head == mailbox.tail) {
+        return ERROR_NOBUFS;
+    }
+    *out = mailbox.buffer[mailbox.tail];
+    return ERROR_OK;
+}
 
-    timerB_stop();  // Stop & reset timer.
-    timerB_exit = 1; // Assert exit flag.
+uint8_t mailbox_count(void)
+{
+    return (mailbox.head + BUFFER_SIZE - mailbox.tail) % BUFFER_SIZE;
 }
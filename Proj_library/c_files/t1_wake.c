@@ -0,0 +1,62 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief Wake codes, see t1_wake.h.
+ */
+
+#include <Proj_library/h_files/t1_wake.h>
+#include <Proj_library/h_files/t1_zeta.h>
+
+#ifdef T1_WAKE
+
+#define WAKE_PULSE      0xAAu   ///< Payload of a pulse, only its RF is seen.
+
+static void pulse(void)
+{
+    zeta_send_open(CHANNEL, 1u);
+    zeta_write_byte(WAKE_PULSE);
+    zeta_send_close();
+}
+
+void wake_send(uint8_t code)
+{
+    uint8_t k;
+
+    wait_ms(WAKE_LEAD_MS);
+    pulse();    // Sync.
+    for (k = WAKE_BITS; k--; ) {
+        wait_ms(WAKE_SLOT_MS);
+        if ((code >> k) & 1u) {
+            pulse();
+        }
+    }
+}
+
+error_t wake_check(uint8_t code)
+{
+    uint8_t bits = 0, k;
+    uint16_t ms;
+
+    P4DIR &= ~WAKE_DET;
+    P4IES &= ~WAKE_DET;     // Rising edge, the start of a pulse.
+    P4IFG &= ~WAKE_DET;
+
+    // The sync pulse, polled a millisecond at a time from LPM3.
+    for (ms = 0; !(P4IFG & WAKE_DET); ms++) {
+        if (ms >= WAKE_LEAD_MS + WAKE_SLOT_MS) {
+            return ERROR_TIMEOUT;
+        }
+        wait_ms(1);
+    }
+
+    // Windows from half a slot after it, each pulse in the middle of one.
+    wait_ms(WAKE_SLOT_MS / 2u);
+    for (k = 0; k < WAKE_BITS; k++) {
+        P4IFG &= ~WAKE_DET;
+        wait_ms(WAKE_SLOT_MS);
+        bits = (uint8_t)(bits << 1) | ((P4IFG & WAKE_DET) ? 1u : 0u);
+    }
+    return (bits == code) ? ERROR_OK : ERROR_RANGE;
+}
+
+#endif // T1_WAKE
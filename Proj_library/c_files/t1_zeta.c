@@ -8,10 +8,14 @@
  * @modified by Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
  * @date 02/12/2022
 **/
-#include <Proj_Library/h_files/t1_zeta.h>
+#include <Proj_library/h_files/t1_zeta.h>
+#include <Proj_library/h_files/t1_timer.h>
+#include <Proj_library/h_files/t1_trace.h>
 
 volatile uint8_t exit_loop = 0;
 
+static uint8_t zeta_timeout(void);
+
 uint8_t reverse(uint8_t byte)
 {
     byte = (byte & 0xF0) >> 4 | (byte & 0x0F) << 4;
@@ -51,25 +55,47 @@ void zeta_init(void)
      * 4. ATB - RF baud rate 6. (Max data rate [500kbps] set [>2x Host Baud rate])
      */
 
-    zeta_set_rf_power(127u);
+    zeta_set_rf_power(ZETA_RF_POWER);
     zeta_sync_byte(0xAA, 0xAA, 0xAA, 0xAA);
     zeta_set_baud_host(4u);
-    zeta_set_baud_rf(6u);
+    zeta_set_baud_rf(ZETA_RF_BAUD);
 
 }
 
 error_t zeta_wait_irq(void)
 {
-    timer_start();
+    timer_id_t timeout;
+    uint16_t gie = __get_SR_register() & GIE;
+    error_t err = ERROR_OK;
+    uint8_t i;
+
+    TRACE(TRACE_ZETA_WAIT, 0);
+    if (timer_add(&timeout, ZETA_TIMEOUT_MS, 0, zeta_timeout) != ERROR_OK) {
+        TRACE(TRACE_ZETA_IRQ, ERROR_NOBUFS);
+        return ERROR_NOBUFS;    // No timeout to bound the wait with.
+    }
+    __bis_SR_register(GIE); // Enable interrupts for timeout.
+
     // Wait for nIRQ to go low.
     while (P3IN & IRQ) {
         if (exit_loop) {
-            timer_stop();
-            return ERROR_TIMEOUT;
+            err = ERROR_TIMEOUT;
+            break;
         }
     }
-    timer_stop();
-    return ERROR_OK;
+    timer_cancel(&timeout);
+    if (!gie) {
+        __disable_interrupt();
+    }
+    TRACE(TRACE_ZETA_IRQ, err);
+    if (err == ERROR_TIMEOUT) {
+        // Error gets flashed 3 times, here rather than in the interrupt.
+        for (i = 0; i < 3; i++) {
+            led_flash();
+        }
+        P8OUT = 0x00;
+    }
+    return err;
 }
 
 void zeta_ready(void)
@@ -89,6 +115,7 @@ void zeta_select_mode(uint8_t mode)
         // Invalid arguments.
         return;
     }
+    TRACE(TRACE_ZETA_CMD, 'M' | (mode << 8));
 #ifdef MANUAL
     spi_cs_low();
 #endif // MANUAL
@@ -107,6 +134,7 @@ void zeta_rx_mode(uint8_t ch, uint8_t pLength)
         // Invalid arguments.
         return;
     }
+    TRACE(TRACE_ZETA_CMD, 'R' | (ch << 8));
 #ifdef MANUAL
     spi_cs_low();
 #endif // MANUAL
@@ -122,6 +150,7 @@ void zeta_rx_mode(uint8_t ch, uint8_t pLength)
 
 void zeta_sync_byte(uint8_t sync1, uint8_t sync2, uint8_t sync3, uint8_t sync4)
 {
+    TRACE(TRACE_ZETA_CMD, 'A' | (sync1 << 8));
 #ifdef MANUAL
     spi_cs_low();
 #endif // MANUAL
@@ -148,6 +177,7 @@ void zeta_set_baud_host(uint8_t baud)
         // Invalid argument.
         return;
     }
+    TRACE(TRACE_ZETA_CMD, 'H' | (baud << 8));
 #ifdef MANUAL
     spi_cs_low();
 #endif // MANUAL
@@ -166,6 +196,7 @@ void zeta_set_baud_rf(uint8_t baud)
         // Invalid argument.
         return;
     }
+    TRACE(TRACE_ZETA_CMD, 'B' | (baud << 8));
 #ifdef MANUAL
     spi_cs_low();
 #endif // MANUAL
@@ -177,9 +208,9 @@ void zeta_set_baud_rf(uint8_t baud)
     spi_cs_high();
 #endif // MANUAL
 
-    // device must enter sleep and wake again w/ delay of >= 15ms
+    // device must enter sleep and wake again w/ delay of >= 15ms, in any clock profile.
     P3OUT |= SDN;
-    __delay_cycles(5e5); // delay(20);
+    __delay_cycles((MCLK_MAX_HZ / 1000) * ZETA_SDN_MS);
     P3OUT &= ~SDN;
 }
 
@@ -189,6 +220,7 @@ void zeta_set_rf_power(uint8_t pwr)
         // Invalid arguments.
         return;
     }
+    TRACE(TRACE_ZETA_CMD, 'P' | (pwr << 8));
 #ifdef MANUAL
     spi_cs_low();
 #endif // MANUAL
@@ -207,6 +239,7 @@ void zeta_enable_crc(uint8_t en)
         // Invalid arguments.
         return;
     }
+    TRACE(TRACE_ZETA_CMD, 'E' | (en << 8));
 #ifdef MANUAL
     spi_cs_low();
 #endif // MANUAL
@@ -221,6 +254,7 @@ void zeta_enable_crc(uint8_t en)
 
 void zeta_reset_default(void)
 {
+    TRACE(TRACE_ZETA_CMD, 'D');
 #ifdef MANUAL
     spi_cs_low();
 #endif // MANUAL
@@ -238,6 +272,7 @@ void zeta_reset_default(void)
 
 uint8_t zeta_get_rssi(void)
 {
+    TRACE(TRACE_ZETA_CMD, 'Q');
 #ifdef MANUAL
     spi_cs_low();
 #endif // MANUAL
@@ -261,6 +296,7 @@ uint8_t zeta_get_rssi(void)
 
 void zeta_get_vers(void)
 {
+    TRACE(TRACE_ZETA_CMD, 'V');
 #ifdef MANUAL
     spi_cs_low();
 #endif // MANUAL
@@ -284,6 +320,7 @@ void zeta_get_vers(void)
 
 void zeta_get_settings(uint8_t *settings)
 {
+    TRACE(TRACE_ZETA_CMD, '?');
 #ifdef MANUAL
     spi_cs_low();
 #endif // MANUAL
@@ -315,6 +352,7 @@ void zeta_send_open(uint8_t ch, uint8_t pLength)
         // Invalid arguments.
         return;
     }
+    TRACE(TRACE_ZETA_CMD, 'S' | (pLength << 8));
 #ifdef MANUAL
     spi_cs_low();
 #endif // MANUAL
@@ -341,11 +379,51 @@ void zeta_send_close(void)
 
 void zeta_send_packet(uint8_t *packet, uint8_t len)
 {
-    zeta_send_open(CHANNEL, len);
     uint8_t i;
+#if defined(T1_FEC)
+    uint8_t coded[2u * FEC_BLOCK], n, k;
+#elif defined(T1_CRC)
+    uint8_t fcs[CRC_LEN];
+#endif
+
+#ifdef T1_AES
+    len = aes_seal(packet, len);
+#endif // T1_AES
+#if defined(T1_FEC)
+#ifdef T1_CRC
+    // The CRC after the packet, coded with it.
+    crc_start();
+    for (i = 0; i < len; i++) {
+        crc_byte(packet[i]);
+    }
+    crc_result(&packet[len]);
+    len += CRC_LEN;
+#endif // T1_CRC
+    zeta_send_open(CHANNEL, FEC_AIR_LEN(len));
+    for (i = 0; i < len; i += n) {
+        n = ((uint8_t)(len - i) < FEC_BLOCK) ? (uint8_t)(len - i) : FEC_BLOCK;
+        fec_encode(&packet[i], n, coded);
+        for (k = 0; k < 2u * n; k++) {
+            zeta_write_byte(coded[k]);
+        }
+    }
+#elif defined(T1_CRC)
+    zeta_send_open(CHANNEL, len + CRC_LEN);
+    crc_start();
+    for (i = 0; i < len; i++) {
+        crc_byte(packet[i]);
+        zeta_write_byte(packet[i]);
+    }
+    crc_result(fcs);
+    for (i = 0; i < CRC_LEN; i++) {
+        zeta_write_byte(fcs[i]);
+    }
+#else
+    zeta_send_open(CHANNEL, len);
     for (i = 0; i < len; i++) {
         zeta_write_byte(packet[i]);
     }
+#endif
     zeta_send_close();
 }
 
@@ -373,6 +451,12 @@ error_t zeta_read_byte(uint8_t *out)
 error_t zeta_rx_packet(uint8_t *packet)
 {
     uint8_t i = 0, len = 0;
+#if defined(T1_FEC)
+    uint8_t coded[2u * FEC_BLOCK], n, k;
+    error_t status = ERROR_OK;
+#elif defined(T1_CRC)
+    uint8_t fcs[CRC_LEN];
+#endif
 
     // # R <len> <rssi>
     for (i = 0; i < 4; i++) {
@@ -383,6 +467,60 @@ error_t zeta_rx_packet(uint8_t *packet)
     }
     len = packet[2];
 
+#if defined(T1_FEC)
+    // The actual packet contents, a block of coded bytes at a time, corrected into the packet.
+    while (len > 0) {
+        n = (len < 2u * FEC_BLOCK) ? len : 2u * FEC_BLOCK;
+        for (k = 0; k < n; k++) {
+            if (zeta_read_byte(&coded[k])) {
+                exit_loop = 0;
+                return ERROR_TIMEOUT;
+            }
+        }
+        if (fec_decode(coded, n / 2u, &packet[i]) != ERROR_OK) {
+            status = ERROR_CRC;
+        }
+        i += n / 2u;
+        len -= n;
+    }
+
+    exit_loop = 0;
+    if ((status != ERROR_OK) || (packet[2] & 1u)) {
+        return ERROR_CRC;
+    }
+    packet[2] /= 2u;
+#ifdef T1_CRC
+    if (packet[2] < CRC_LEN) {
+        return ERROR_CRC;
+    }
+    packet[2] -= CRC_LEN;
+    crc_start();
+    for (i = 4; i < 4u + packet[2]; i++) {
+        crc_byte(packet[i]);
+    }
+    if (crc_check(&packet[i]) != ERROR_OK) {
+        return ERROR_CRC;
+    }
+#endif // T1_CRC
+#elif defined(T1_CRC)
+    // The actual packet contents, through the CRC module as they come, then the CRC.
+    crc_start();
+    for (; len > 0; len--) {
+        if (zeta_read_byte((len > CRC_LEN) ? &packet[i] : &fcs[CRC_LEN - len])) {
+            exit_loop = 0;
+            return ERROR_TIMEOUT;
+        }
+        if (len > CRC_LEN) {
+            crc_byte(packet[i++]);
+        }
+    }
+
+    exit_loop = 0;
+    if ((packet[2] < CRC_LEN) || (crc_check(fcs) != ERROR_OK)) {
+        return ERROR_CRC;
+    }
+    packet[2] -= CRC_LEN;
+#else
     // The actual packet contents.
     for (; len > 0; len--) {
         if (zeta_read_byte(&packet[i++])) {
@@ -392,27 +530,27 @@ error_t zeta_rx_packet(uint8_t *packet)
     }
 
     exit_loop = 0;
+#endif
     // Packet successfully received.
+#ifdef T1_AES
+    return aes_open(&packet[4], &packet[2]);
+#else
     return ERROR_OK;
+#endif // T1_AES
 }
 
 //--------------------------------------
 // TIMEOUT PROTECTION
 //--------------------------------------
 
-#pragma vector=TIMER0_A0_VECTOR
-__interrupt void TIMER0_A0_ISR(void)
+static uint8_t zeta_timeout(void)
 {
-    /* Timeout protection interrupt set to occur after 2 seconds.
-     * See timer_start for more details.
-     * Error gets flashed 3 times.
+    /* Timeout protection, one-shot software timer set for ZETA_TIMEOUT_MS by
+     * zeta_wait_irq(). Runs in the Timer_B0 interrupt, so only flags the timeout:
+     * zeta_wait_irq() flashes the error.
      */
 
-    timer_stop();  // Stop timer.
-    uint8_t i;
-        for (i = 0; i < 3; i++) {
-            led_flash();   // Flash LEDs to indicate.
-        }
-        P8OUT = 0x00;
-        exit_loop = 1; // Assert exit flag.
+    TRACE(TRACE_ZETA_TIMEOUT, 0);
+    exit_loop = 1; // Assert exit flag.
+    return 0;
 }
@@ -0,0 +1,87 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief Authenticated encryption of the radio payloads on the AES256 accelerator.
+ *
+ * With T1_AES, zeta_send_packet() seals the payload before it goes to the Zeta+ and
+ * zeta_rx_packet() opens it, in place in the packet buffer (t1_zeta.h). Encrypt-then-MAC
+ * with AES-256 and two keys:
+ *
+ *      ciphertext = payload XOR OFB key stream (aes_key_enc, IV = nonce | 0x01 | 0...)
+ *      tag = CBC-MAC (aes_key_mac) of B0 = nonce | 0x02 | length | 0..., then the
+ *            ciphertext padded with zeros to whole blocks, first AES_TAG_LEN bytes
+ *
+ * | On air  | ciphertext (len) | nonce (AES_NONCE_LEN, LSB first) | tag (AES_TAG_LEN) |
+ *
+ * The nonce is a counter in FRAM (aes_tx_nonce), counted before it is used, so no two
+ * packets share a key stream across power failures. The receiver keeps the last one it
+ * accepted (aes_rx_nonce, FRAM) and rejects any packet not newer, a replay. Flash both ends
+ * together, or set aes_rx_nonce back, after reflashing a transmitter.
+ *
+ * The AES256 module does each block in 234 MCLK cycles. In cipher mode (AESCMEN) DMA
+ * channel 1 feeds it from the buffer (AES trigger 1) and channel 2 writes the output back
+ * (AES trigger 0), the CPU only waits on AESBUSY: no copy of the payload is made. A pass
+ * covers whole blocks, so the buffer must hold AES_BUF_LEN(len) bytes; the bytes after the
+ * payload are overwritten. Channels 1 and 2 are kept for this, channel 0 is the UART's
+ * (t1_uart.h). With T1_AES_SW the same is done in software, on round keys expanded once per
+ * power-up into RAM (480 bytes), for devices without the module and for comparison ('make
+ * aes' in host/).
+ *
+ * The keys below are placeholders, replace them (the same on both ends) for a deployment.
+ * Decryption is the OFB pass again, the module only ever encrypts.
+ */
+
+#ifndef AES_H
+#define AES_H
+
+#include <msp430.h>
+#include <stdint.h>
+#include <Proj_library/h_files/t1_util.h>
+
+//#define T1_AES        ///< "Uncomment" to encrypt and authenticate the radio payloads.
+//#define T1_AES_SW     ///< "Uncomment" as well to do it in software, not on the AES256 module.
+
+#define AES_NONCE_LEN   4u
+#define AES_TAG_LEN     4u
+#define AES_OVERHEAD    (AES_NONCE_LEN + AES_TAG_LEN)   ///< Bytes added to a payload on air.
+#define AES_BLOCKS(n)   (((n) + 15u) / 16u)
+/// Buffer for a payload of n bytes: its blocks, and room for the nonce and tag.
+#define AES_BUF_LEN(n)  ((16u * AES_BLOCKS(n) > (n) + AES_OVERHEAD) ? 16u * AES_BLOCKS(n) \
+                                                                 : (n) + AES_OVERHEAD)
+
+#define AES_KEY_ENC { \
+    0x60, 0x3d, 0xeb, 0x10, 0x15, 0xca, 0x71, 0xbe, 0x2b, 0x73, 0xae, 0xf0, 0x85, 0x7d, 0x77, 0x81, \
+    0x1f, 0x35, 0x2c, 0x07, 0x3b, 0x61, 0x08, 0xd7, 0x2d, 0x98, 0x10, 0xa3, 0x09, 0x14, 0xdf, 0xf4 }
+#define AES_KEY_MAC { \
+    0x8e, 0x73, 0xb0, 0xf7, 0xda, 0x0e, 0x64, 0x52, 0xc8, 0x10, 0xf3, 0x2b, 0x80, 0x90, 0x79, 0xe5, \
+    0x62, 0xf8, 0xea, 0xd2, 0x52, 0x2c, 0x6b, 0x7b, 0x34, 0x4c, 0xa2, 0x5a, 0x5e, 0x68, 0x3b, 0x07 }
+
+#ifdef T1_AES
+
+/**
+ * @brief Encrypt a payload in place and append the nonce and tag.
+ *
+ * @param buf : Payload, in a buffer of AES_BUF_LEN(len) bytes.
+ * @param len : Payload length, up to 64 - AES_OVERHEAD for the Zeta+.
+ * @return Length on air, len + AES_OVERHEAD.
+ */
+uint8_t aes_seal(uint8_t *buf, uint8_t len);
+
+/**
+ * @brief Check a received packet and decrypt it in place.
+ *
+ * @param buf : Packet as received, in a buffer of AES_BUF_LEN(*len - AES_OVERHEAD) bytes.
+ * @param[in,out] len : Length on air, the payload's length if it is accepted.
+ * @return Error status.
+ * @retval ERROR_OK - Authentic and new, buf holds the payload.
+ * @retval ERROR_AUTH - Too short, wrong tag or a replayed nonce. buf is not decrypted.
+ */
+error_t aes_open(uint8_t *buf, uint8_t *len);
+
+extern const uint8_t aes_key_enc[32], aes_key_mac[32];
+extern uint32_t aes_tx_nonce;   ///< Last nonce sent.
+extern uint32_t aes_rx_nonce;   ///< Last nonce accepted.
+
+#endif // T1_AES
+
+#endif // AES_H
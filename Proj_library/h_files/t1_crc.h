@@ -0,0 +1,84 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief CRC framing of the radio packets on the CRC16 and CRC32 modules.
+ *
+ * The Zeta+ checks its own CRC only with ATE on (zeta_enable_crc()), off by default: a
+ * packet hit by a bit error is delivered as it is. With T1_CRC, zeta_send_packet() appends
+ * CRC_LEN bytes of CRC to what goes on air (after T1_AES's nonce and tag), computed by the
+ * CRC module as the bytes are written to spi_xfer(), and zeta_rx_packet() feeds each byte
+ * it reads to the module and returns ERROR_CRC when the CRC read after them differs, before
+ * the packet is decrypted or stored anywhere.
+ *
+ * | On air | payload (len) | CRC (CRC_LEN, LSB first) |
+ *
+ *      T1_CRC              CRC-16/CCITT: x^16 + x^12 + x^5 + 1, initial 0xFFFF, MSB first,
+ *                          on the CRC16 module (CRCDIRB, CRCINIRES), 2 bytes
+ *      T1_CRC + T1_CRC32   CRC-32 (ISO 3309, zlib's crc32()) on the CRC32 module, 4 bytes
+ *
+ * Feeding a byte to the module is one register write (crc_byte()), done in the cycles of the
+ * write. With T1_CRC_SW the same CRC is computed in software from a 256 entry table in FRAM,
+ * for comparison ('make bench' in host/).
+ */
+
+#ifndef CRC_H
+#define CRC_H
+
+#include <msp430.h>
+#include <stdint.h>
+#include <Proj_library/h_files/t1_util.h>
+
+//#define T1_CRC        ///< "Uncomment" to append a CRC to the radio packets and check it.
+//#define T1_CRC32      ///< "Uncomment" as well for CRC-32, CRC-16 otherwise.
+//#define T1_CRC_SW     ///< "Uncomment" as well to compute it in software, not on the module.
+
+#ifdef T1_CRC
+#ifdef T1_CRC32
+#define CRC_LEN         4u
+#else
+#define CRC_LEN         2u
+#endif // T1_CRC32
+#else
+#define CRC_LEN         0u      ///< No CRC on air.
+#endif // T1_CRC
+
+#ifdef T1_CRC
+
+/**
+ * @brief Start a CRC.
+ */
+void crc_start(void);
+
+/**
+ * @brief Add a byte to the CRC.
+ *
+ * @param b : Next byte.
+ */
+#if defined(T1_CRC_SW)
+void crc_byte(uint8_t b);
+#elif defined(T1_CRC32)
+#define crc_byte(b)     (CRC32DIW0_L = (b))
+#else
+#define crc_byte(b)     (CRCDIRB_L = (b))
+#endif // T1_CRC_SW
+
+/**
+ * @brief The CRC of the bytes since crc_start().
+ *
+ * @param[out] fcs : CRC_LEN bytes, LSB first, as sent on air.
+ */
+void crc_result(uint8_t *fcs);
+
+/**
+ * @brief Check the CRC of the bytes since crc_start().
+ *
+ * @param fcs : CRC_LEN bytes as received.
+ * @return Error status.
+ * @retval ERROR_OK - Matches.
+ * @retval ERROR_CRC - Differs.
+ */
+error_t crc_check(const uint8_t *fcs);
+
+#endif // T1_CRC
+
+#endif // CRC_H
@@ -0,0 +1,111 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief Delta compression of sample streams for the radio payload.
+ *
+ * Air time is most of a packet's energy and the Zeta+ sends at most 64 bytes, so a run of
+ * samples is sent as the difference from the sample before, which for most sensors is small
+ * when the samples are. Each difference (mod 2^16) is zig-zag mapped to an unsigned value,
+ * 0, -1, 1, -2, ... to 0, 1, 2, 3, ..., and written as
+ *
+ *      a varint        7 bits a byte, LSB first, the top bit set on all but the last byte:
+ *                      1 byte for -64 to 63, 3 at most.
+ *      T1_DELTA_RICE   a Rice code, an entropy stage for small differences: (u >> k) one
+ *                      bits, a zero bit, then the k low bits of u, MSB first. k follows the
+ *                      running mean of u. A code of DELTA_RICE_ESC or more one bits is
+ *                      written as DELTA_RICE_ESC one bits and the 16 bits of u. The first
+ *                      sample is its 16 bits, the stream is padded with one bits to a byte.
+ *
+ * The first sample is the difference from 0. A stream starts again with delta_begin() for
+ * each packet, so a packet lost costs only its own samples. Encoder and decoder keep a few
+ * bytes of state, write straight into the packet buffer and read straight from the packet.
+ *
+ * With T1_DELTA (and T1_FRAME, TX_BURST) t1_main_Tx.c sends a burst's data as one FRAME_DELTA
+ * record (t1_frame.h) instead of a packet per value, and t1_main_Rx.c takes it.
+ */
+
+#ifndef DELTA_H
+#define DELTA_H
+
+#include <stdint.h>
+#include <Proj_library/h_files/t1_util.h>
+
+//#define T1_DELTA      ///< "Uncomment" to send the burst data compressed (needs T1_FRAME).
+//#define T1_DELTA_RICE ///< "Uncomment" as well for the Rice codes, varints otherwise.
+
+#if defined(T1_DELTA) && !defined(T1_FRAME)
+#error "T1_DELTA sends FRAME_DELTA records, define T1_FRAME too"
+#endif
+
+#define DELTA_RICE_ESC  16u     ///< Rice: one bits of an escaped value.
+
+typedef struct {
+    uint8_t *buf;           ///< Packet buffer written to.
+    uint8_t size;           ///< Its length.
+    uint16_t pos;           ///< Bits written with T1_DELTA_RICE, bytes without.
+    int16_t last;           ///< Sample before.
+#ifdef T1_DELTA_RICE
+    uint16_t acc;           ///< 16 times the running mean of the zig-zag values.
+#endif // T1_DELTA_RICE
+} delta_enc_t;
+
+typedef struct {
+    const uint8_t *buf;     ///< Received data.
+    uint8_t len;            ///< Its length.
+    uint16_t pos;           ///< Bits read with T1_DELTA_RICE, bytes without.
+    int16_t last;           ///< Sample before.
+#ifdef T1_DELTA_RICE
+    uint16_t acc;
+#endif // T1_DELTA_RICE
+} delta_dec_t;
+
+/**
+ * @brief Start a stream of samples in a packet buffer.
+ *
+ * @param e : Encoder to start.
+ * @param buf : Where the stream goes.
+ * @param size : Its length.
+ */
+void delta_begin(delta_enc_t *e, uint8_t *buf, uint8_t size);
+
+/**
+ * @brief Add a sample to the stream.
+ *
+ * @param e : Encoder.
+ * @param sample : Next sample.
+ * @return Error status.
+ * @retval ERROR_OK - Written.
+ * @retval ERROR_NOBUFS - Does not fit, nothing written, the stream can be ended.
+ */
+error_t delta_put(delta_enc_t *e, int16_t sample);
+
+/**
+ * @brief End the stream.
+ *
+ * @param e : Encoder.
+ * @return Bytes of the stream, padding included.
+ */
+uint8_t delta_end(delta_enc_t *e);
+
+/**
+ * @brief Start reading a received stream.
+ *
+ * @param d : Decoder to start.
+ * @param buf : The stream.
+ * @param len : Its length.
+ */
+void delta_open(delta_dec_t *d, const uint8_t *buf, uint8_t len);
+
+/**
+ * @brief Next sample of a stream.
+ *
+ * @param d : Decoder.
+ * @param[out] sample : The sample.
+ * @return Error status.
+ * @retval ERROR_OK - sample set.
+ * @retval ERROR_NOBUFS - End of the stream.
+ * @retval ERROR_RANGE - The stream ends inside a code, it was cut short.
+ */
+error_t delta_get(delta_dec_t *d, int16_t *sample);
+
+#endif // DELTA_H
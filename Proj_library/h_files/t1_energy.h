@@ -0,0 +1,78 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief Energy in the storage capacitor and the energy cost of radio operations.
+ *
+ * The node runs off the storage capacitor through the supply latch, so the supply is the
+ * capacitor's voltage. supply_mv() measures it with ADC12_B: input channel 31 is AVCC/2
+ * (ADC12BATMAP), against the 2.0V internal reference, good for supplies up to 4V.
+ *
+ * Energies are in uJ. energy_available() is what the capacitor holds above STORE_MIN_MV,
+ * the lowest voltage an operation may leave it at: the 1.8V brown-out plus a margin for
+ * the error of the estimates and the measurement. Radio currents are ZETA_I_*_UA
+ * (t1_zeta.h), the voltage taken as constant over the operation, which overestimates it.
+ */
+
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#include <msp430.h>
+#include <stdint.h>
+#include <Proj_library/h_files/t1_util.h>
+
+#define STORE_UF 100000UL       ///< Storage capacitance [uF].
+#define STORE_MIN_MV 1900u      ///< Supply an operation may go down to [mV].
+#define ADC_VREF_MV 2000u       ///< Reference of the supply measurement [mV].
+#define ADC_TIMEOUT 1000u       ///< Polls of the conversion before giving up.
+
+/**
+ * @brief Measure the supply voltage.
+ *
+ * Turns the reference and the ADC on for one conversion (about 25us at 8MHz) and off again.
+ *
+ * @param[out] mv - Supply voltage [mV].
+ * @return Error status.
+ * @retval ERROR_OK - No errors, mv written.
+ * @retval ERROR_TIMEOUT - The conversion did not finish, mv left as it was.
+ */
+error_t supply_mv(uint16_t *mv);
+
+/**
+ * @brief Energy stored above STORE_MIN_MV.
+ *
+ * @param mv : Supply voltage [mV], from supply_mv().
+ * @return 1/2 STORE_UF (mv^2 - STORE_MIN_MV^2) [uJ], 0 below STORE_MIN_MV.
+ */
+uint32_t energy_available(uint16_t mv);
+
+/**
+ * @brief Air time of a packet.
+ *
+ * @param len : Payload bytes.
+ * @param baud : RF baud rate (zeta_set_baud_rf()).
+ * @return Payload and the preamble, sync, length and CRC bytes [us], 0 for no such rate.
+ */
+uint32_t energy_airtime_us(uint8_t len, uint8_t baud);
+
+/**
+ * @brief Energy of transmitting a packet.
+ *
+ * @param len : Payload bytes.
+ * @param baud : RF baud rate (zeta_set_baud_rf()).
+ * @param power : RF output power (zeta_set_rf_power()).
+ * @param mv : Supply voltage [mV].
+ * @return Energy [uJ].
+ */
+uint32_t energy_tx(uint8_t len, uint8_t baud, uint8_t power, uint16_t mv);
+
+/**
+ * @brief Energy of drawing a current for some time.
+ *
+ * @param ua : Current [uA], e.g. ZETA_I_READY_UA for the radio waiting between packets.
+ * @param ms : Time [ms].
+ * @param mv : Supply voltage [mV].
+ * @return Energy [uJ].
+ */
+uint32_t energy_wait(uint16_t ua, uint32_t ms, uint16_t mv);
+
+#endif // ENERGY_H
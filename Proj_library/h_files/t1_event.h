@@ -0,0 +1,94 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief Cooperative event loop for the applications.
+ *
+ * Interrupts post events (event_post()) to a queue, event_run() takes them off it one at
+ * a time and calls the handler registered for each (event_handler()). Handlers run to
+ * completion in the main loop, one after the other, and must not wait: a delay is a timer
+ * whose callback posts EVENT_TIMER. With the queue empty the CPU sleeps in the deepest
+ * low-power mode allowed (event_lpm(), LPM3 unless set).
+ *
+ * | Event            | Posted by                                           | arg        |
+ * |------------------|-----------------------------------------------------|------------|
+ * | EVENT_RADIO      | nIRQ falling edge (P3.5), after event_radio_arm()   | 0          |
+ * | EVENT_TIMER      | the application's timer callbacks (t1_timer.h)      | its choice |
+ * | EVENT_COMPARATOR | the loop, when COMPARATOR_ON has changed            | new level  |
+ * | EVENT_MAILBOX    | the loop, while the mailbox is not empty            | 0          |
+ *
+ * The comparator interrupt belongs to Hibernus, and it wakes the CPU on return, so the loop
+ * sees every edge there is an interrupt for. EVENT_MAILBOX is level-triggered: the handler
+ * must pop at least one entry or it is called again straight away.
+ *
+ * The queue is in RAM and is saved and restored by Hibernus with the rest of the state.
+ */
+
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <msp430.h>
+#include <stdint.h>
+#include <Proj_library/h_files/t1_util.h>
+
+#define EVENT_QUEUE_LEN 8u      ///< Events that can wait at once.
+
+typedef enum {
+    EVENT_RADIO = 0, EVENT_TIMER, EVENT_COMPARATOR, EVENT_MAILBOX, EVENTS
+} event_t;
+
+typedef void (*event_handler_t)(uint8_t arg);
+
+/**
+ * @brief Empty the queue, clear the handlers and note the comparator's level.
+ */
+void event_init(void);
+
+/**
+ * @brief Set the handler of an event, NULL to ignore it.
+ *
+ * @param ev : Event.
+ * @param handler : Called from event_run() with the event's arg.
+ */
+void event_handler(event_t ev, event_handler_t handler);
+
+/**
+ * @brief Queue an event. Safe to call from interrupts.
+ *
+ * @param ev : Event.
+ * @param arg : Passed to the handler.
+ * @return Error status.
+ * @retval ERROR_OK - No errors, event queued.
+ * @retval ERROR_NOBUFS - Queue full, event lost (counted in event_dropped).
+ * @retval ERROR_RANGE - No such event.
+ */
+error_t event_post(event_t ev, uint8_t arg);
+
+/**
+ * @brief Deepest low-power mode event_run() may sleep in.
+ *
+ * @param lpm_bits : LPM0_bits to LPM4_bits. LPM3 keeps ACLK, and with it the software
+ *                   timers and the Hibernus policy timer. LPM4 only wakes on port edges.
+ */
+void event_lpm(uint16_t lpm_bits);
+
+/**
+ * @brief Enable EVENT_RADIO for the next falling edge of nIRQ.
+ *
+ * The interrupt disables itself when it posts, so the bytes that follow (read with
+ * zeta_read_byte()) do not post again.
+ */
+void event_radio_arm(void);
+
+/**
+ * @brief Run handlers until event_stop(), sleeping whenever there is nothing to do.
+ */
+void event_run(void);
+
+/**
+ * @brief Make event_run() return once the running handler is done.
+ */
+void event_stop(void);
+
+extern uint8_t event_dropped;   ///< Events lost to a full queue.
+
+#endif // EVENT_H
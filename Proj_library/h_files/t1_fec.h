@@ -0,0 +1,64 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief Forward error correction of the radio packets: Hamming(8,4) codes, interleaved.
+ *
+ * At the higher RF baud rates the bit error rate grows with range (zeta_set_baud_rf()). With
+ * T1_FEC, zeta_send_packet() codes each nibble of what goes on air (the payload, T1_AES's
+ * nonce and tag, T1_CRC's CRC) as an extended Hamming(8,4) codeword, and zeta_rx_packet()
+ * corrects a bit error in each codeword and detects two (ERROR_CRC). Twice the bytes go on
+ * air, FEC_AIR_LEN(), so a payload is at most 32 bytes less those of AES and CRC.
+ *
+ * | data byte | high nibble | low nibble |  ->  | codeword (high) | codeword (low) |
+ *
+ *      codeword    d3 d2 d1 d0 p2 p1 p0 p, p0 = d0^d1^d3, p1 = d0^d2^d3, p2 = d1^d2^d3,
+ *                  p the parity of the other 7 bits, minimum distance 4
+ *
+ * The codewords of a block of up to FEC_BLOCK data bytes are interleaved bit by bit: the MSB
+ * of each codeword, then the next bit of each, and so on. A burst of up to 2 * FEC_BLOCK bits
+ * on air (2 * n in a last block of n bytes) then puts at most one error in each codeword and
+ * is corrected. Codes are looked up in tables in FRAM, a byte each way.
+ */
+
+#ifndef FEC_H
+#define FEC_H
+
+#include <stdint.h>
+#include <Proj_library/h_files/t1_util.h>
+
+//#define T1_FEC        ///< "Uncomment" to send the radio packets with error correction.
+
+#define FEC_BLOCK       4u      ///< Data bytes interleaved together, 8 codewords.
+
+#ifdef T1_FEC
+#define FEC_AIR_LEN(n)  (2u * (n))  ///< Coded length of n bytes.
+#else
+#define FEC_AIR_LEN(n)  (n)
+#endif // T1_FEC
+
+#ifdef T1_FEC
+
+/**
+ * @brief Code a block.
+ *
+ * @param data : Data bytes.
+ * @param n : How many, 1 to FEC_BLOCK.
+ * @param[out] coded : 2 * n coded bytes, interleaved, to send.
+ */
+void fec_encode(const uint8_t *data, uint8_t n, uint8_t *coded);
+
+/**
+ * @brief Correct and decode a block.
+ *
+ * @param coded : 2 * n coded bytes as received.
+ * @param n : Data bytes of the block, 1 to FEC_BLOCK.
+ * @param[out] data : n data bytes.
+ * @return Error status.
+ * @retval ERROR_OK - Decoded, single bit errors corrected.
+ * @retval ERROR_CRC - A codeword with two bit errors (or more), data not to be used.
+ */
+error_t fec_decode(const uint8_t *coded, uint8_t n, uint8_t *data);
+
+#endif // T1_FEC
+
+#endif // FEC_H
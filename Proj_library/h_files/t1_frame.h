@@ -0,0 +1,155 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief Binary payload frames: a header and type-length-value records.
+ *
+ * With T1_FRAME the applications send their data as frames instead of a raw byte offset by
+ * 0x21 ("ascii format"):
+ *
+ * | version << 4 | node ID | sequence | type | length | value (length) | type | ... |
+ *
+ *      version     FRAME_VERSION in the high nibble, the low nibble is 0.
+ *      node ID     The sender, FRAME_NODE_ID unless the application sets its own.
+ *      sequence    Counted by the sender, one per frame; the same for a frame sent again.
+ *      records     Up to the end of the payload, or up to a FRAME_PAD type byte after
+ *                  which the rest is padding (the Zeta+ receives packets of a fixed length).
+ *
+ * The encoder (frame_begin(), frame_put(), frame_reserve()) writes into the buffer passed
+ * to zeta_send_packet(), nothing is built elsewhere and copied. The decoder checks the whole
+ * frame in frame_open(), so a malformed one is rejected before any of it is used, and
+ * frame_next() then returns each record as a view into the received packet, not a copy.
+ * Values are LSB first.
+ */
+
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+#include <Proj_library/h_files/t1_util.h>
+
+//#define T1_FRAME      ///< "Uncomment" to send the applications' data as frames.
+
+#define FRAME_VERSION   1u
+#define FRAME_NODE_ID   1u      ///< Node ID of the applications, set per node.
+#define FRAME_HDR_LEN   3u
+#define FRAME_REC_LEN(n) (2u + (n))     ///< A record with an n byte value.
+
+/// Record types.
+enum {
+    FRAME_PAD = 0x00,       ///< No more records, the rest of the payload is padding.
+    FRAME_DATA = 0x01,      ///< Data values, a byte each (the Tx application's count).
+    FRAME_END = 0x02,       ///< End of a burst, the value is the number of data values sent.
+    FRAME_DELTA = 0x03      ///< Data values as a delta compressed stream (t1_delta.h).
+};
+
+/// Payload of the Tx/Rx applications' data packets: a frame with a 1 byte record, or the raw
+/// byte without T1_FRAME. With T1_DELTA a whole burst, its FRAME_DELTA record of up to
+/// FRAME_DELTA_MAX bytes and its FRAME_END, padded.
+#if defined(T1_DELTA)
+#define FRAME_DELTA_MAX 8u
+#define FRAME_DATA_LEN  (FRAME_HDR_LEN + FRAME_REC_LEN(FRAME_DELTA_MAX) + FRAME_REC_LEN(1u))
+#elif defined(T1_FRAME)
+#define FRAME_DATA_LEN  (FRAME_HDR_LEN + FRAME_REC_LEN(1u))
+#else
+#define FRAME_DATA_LEN  1u
+#endif // T1_FRAME
+
+typedef struct {
+    uint8_t *buf;           ///< The packet buffer written to.
+    uint8_t size;           ///< Its length.
+    uint8_t len;            ///< Bytes written, the payload length to send.
+} frame_t;
+
+typedef struct {
+    const uint8_t *buf;     ///< The received payload.
+    uint8_t len;            ///< Its length, up to the padding.
+    uint8_t pos;            ///< Next record.
+    uint8_t node;           ///< Sender's node ID.
+    uint8_t seq;            ///< Sender's sequence number.
+} frame_reader_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t len;
+    const uint8_t *value;   ///< Into the received payload.
+} frame_rec_t;
+
+/**
+ * @brief Start a frame in a packet buffer.
+ *
+ * @param f : Frame to start.
+ * @param buf : Packet buffer, at least FRAME_HDR_LEN bytes.
+ * @param size : Its length.
+ * @param node : Sender's node ID.
+ * @param seq : Sequence number.
+ */
+void frame_begin(frame_t *f, uint8_t *buf, uint8_t size, uint8_t node, uint8_t seq);
+
+/**
+ * @brief Add a record and return where its value goes, to write it in place.
+ *
+ * @param f : Frame.
+ * @param type : Record type, not FRAME_PAD.
+ * @param len : Value length.
+ * @return The value's place in the packet buffer, NULL if it does not fit (nothing added).
+ */
+uint8_t *frame_reserve(frame_t *f, uint8_t type, uint8_t len);
+
+/**
+ * @brief Add a record.
+ *
+ * @param f : Frame.
+ * @param type : Record type, not FRAME_PAD.
+ * @param value : Value, len bytes.
+ * @param len : Value length.
+ * @return Error status.
+ * @retval ERROR_OK - Added.
+ * @retval ERROR_NOBUFS - Does not fit, nothing added.
+ */
+error_t frame_put(frame_t *f, uint8_t type, const void *value, uint8_t len);
+
+/**
+ * @brief Shorten the last record added, to the bytes of its value actually written.
+ *
+ * For a value whose length is only known once it is written in place, such as a
+ * FRAME_DELTA stream: reserve the most it may take, write it, then trim.
+ *
+ * @param f : Frame.
+ * @param value : The last record's value, from frame_reserve().
+ * @param len : Its length now, up to the length reserved.
+ */
+void frame_trim(frame_t *f, uint8_t *value, uint8_t len);
+
+/**
+ * @brief Pad a frame with FRAME_PAD to a fixed payload length.
+ *
+ * @param f : Frame.
+ * @param len : Payload length wanted, up to the buffer's size. Nothing is done below f->len.
+ */
+void frame_pad(frame_t *f, uint8_t len);
+
+/**
+ * @brief Check a received frame and start reading its records.
+ *
+ * @param r : Reader to start.
+ * @param buf : Payload as received.
+ * @param len : Payload length.
+ * @return Error status.
+ * @retval ERROR_OK - Well formed, r set to the first record.
+ * @retval ERROR_RANGE - Shorter than the header, another version, or a record running past
+ *  the end of the payload. r is not to be used.
+ */
+error_t frame_open(frame_reader_t *r, const uint8_t *buf, uint8_t len);
+
+/**
+ * @brief Next record of a frame.
+ *
+ * @param r : Reader, from frame_open().
+ * @param[out] rec : The record, its value a view into the payload.
+ * @return Error status.
+ * @retval ERROR_OK - rec set.
+ * @retval ERROR_NOBUFS - No more records.
+ */
+error_t frame_next(frame_reader_t *r, frame_rec_t *rec);
+
+#endif // FRAME_H
@@ -27,6 +27,7 @@
 
 #include <stdint.h>
 #include <msp430.h>
+#include <Proj_library/h_files/t1_util.h>
 
 //#define MANUAL  ///< "Uncomment" for manual CS toggling.
 
@@ -35,6 +36,12 @@
 #define SCLK (BIT2) ///< SPI clock (P5.2).
 #define CS   (BIT3) ///< Chip select pin for SPI (P5.3).
 
+#define SPI_BRW ((SMCLK_HZ + SPI_MAX_HZ - 1) / SPI_MAX_HZ) ///< SMCLK divider, at most SPI_MAX_HZ.
+
+#if (SMCLK_HZ / SPI_BRW) > SPI_MAX_HZ
+#error "SPI clock above the Zeta+ limit"
+#endif
+
 /**
  * @brief Initialises the SPI peripheral on eUSCI B1.
  *
@@ -46,8 +53,8 @@
  * 5. SMCLK @ 1MHz as source.
  *
  * @ingroup init
- * @note ZETAPLUS has a max. SPI frequency of 1.4MHz, that's why
- * SMCLK is set t0 1MHz.
+ * @note ZETAPLUS has a max. SPI frequency of 1.4MHz (SPI_MAX_HZ), that's why
+ * SMCLK is set t0 1MHz in every clock profile and divided by SPI_BRW.
  */
 void spi_init(void);
 
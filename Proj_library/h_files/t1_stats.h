@@ -0,0 +1,126 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief Field statistics: event counters and an RSSI histogram in FRAM.
+ *
+ * For placing nodes and setting the radio's power: how often a node wakes, receives,
+ * times out or drops a packet, and how strong the packets it receives are. Each count is a
+ * 32-bit increment in FRAM, a few cycles, so the counters stay built in in the field. The
+ * block survives power loss and can be read back in two ways:
+ *
+ *     1. In CCS, open Memory Browser at &field_stats and save sizeof(field_stats_t) bytes
+ *        as raw binary (little-endian), or take the simulator's --fram-out. On the host:
+ *        host/stats_decode <dump.bin>
+ *     2. With T1_TELEMETRY, telemetry_field() sends it on the UART (t1_uart.h), 'F' and
+ *        'H' lines.
+ *
+ * | Counter              | Counted by                                                     |
+ * |----------------------|----------------------------------------------------------------|
+ * | STATS_BOOTS          | clock_init(), every power-up                                   |
+ * | STATS_RX             | t1_main_Rx.c, a packet read whole                              |
+ * | STATS_TIMEOUTS       | t1_main_Rx.c, no packet within ZETA_TIMEOUT_MS of rx mode      |
+ * | STATS_CRC            | t1_main_Rx.c, zeta_rx_packet() ERROR_CRC (T1_CRC, T1_FEC)      |
+ * | STATS_AUTH           | t1_main_Rx.c, zeta_rx_packet() ERROR_AUTH (T1_AES)             |
+ * | STATS_BAD_FRAMES     | t1_main_Rx.c, a payload frame_open() or delta_get() rejects    |
+ * | STATS_MAILBOX_FULL   | t1_main_Rx.c, a value mailbox_push() had no room for           |
+ * | STATS_RESTORES       | Hibernus, a Restore() that resumed the image                   |
+ * | STATS_RESTORE_FAILED | Hibernus, a Restore() that fell through                        |
+ *
+ * Histogram bin k counts the packets received with an RSSI byte ('#', 'R', <len>, <rssi>)
+ * of k * STATS_RSSI_STEP to (k + 1) * STATS_RSSI_STEP - 1, saturating at 0xFFFF.
+ *
+ * Counted from the main loop only, not from interrupts. Without T1_STATS every count
+ * compiles away and the block takes no FRAM.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <msp430.h>
+#include <stdint.h>
+#include <Proj_library/h_files/t1_util.h>
+
+//#define T1_STATS  ///< "Uncomment" to keep the field statistics in FRAM.
+
+#define STATS_MAGIC     0x5346  ///< 'FS', marks an initialised block.
+#define STATS_VERSION   1u      ///< Bumped whenever field_stats_t changes layout.
+#define STATS_RSSI_BINS 32u     ///< RSSI histogram bins.
+#define STATS_RSSI_STEP (256u / STATS_RSSI_BINS)    ///< RSSI values a bin.
+
+typedef enum {
+    STATS_BOOTS = 0, STATS_RX, STATS_TIMEOUTS, STATS_CRC, STATS_AUTH, STATS_BAD_FRAMES,
+    STATS_MAILBOX_FULL, STATS_RESTORES, STATS_RESTORE_FAILED,
+    STATS_COUNTERS
+} stats_id_t;
+
+/**
+ * @brief FRAM-resident statistics block.
+ *
+ * @note Decoded field by field by host/stats_decode.c, keep both in step and bump
+ * STATS_VERSION on any change.
+ */
+typedef struct {
+    uint16_t magic;                     ///< STATS_MAGIC.
+    uint16_t version;                   ///< STATS_VERSION.
+    uint8_t counters;                   ///< STATS_COUNTERS.
+    uint8_t bins;                       ///< STATS_RSSI_BINS.
+    uint16_t restoring;                 ///< Set while a Restore() is in flight.
+    uint32_t count[STATS_COUNTERS];     ///< By stats_id_t.
+    uint16_t rssi[STATS_RSSI_BINS];     ///< Saturating histogram.
+} field_stats_t;
+
+#ifdef T1_STATS
+
+extern field_stats_t field_stats;
+
+/**
+ * @brief Count an event.
+ *
+ * @param id : Counter.
+ */
+void stats_count(stats_id_t id);
+
+/**
+ * @brief Add a received packet's RSSI to the histogram.
+ *
+ * @param rssi : RSSI byte of the '#R' header.
+ */
+void stats_rssi(uint8_t rssi);
+
+/**
+ * @brief Count a power-up. Called by clock_init().
+ */
+void stats_boot(void);
+
+/**
+ * @brief Restore() hooks: started, resumed in the image (the first code it runs), fell
+ * through.
+ */
+void stats_restore(void);
+void stats_resumed(void);
+void stats_restore_failed(void);
+
+/**
+ * @brief Zero the counters and the histogram.
+ */
+void stats_clear(void);
+
+#define STATS(id)               stats_count(id)
+#define STATS_RSSI(rssi)        stats_rssi(rssi)
+#define STATS_POWER_UP()        stats_boot()
+#define STATS_RESTORE()         stats_restore()
+#define STATS_RESUMED()         stats_resumed()
+#define STATS_RESTORE_FAILED()  stats_restore_failed()
+
+#else
+
+#define STATS(id)
+#define STATS_RSSI(rssi)
+#define STATS_POWER_UP()
+#define STATS_RESTORE()
+#define STATS_RESUMED()
+#define STATS_RESTORE_FAILED()
+
+#endif // T1_STATS
+
+#endif // STATS_H
@@ -0,0 +1,69 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief Software timers sharing Timer_B0.
+ *
+ * Timer_B0 runs from ACLK (the calibrated VLO, see vlo_calibrate()) in continuous mode.
+ * Its count and overflows make a 32-bit tick count, and its CCR0 interrupt is set for the
+ * nearest deadline of up to TIMER_SLOTS one-shot and periodic timers. Deadlines more than
+ * one counter period away are picked up by the overflow interrupt (about every 7s).
+ * Nothing runs between expiries, the CPU can sleep in LPM3.
+ *
+ * Callbacks run in the Timer_B0 interrupt. A callback that returns non-zero wakes the CPU
+ * from low-power mode on return from the interrupt, as wait_ms() does.
+ *
+ * The timer table is in RAM and Timer_B0 is among the registers Hibernus saves, so a
+ * restored image carries on with its timers.
+ */
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <msp430.h>
+#include <stdint.h>
+#include <Proj_library/h_files/t1_util.h>
+
+#define TIMER_SLOTS 8u      ///< Timers that can run at once.
+#define TIMER_NONE  (-1)    ///< Id of no timer.
+
+typedef int8_t timer_id_t;
+typedef uint8_t (*timer_cb_t)(void);    ///< Returns non-zero to wake the CPU.
+
+/**
+ * @brief Clear all timers and start Timer_B0. Called by clock_init().
+ */
+void timer_init(void);
+
+/**
+ * @brief Start a timer.
+ *
+ * @param[out] id - Set to the timer's id, for timer_cancel(). A one-shot timer sets it to
+ *                   TIMER_NONE when it expires, so it must stay in scope until then.
+ * @param ms : Delay to the first expiry [ms].
+ * @param period_ms : Delay between further expiries [ms], 0 for a one-shot timer.
+ * @param cb : Called from the interrupt at each expiry.
+ * @return Error status.
+ * @retval ERROR_OK - No errors, timer running.
+ * @retval ERROR_NOBUFS - All TIMER_SLOTS are in use, id set to TIMER_NONE.
+ */
+error_t timer_add(timer_id_t *id, uint16_t ms, uint16_t period_ms, timer_cb_t cb);
+
+/**
+ * @brief Stop a timer, if it is still running (nothing if id is TIMER_NONE).
+ *
+ * @param[in,out] id - Timer to stop, set to TIMER_NONE.
+ */
+void timer_cancel(timer_id_t *id);
+
+/**
+ * @brief Ticks (ACLK periods) since timer_init().
+ */
+uint32_t timer_now(void);
+
+/**
+ * @brief Set Timer_B0 up again for the nearest deadline, after its registers were
+ * written from outside (a Hibernus restore).
+ */
+void timer_resync(void);
+
+#endif // TIMER_H
@@ -0,0 +1,110 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief Event trace in a FRAM ring, for profiling the hot paths.
+ *
+ * Each trace point (TRACE()) writes an 8 byte record: the software timer tick count
+ * (timer_now(), ACLK periods since the power-up's timer_init()), an event id, the number of
+ * the power-up and a 16-bit argument. The ring holds the last TRACE_LEN records and is kept
+ * in FRAM, so it survives power loss and a node can be read back after it has run:
+ *
+ *     1. In CCS, open Memory Browser at &trace_ring and save sizeof(trace_ring_t) bytes
+ *        as raw binary (little-endian).
+ *     2. On the host: host/trace_decode <dump.bin>
+ *
+ * clock_init() starts each power-up with a TRACE_BOOT record holding the calibrated VLO
+ * frequency, the decoder uses it to turn ticks into milliseconds. A power-up that Hibernus
+ * resumes carries on with the tick count of the image, after its TRACE_RESTORE record.
+ *
+ * | Event               | Trace point                                 | arg                  |
+ * |---------------------|---------------------------------------------|----------------------|
+ * | TRACE_BOOT          | clock_init()                                | VLO frequency [Hz]   |
+ * | TRACE_ZETA_CMD      | each Zeta+ command (t1_zeta.c)              | command, first param |
+ * | TRACE_ZETA_WAIT     | zeta_wait_irq() starts waiting for nIRQ     | 0                    |
+ * | TRACE_ZETA_IRQ      | zeta_wait_irq() returns                     | error_t              |
+ * | TRACE_ZETA_TIMEOUT  | zeta_timeout(), ZETA_TIMEOUT_MS elapsed     | 0                    |
+ * | TRACE_MAILBOX_PUSH  | mailbox_push()                              | data, error_t        |
+ * | TRACE_MAILBOX_POP   | mailbox_pop()                               | data, error_t        |
+ * | TRACE_HIBERNATE     | Checkpoint(), the HIBERNUS_HYBRID delta     | 0 image, 1 delta     |
+ * | TRACE_RESTORE       | Restore()                                   | 0                    |
+ * | TRACE_POWER_OFF     | power_off()                                 | 0                    |
+ *
+ * Two-byte arguments are the first in the low byte. A record costs a timer_now() call and
+ * four FRAM writes with interrupts held off. Without T1_TRACE every trace point compiles
+ * away and the ring takes no FRAM.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <msp430.h>
+#include <stdint.h>
+#include <Proj_library/h_files/t1_util.h>
+
+//#define T1_TRACE  ///< "Uncomment" to record trace events in FRAM.
+
+#define TRACE_MAGIC     0x5254  ///< 'TR', marks an initialised ring.
+#define TRACE_VERSION   1u      ///< Bumped whenever trace_ring_t changes layout.
+#define TRACE_LEN       256u    ///< Records kept, a power of two (2kB of FRAM).
+
+typedef enum {
+    TRACE_BOOT = 1, TRACE_ZETA_CMD, TRACE_ZETA_WAIT, TRACE_ZETA_IRQ, TRACE_ZETA_TIMEOUT,
+    TRACE_MAILBOX_PUSH, TRACE_MAILBOX_POP, TRACE_HIBERNATE, TRACE_RESTORE, TRACE_POWER_OFF,
+    TRACE_IDS
+} trace_id_t;
+
+typedef struct {
+    uint32_t ticks;     ///< timer_now() at the trace point.
+    uint8_t id;         ///< trace_id_t.
+    uint8_t boot;       ///< Power-up number, low byte of trace_ring.boots.
+    uint16_t arg;
+} trace_rec_t;
+
+/**
+ * @brief FRAM-resident trace ring.
+ *
+ * @note Decoded field by field by host/trace_decode.c, keep both in step and bump
+ * TRACE_VERSION on any change.
+ */
+typedef struct {
+    uint16_t magic;     ///< TRACE_MAGIC.
+    uint16_t version;   ///< TRACE_VERSION.
+    uint16_t len;       ///< TRACE_LEN.
+    uint16_t boots;     ///< Power-ups traced.
+    uint32_t count;     ///< Records written, the next goes to rec[count % TRACE_LEN].
+    trace_rec_t rec[TRACE_LEN];
+} trace_ring_t;
+
+#ifdef T1_TRACE
+
+extern trace_ring_t trace_ring;
+
+/**
+ * @brief Record an event. Safe to call from interrupts.
+ *
+ * @param id : Event.
+ * @param arg : Its argument.
+ */
+void trace_put(trace_id_t id, uint16_t arg);
+
+/**
+ * @brief Count a power-up and record TRACE_BOOT. Called by clock_init().
+ */
+void trace_boot(void);
+
+/**
+ * @brief Empty the ring and zero the power-up count.
+ */
+void trace_clear(void);
+
+#define TRACE(id, arg)      trace_put((id), (uint16_t)(arg))
+#define TRACE_POWER_UP()    trace_boot()
+
+#else
+
+#define TRACE(id, arg)
+#define TRACE_POWER_UP()
+
+#endif // T1_TRACE
+
+#endif // TRACE_H
@@ -0,0 +1,100 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief Telemetry on eUSCI_A0 (UART), sent by DMA without blocking the application.
+ *
+ * uart_write() copies a message into a RAM ring and returns. DMA channel 0, triggered by
+ * UCA0TXIFG, moves it to UCA0TXBUF a byte at a time, so a message costs the CPU its copy
+ * only. The ring goes out in contiguous runs, DMA0's interrupt starts the next. A message
+ * that does not fit in the free space is dropped whole and counted in uart_dropped, the
+ * caller never waits. uart_drain() is the exception, for the end of a wake-up: it sleeps
+ * in LPM0 until the ring is out, before the supply is switched off.
+ *
+ * Pins: P2.0 UCA0TXD (the LaunchPad's back-channel UART), P2.1 UCA0RXD (unused).
+ * 115200 baud 8N1 from SMCLK, 1MHz in every clock profile. While a run is being sent the
+ * eUSCI keeps SMCLK requested, in LPM3 too.
+ *
+ * The telemetry_*() calls send one text line each, hex fields after a letter:
+ *
+ * | Line | Call                | Fields                                               |
+ * |------|---------------------|------------------------------------------------------|
+ * | M    | telemetry_mailbox() | entries held, then each, oldest first                |
+ * | R    | telemetry_rssi()    | RSSI byte of a received packet                       |
+ * | T    | telemetry_trace()   | power-up, ticks, event id, arg (t1_trace.h records)  |
+ * | S    | telemetry_stats()   | uart_dropped, event_dropped, VLO frequency [Hz]      |
+ * | F    | telemetry_field()   | stats_id_t, its count (t1_stats.h)                   |
+ * | H    | telemetry_field()   | RSSI histogram bin, its count, nonzero bins only     |
+ *
+ * telemetry_trace() sends the records written since the last it sent (trace_sent, in
+ * FRAM), as many as fit, and without T1_TRACE nothing. telemetry_field() sends the whole
+ * of field_stats once a call sequence, and without T1_STATS nothing. On the host simulator the bytes
+ * go to the file or FIFO given with --uart.
+ */
+
+#ifndef UART_H
+#define UART_H
+
+#include <msp430.h>
+#include <stdint.h>
+#include <Proj_library/h_files/t1_util.h>
+
+//#define T1_TELEMETRY  ///< "Uncomment" to send telemetry on eUSCI_A0.
+
+#define UART_TX_LEN     256u    ///< Transmit ring [bytes], a power of two.
+#define UART_BRW        8u      ///< 115200 baud from 1MHz: UCOS16 = 0, UCBRx = 8,
+#define UART_MCTLW      (0xD6 * UCBRS0) ///< UCBRSx = 0xD6 (SLAU367, baud rate table).
+#define TELEMETRY_LINE  40u     ///< Longest telemetry line [bytes].
+
+#ifdef T1_TELEMETRY
+
+/**
+ * @brief Set up eUSCI_A0 and DMA channel 0, and empty the ring.
+ */
+void uart_init(void);
+
+/**
+ * @brief Queue a message for sending. Not for interrupts.
+ *
+ * @param data : Bytes to send.
+ * @param len : How many.
+ * @return Error status.
+ * @retval ERROR_OK - Queued whole.
+ * @retval ERROR_NOBUFS - Not enough room, nothing queued, uart_dropped counted.
+ */
+error_t uart_write(const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Free space in the ring [bytes].
+ */
+uint16_t uart_free(void);
+
+/**
+ * @brief Sleep in LPM0 until everything queued has been sent, and wait for the last frame.
+ */
+void uart_drain(void);
+
+void telemetry_mailbox(void);
+void telemetry_rssi(uint8_t rssi);
+void telemetry_stats(void);
+
+/**
+ * @brief Send trace records not sent yet, while they fit in the ring.
+ *
+ * @return Records still waiting.
+ */
+uint16_t telemetry_trace(void);
+
+/**
+ * @brief Send the field statistics, F lines then H lines, while they fit in the ring.
+ *
+ * Call until it returns 0, the next call starts over.
+ *
+ * @return Lines still waiting.
+ */
+uint16_t telemetry_field(void);
+
+extern uint16_t uart_dropped;   ///< Messages lost to a full ring.
+
+#endif // T1_TELEMETRY
+
+#endif // UART_H
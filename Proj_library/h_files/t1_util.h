@@ -37,6 +37,56 @@
 // State definitions.
 #define COMPARATOR_ON (P4IN & EXT_COMP) ///< Tests the state of the comparator output.
 #define BUFFER_SIZE 10u ///< Number of bytes in mailbox buffer.
+#define LED_FLASH_MS 400u   ///< Each half of led_flash(), as at the 1MHz MCLK it was set for.
+
+// Clocks (see clock_init() and clock_set_profile()).
+#define SMCLK_HZ 1000000UL  ///< 1MHz in every profile, the reference for VLO calibration.
+#define MCLK_HZ 8000000UL   ///< MCLK in CLOCK_DEFAULT, what __delay_cycles() counts in.
+#define MCLK_MAX_HZ 16000000UL  ///< MCLK in CLOCK_BURST, the fastest profile.
+#define SPI_MAX_HZ 1400000UL    ///< Fastest SPI clock the Zeta+ accepts.
+#define FRAM_MAX_HZ 8000000UL   ///< Fastest MCLK without FRAM wait states.
+#define VLO_NOMINAL_HZ 9400u    ///< Typical VLO frequency, used until the first calibration.
+#define VLO_MIN_HZ 4000u    ///< Calibration results outside these limits are discarded.
+#define VLO_MAX_HZ 20000u
+#define VLO_CAL_TICKS 128u  ///< ACLK periods measured per calibration (~14ms).
+#define VLO_CAL_BOOTS 16u   ///< Power-ups between calibrations.
+
+/* Host simulator hooks. host/include/msp430.h defines these for the Linux build (see
+ * host/readme.txt), on the MSP430 they compile away. */
+#ifndef T1_HOST
+#define SIM_ADDR(a)     ((void *)(a))   ///< Device address as a pointer.
+#define SIM_FRAM                        ///< FRAM variable (placed by #pragma on target).
+#define SIM_CYCLES(n)                   ///< Cycles of work the simulator cannot see.
+#define SIM_PHASE(p)                    ///< Start of a Hibernus phase.
+#define SIM_SNAPSHOT(slot)              ///< Hibernus snapshot point.
+#define SIM_RESUME(slot)                ///< Hibernus jump back into the snapshot.
+#define SIM_COMMIT()                    ///< Task runtime commit point.
+#define SIM_ROLLBACK()                  ///< Task runtime restart from the last commit.
+#define SIM_RESTART()                   ///< Application starts over from main().
+#define SIM_MARK(stage)                 ///< Wake-up latency stage reached (a string).
+#endif // T1_HOST
+
+/* Hot paths in RAM. Functions marked RAMFUNC (spi_xfer(), the PORT4 and timer ISRs, the
+ * Hibernus RAM copy) are linked into .TI.ramfunc, copied from FRAM to the start of RAM at
+ * boot and run from there: no FRAM wait states at the 16MHz CLOCK_BURST profile and less
+ * active current at any clock. Hibernus leaves the RAM they occupy out of its image (see
+ * HIB_RAM_START in hibernation_5994.h). Costs RAM, see 'make bench' in host/ for the gain
+ * on each path. Needs TI compiler 15.9 or later. */
+//#define T1_RAMFUNC  ///< "Uncomment" to run the hot paths from RAM.
+
+#ifdef T1_RAMFUNC
+#ifndef T1_HOST
+#define RAMFUNC __attribute__((ramfunc))    ///< Run from RAM, see lnk_msp430fr5994.cmd.
+#else
+#define RAMFUNC SIM_RAMFUNC
+#endif // T1_HOST
+#else
+#define RAMFUNC
+#endif // T1_RAMFUNC
+
+// DMAxSA/DA are 20-bit, a plain word write would clear A19-16.
+#define DMA_ADDR(reg, p) \
+    __data16_write_addr((unsigned short)(uintptr_t) &(reg), (unsigned long)(uintptr_t)(p))
 
 //*************************************************************************************
 
@@ -46,9 +96,24 @@ typedef struct {
 } buffer_t;
 
 typedef enum {
-    ERROR_OK = 0, ERROR_NOBUFS, ERROR_TIMEOUT
+    ERROR_OK = 0, ERROR_NOBUFS, ERROR_TIMEOUT, ERROR_RANGE, ERROR_AUTH, ERROR_CRC
 } error_t;
 
+typedef enum {
+    CLOCK_LOW_POWER = 0,    ///< MCLK 1MHz, for waiting on peripherals.
+    CLOCK_DEFAULT,          ///< MCLK 8MHz, set by clock_init().
+    CLOCK_BURST,            ///< MCLK 16MHz with one FRAM wait state, for CPU-bound work.
+    CLOCK_PROFILES
+} clock_profile_t;
+
+typedef struct {
+    uint16_t hz;        ///< Measured VLO (ACLK) frequency.
+    uint16_t age;       ///< Power-ups since it was measured.
+} vlo_cal_t;
+
+extern vlo_cal_t vlo_cal;
+extern buffer_t mailbox;    ///< Received data, in FRAM. Use the mailbox_*() calls to change it.
+
 //*************************************************************************************
 
 /**
@@ -74,44 +139,116 @@ void io_init(void);
  * | SMCLK |   DCO  |  1MHz |
  * | ACLK  |   VLO  | 10kHz |
  *
+ * (CLOCK_DEFAULT.) Calibrates the VLO every VLO_CAL_BOOTS power-ups (vlo_check()), then
+ * starts the software timers (timer_init()).
  */
 void clock_init(void);
 
-//*************************************************************************************
 
 /**
- * @defgroup timers Timers
- * @brief Control of timer module for timeout protection.
- * @{
+ * @brief clock_init() without the VLO calibration.
+ *
+ * The timers run on the last vlo_cal.hz. For a power-up that may end straight away, as a
+ * wake-up for another node does (t1_wake.h): call vlo_check() once it goes on.
  */
+void clock_start(void);
+
 
 /**
- * @brief Start running the timer.
+ * @brief Switch MCLK to another clock profile.
+ *
+ * | Profile         | DCO    | MCLK   | SMCLK     | FRAM wait states |
+ * |-----------------|--------|--------|-----------|------------------|
+ * | CLOCK_LOW_POWER |  1MHz  |  1MHz  | 1MHz (/1) | 0                |
+ * | CLOCK_DEFAULT   |  8MHz  |  8MHz  | 1MHz (/8) | 0                |
+ * | CLOCK_BURST     | 16MHz  | 16MHz  | 1MHz (/16)| 1                |
+ *
+ * SMCLK stays at SMCLK_HZ and ACLK on the VLO, so the SPI clock (below SPI_MAX_HZ) and
+ * the timers are not affected. The wait state is added before MCLK goes above
+ * FRAM_MAX_HZ and removed after it comes back down. Interrupts are held off during the
+ * switch. Do not switch in the middle of an SPI transfer, SMCLK runs at a quarter of its
+ * frequency for a few microseconds while the DCO settles.
+ *
+ * @param profile : Profile to switch to.
+ * @return Error status.
+ * @retval ERROR_OK - Switched.
+ * @retval ERROR_RANGE - No such profile, clocks left as they were.
  */
-inline void timer_start(void);
+error_t clock_set_profile(clock_profile_t profile);
 
 
 /**
- * @brief Stop and reset the timer.
+ * @brief Current clock profile.
+ *
+ * @return Profile last set by clock_set_profile() or clock_init().
  */
-inline void timer_stop(void);
+clock_profile_t clock_get_profile(void);
+
 
 /**
- * @brief Control of timer module for 0.1 second delay packet transmission.
+ * @brief Profile a saved CSCTL1 belongs to, for putting the clocks back with
+ * clock_set_profile() rather than by writing CSCTL1 (Hibernus' Restore_GPR()).
+ *
+ * @param ctl1 : Saved CSCTL1.
+ * @return Profile with the same DCO setting, CLOCK_DEFAULT if there is none.
  */
+clock_profile_t clock_profile_of(uint16_t ctl1);
+
 
 /**
- * @brief Start running timer B
+ * @brief Measure the VLO against SMCLK and keep the result in FRAM (vlo_cal).
+ *
+ * Timer_A0 counts VLO_CAL_TICKS periods of ACLK while Timer_A1 counts SMCLK. Both are
+ * stopped afterwards.
+ *
+ * @return Error status.
+ * @retval ERROR_OK - vlo_cal.hz updated.
+ * @retval ERROR_RANGE - Result outside VLO_MIN_HZ-VLO_MAX_HZ, vlo_cal left as it was.
  */
-inline void timerB_start (void);
+error_t vlo_calibrate(void);
+
 
 /**
- * @brief Stop and reset the timer.
+ * @brief Calibrate the VLO if VLO_CAL_BOOTS power-ups have passed since the last time, or
+ * vlo_cal.hz is out of range. Called by clock_init().
+ *
+ * A failed calibration leaves VLO_NOMINAL_HZ.
  */
-inline void timerB_stop (void);
+void vlo_check(void);
+
 
 /**
- * @brief Delay code by 1 second (TimerB start/stop).
+ * @brief Convert a duration to ACLK periods with the calibrated VLO frequency.
+ *
+ * @param ms : Duration [ms].
+ * @return Periods, at least 1 and at most 0xFFFF.
+ */
+uint16_t ms_to_aclk(uint16_t ms);
+
+//*************************************************************************************
+
+/**
+ * @defgroup timers Timers
+ * @brief Delays on the software timers (t1_timer.h).
+ * @{
+ */
+
+/**
+ * @brief Delay code, on a one-shot software timer.
+ *
+ * The CPU sleeps in LPM3 until the timer expires, with interrupts on, and the caller's
+ * GIE is put back. Takes a free timer slot. If there is none it waits the same time awake,
+ * polling timer_now(), exact for waits up to two Timer_B0 periods with interrupts off.
+ *
+ * @param ms : Delay [ms].
+ * @return Error status.
+ * @retval ERROR_OK - Waited asleep.
+ * @retval ERROR_NOBUFS - No timer free, waited awake.
+ */
+error_t wait_ms(uint16_t ms);
+
+/**
+ * @brief Delay code by 1 second, wait_ms(1000).
  */
 inline void wait_one_second(void);
 
@@ -137,7 +274,8 @@ void led_clear(void);
 
 
 /**
- * @brief Flash the LEDs to indicate a timeout has occured.
+ * @brief Flash the LEDs to indicate a timeout has occured, LED_FLASH_MS on each pair at
+ * CLOCK_DEFAULT.
  */
 void led_flash(void);
 
@@ -186,4 +324,21 @@ error_t mailbox_push(uint8_t new);
 error_t mailbox_pop(uint8_t *out);
 
 
+/**
+ * @brief Oldest data in the box, left in it.
+ *
+ * @param[out] out - Address to write the data to.
+ * @return Error status.
+ * @retval ERROR_OK - No errors, data copied.
+ * @retval ERROR_NOBUFS - Buffer empty.
+ */
+error_t mailbox_peek(uint8_t *out);
+
+
+/**
+ * @brief Number of entries waiting in the box.
+ */
+uint8_t mailbox_count(void);
+
+
 #endif // UTIL_H
@@ -0,0 +1,77 @@
+/**
+ * @author Piotr Krawiec <p.j.krawiec1@newcastle.ac.uk>
+ *
+ * @brief Wake codes: a wake-up packet that only keeps the intended receiver on.
+ *
+ * The receiver is powered up by the end of any packet it detects, and the wake-up packet is
+ * gone by the time it runs, so the code cannot be in the packet itself. With T1_WAKE the
+ * transmitter follows the wake-up packet with the code, on-off keyed in 1 byte pulses that
+ * the receiver sees on the wake-up detector's output (WAKE_DET, high while there is RF on
+ * air), before the radio is switched on:
+ *
+ *      | wake-up packet | WAKE_LEAD_MS | sync | WAKE_SLOT_MS | bit 3 | ... | bit 0 |
+ *
+ * A pulse in a slot is a one, none a zero, the MSB first. wake_check() latches the
+ * detector's rising edges in P4IFG with the CPU in LPM3: it waits for the sync pulse, then
+ * reads a slot at a time, offset by half a slot so that the pulses fall in the middle of
+ * its windows. A node that reads another code, or no sync pulse (it was woken by some other
+ * packet), powers off without touching the radio, WAKE_CHECK_MS at most. Codes are 1 to
+ * 2^WAKE_BITS - 1; two transmitters sending codes at the same time are read as one code.
+ */
+
+#ifndef WAKE_H
+#define WAKE_H
+
+#include <stdint.h>
+#include <Proj_library/h_files/t1_util.h>
+
+//#define T1_WAKE       ///< "Uncomment" to address the wake-up packets with a wake code.
+
+#ifndef WAKE_CODE
+#define WAKE_CODE       1u      ///< Receiver: this node's code, set per node.
+#endif
+#ifndef WAKE_DEST
+#define WAKE_DEST       1u      ///< Transmitter: code of the receiver woken.
+#endif
+
+#define WAKE_DET        (BIT2)  ///< Wake-up detector output connects to P4.2.
+#define WAKE_BITS       4u      ///< Bits of a code.
+#define WAKE_LEAD_MS    50u     ///< Wake-up packet to sync pulse, the receiver's boot.
+#define WAKE_SLOT_MS    8u      ///< A bit.
+#define WAKE_CHECK_MS   (WAKE_LEAD_MS + WAKE_SLOT_MS / 2u + (WAKE_BITS + 1u) * WAKE_SLOT_MS)
+
+#ifdef T1_WAKE
+#define WAKE_PACKETS    (2u + WAKE_BITS)    ///< Packets of a wake-up, at most.
+#else
+#define WAKE_PACKETS    1u
+#endif // T1_WAKE
+
+#ifdef T1_WAKE
+
+/**
+ * @brief Send a code after the wake-up packet.
+ *
+ * The radio is ready (zeta_select_mode(0x2)) and the wake-up packet has just been sent.
+ * Waits in LPM3 between the pulses, WAKE_LEAD_MS + WAKE_BITS * WAKE_SLOT_MS.
+ *
+ * @param code : Receiver's code, 1 to 2^WAKE_BITS - 1.
+ */
+void wake_send(uint8_t code);
+
+/**
+ * @brief Read the code after a wake-up.
+ *
+ * Straight after clock_start(), the timers are needed and the radio is not. The slots are
+ * timed with the last vlo_cal.hz, calibrate only once the code matches (vlo_check()).
+ *
+ * @param code : This node's code.
+ * @return Error status.
+ * @retval ERROR_OK - The code is this node's.
+ * @retval ERROR_TIMEOUT - No sync pulse, not a wake-up packet.
+ * @retval ERROR_RANGE - Another node's code.
+ */
+error_t wake_check(uint8_t code);
+
+#endif // T1_WAKE
+
+#endif // WAKE_H
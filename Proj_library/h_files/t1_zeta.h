@@ -24,8 +24,11 @@
 
 #include <stdint.h>
 #include <msp430.h>
-#include <Proj_Library/h_files/t1_spi.h>
-#include <Proj_Library/h_files/t1_util.h>
+#include <Proj_library/h_files/t1_spi.h>
+#include <Proj_library/h_files/t1_util.h>
+#include <Proj_library/h_files/t1_aes.h>
+#include <Proj_library/h_files/t1_crc.h>
+#include <Proj_library/h_files/t1_fec.h>
 /**
  * @brief Shutdown pin (P3.4).
  *
@@ -54,6 +57,42 @@
  */
 #define CHANNEL (0u)
 
+#define ZETA_TIMEOUT_MS (3000u) ///< zeta_wait_irq() gives up after this long.
+#define ZETA_SDN_MS     (20u)   ///< SDN pulse after ATB, the Zeta+ needs at least 15ms.
+
+#define BURST_END (0x04u)   ///< Payload of the packet that ends a burst (ASCII EOT).
+
+/* Payloads of n bytes with T1_AES (t1_aes.h), T1_CRC (t1_crc.h) and T1_FEC (t1_fec.h):
+ * length on air, and buffer to pass. The CRC goes straight to and from the SPI, not through
+ * the buffer, but with T1_FEC, where it is coded with the rest from the buffer. */
+#ifdef T1_FEC
+#define ZETA_FEC_BUF    CRC_LEN
+#else
+#define ZETA_FEC_BUF    0u
+#endif // T1_FEC
+#ifdef T1_AES
+#define ZETA_AIR_LEN(n) FEC_AIR_LEN((n) + AES_OVERHEAD + CRC_LEN)
+#define ZETA_BUF_LEN(n) (AES_BUF_LEN(n) + ZETA_FEC_BUF)
+#else
+#define ZETA_AIR_LEN(n) FEC_AIR_LEN((n) + CRC_LEN)
+#define ZETA_BUF_LEN(n) ((n) + ZETA_FEC_BUF)
+#endif // T1_AES
+
+#define ZETA_RF_POWER (127u)    ///< RF output power set by zeta_init(), see zeta_set_rf_power().
+#define ZETA_RF_BAUD (6u)       ///< RF baud rate set by zeta_init(), see zeta_set_baud_rf().
+
+/**
+ * @brief Supply current of the module [uA], for energy estimates (see t1_energy.h).
+ *
+ * From the Zeta+ and Si4455 data sheets. Transmit current grows with the power setting,
+ * taken as linear between power 0 and 127.
+ */
+#define ZETA_I_TX_MIN_UA (8000u)    ///< Transmitting at power 0.
+#define ZETA_I_TX_MAX_UA (24000u)   ///< Transmitting at power 127.
+#define ZETA_I_RX_UA (12000u)       ///< Receive mode.
+#define ZETA_I_READY_UA (2000u)     ///< Ready (mode 2), between packets.
+#define ZETA_I_SLEEP_UA (1u)        ///< Sleep (mode 3).
+
 /**
  * @brief Reverses the order of a byte.
  *
@@ -86,7 +125,8 @@ void zeta_init(void);
  *
  * @return Any errors while polling nIRQ pin.
  * @retval ERROR_OK - No errors.
- * @retval ERROR_TIMEOUT - Receive timeout, perhaps false wake-up.
+ * @retval ERROR_TIMEOUT - Receive timeout, perhaps false wake-up. The LEDs flash 3 times.
+ * @retval ERROR_NOBUFS - No software timer free for the timeout, nIRQ not polled.
  */
 error_t zeta_wait_irq(void);
 
@@ -271,6 +311,11 @@ void zeta_send_close(void);
 /**
  * @brief Send byte packet over radio.
  *
+ * With T1_AES the packet is encrypted in place and ZETA_AIR_LEN(len) bytes go on air, the
+ * buffer must hold ZETA_BUF_LEN(len) bytes. With T1_CRC the CRC module takes each byte as
+ * it is written, and the CRC follows the packet. With T1_FEC the CRC is written after the
+ * packet in the buffer and all of it goes on air coded, FEC_BLOCK bytes at a time.
+ *
  * @param[in] packet : Pointer to byte packet to send.
  * @param[in] len : Length of packet.
  */
@@ -297,6 +342,12 @@ error_t zeta_read_byte(uint8_t *out);
 /**
  * @brief Read packet from FIFO loop until empty.
  *
+ * With T1_AES the payload is checked and decrypted in place, and Length is its length. For
+ * a payload of n bytes, listen for ZETA_AIR_LEN(n) (zeta_rx_mode()) and pass a buffer of
+ * 4 + ZETA_BUF_LEN(n) bytes. With T1_CRC each byte goes to the CRC module as it is read,
+ * the CRC is checked before anything else and Length leaves it out. With T1_FEC the coded
+ * bytes are corrected as they are read, before the CRC, and Length is that of the data.
+ *
  * * '#' - Shows the start of a new packet.
  * * 'R' - Shows the start of a new packet.
  * * Length - Length of received packet.
@@ -306,6 +357,9 @@ error_t zeta_read_byte(uint8_t *out);
  * @param[out] packet : Array to return Rx'd packet to.
  * @retval ERROR_OK - No errors.
  * @retval ERROR_TIMEOUT - Receive timeout, perhaps false wake-up.
+ * @retval ERROR_AUTH - T1_AES: not from our transmitter, altered or replayed.
+ * @retval ERROR_CRC - T1_CRC: received with bit errors (or shorter than the CRC). T1_FEC:
+ *  bit errors it could not correct.
  */
 error_t zeta_rx_packet(uint8_t *packet);
 
@@ -26,29 +26,72 @@ Date modified by P. Krawiec, researching in Newcastle Univeristy: 07/04/2023.
 //******************************************************************************************************
 #include <Proj_library/hibernus/hibernation_5994.h>
 #include <Proj_library/h_files/t1_util.h>
+#include <Proj_library/h_files/t1_timer.h>
+#include <Proj_library/hibernus/hibernation_stats.h>
+#include <Proj_library/h_files/t1_trace.h>
+#include <Proj_library/h_files/t1_stats.h>
+#include <stddef.h>
+
+/* SIM_FRAM keeps these across power cycles in the host simulator (host/), on the MSP430 the
+ * sections do it. SIM_ADDR() maps device addresses onto the simulator's memory. */
+
+// Checkpoint image, never initialised (see hibernation_5994.h).
+#pragma DATA_SECTION (hib_image, ".hibernus")
+hib_image_t hib_image SIM_FRAM;
+
+/* Core registers are saved with MOVA to &hib_image+20 onwards, keep core[] there. */
+typedef char hib_image_core_offset[(offsetof(hib_image_t, core) == 20) ? 1 : -1];
+
+// Only initialised when flashing, 0 until the first power-up of a new firmware picks an epoch.
+#pragma PERSISTENT (hib_epoch)
+uint16_t hib_epoch SIM_FRAM = 0;
+
+#ifdef HIBERNUS_HYBRID
+// Deltas on top of hib_image, never initialised (see HIBERNUS_HYBRID).
+#pragma DATA_SECTION (hib_delta, ".hibernus")
+hib_delta_t hib_delta[HIB_DELTAS] SIM_FRAM;
+
+// Core registers of the delta being saved or restored, copied to or from its slot.
+#pragma DATA_SECTION (hib_delta_regs, ".hibernus")
+hib_regs_t hib_delta_regs SIM_FRAM;
+
+/* The PC is saved with MOVX.A to &hib_delta_regs, the core registers with MOVA to
+ * &hib_delta_regs+4 onwards. */
+typedef char hib_delta_core_offset[(offsetof(hib_regs_t, core) == 4) ? 1 : -1];
+#endif // HIBERNUS_HYBRID
 
 #pragma SET_DATA_SECTION(".fram_vars")
 
-unsigned long int *FRAM_write_ptr = (unsigned long int *) SAVING_RAM_LOCATION_START; //pointer for FRAM
-unsigned long int *RAM_copy_ptr = (unsigned long int *) RAM_START; //pointer that points the RAM
-unsigned long int *FLAG_interrupt = (unsigned long int *) INT; //Flag for Interrupt
-unsigned long int *CC_Check = (unsigned long int *) CHECK; //Flag for Restoring
+uint32_t *FRAM_write_ptr SIM_FRAM = hib_image.data; //pointer for FRAM
+uint32_t *RAM_copy_ptr SIM_FRAM = (uint32_t *) SIM_ADDR(RAM_START); //pointer that points the RAM
+uint32_t *FLAG_interrupt SIM_FRAM = &hib_image.flag_interrupt; //Flag for Interrupt
+uint32_t *CC_Check SIM_FRAM = &hib_image.cc_check; //Flag for Restoring
 
 // These pointers and variable are used to set the PC
-unsigned long int *PC_in_FRAM = (unsigned long int *) PROGRAM_COUNTER; //pointer for PC
-unsigned long int* current_SP;
+uint32_t *PC_in_FRAM SIM_FRAM = &hib_image.pc; //pointer for PC
+uint32_t *current_SP SIM_FRAM;
 
 // Array to restore state of registers
-unsigned int gpr_data[514];
+uint16_t gpr_data[514] SIM_FRAM;
 
-unsigned int *Reg_copy_ptr;
+uint16_t *Reg_copy_ptr SIM_FRAM;
 
-int pro;
-int t;
+int pro SIM_FRAM;
+int t SIM_FRAM;
+
+#ifdef HIBERNUS_HYBRID
+// Slot being saved or restored, 0 when Restore() found no delta.
+hib_delta_t *Delta_slot SIM_FRAM;
+
+// Used while a delta is copied back, RAM is being overwritten.
+uint16_t *Delta_src SIM_FRAM;
+uint16_t *Delta_dst SIM_FRAM;
+uint16_t *Delta_end SIM_FRAM;
+#endif // HIBERNUS_HYBRID
 
 #pragma SET_DATA_SECTION()
 
-const unsigned int gpr_locations[514] = {
+const uint16_t gpr_locations[514] = {
     /*Special Function Registers*/
     0x100, 0x102, 0x104,
     /*PMM*/
@@ -194,13 +237,93 @@ unsigned int i; // used in loops.
 
 //******************************************************************************************************
 
+static uint8_t Image_valid(void)
+{
+#ifdef HIBERNUS_COMPRESS
+    return (hib_image.header.magic == HIB_IMAGE_MAGIC_PACKED)
+        && (hib_image.header.version == HIB_IMAGE_VERSION)
+        && (hib_image.header.size <= sizeof(hib_image.data))
+        && (hib_image.header.epoch == hib_epoch);
+#else
+    return (hib_image.header.magic == HIB_IMAGE_MAGIC)
+        && (hib_image.header.version == HIB_IMAGE_VERSION)
+        && (hib_image.header.size == HIB_RAM_SIZE)
+        && (hib_image.header.epoch == hib_epoch);
+#endif // HIBERNUS_COMPRESS
+}
+
+#ifdef HIBERNUS_HYBRID
+
+// A delta is only applied on top of the full image it was taken against.
+static uint8_t Delta_valid(const hib_delta_t *d)
+{
+    return (d->header.magic == HIB_DELTA_MAGIC)
+        && (d->header.version == HIB_IMAGE_VERSION)
+        && (d->header.epoch == hib_epoch)
+        && (d->header.size <= sizeof(d->data))
+        && (d->gprs <= HIB_DELTA_GPRS)
+        && (d->stack >= HIB_RAM_START) && (d->stack <= RAM_END)
+        && (d->header.size == 2 * (d->low + (RAM_END - d->stack) / 2))
+        && (*CC_Check == 1) && Image_valid();
+}
+
+// The latest valid delta, 0 if there is none.
+static hib_delta_t *Delta_newest(void)
+{
+    hib_delta_t *d = 0;
+    uint8_t k;
+
+    for (k = 0; k < HIB_DELTAS; k++) {
+        if (Delta_valid(&hib_delta[k]) && (!d || ((int16_t)(hib_delta[k].seq - d->seq) > 0))) {
+            d = &hib_delta[k];
+        }
+    }
+    return d;
+}
+
+// Registers Restore_GPR() writes back, the others must not be logged in a delta either.
+static uint8_t Gpr_restored(uint16_t k)
+{
+#ifdef HIBERNUS_STATS
+    if ((k >= 136) && (k < 146)) {
+        return 0;
+    }
+#endif // HIBERNUS_STATS
+    return (k != 3) && (k != 6) && (k != 14) && (k != 15) && (k != 54) && (k != 55)
+        && (k != 270);
+}
+
+#endif // HIBERNUS_HYBRID
+
+//******************************************************************************************************
+
 void Hibernus(void){
     //For debugging: Hibernus/Interrupt Active
     P1OUT |= BIT0;
 
+    HIB_STATS_BOOT();
+
+    /* First power-up after flashing: whatever is in the image section was written by the old
+     * firmware. Take a new epoch, so its header can never match, and start as if FRAM had
+     * been erased. */
+    if (hib_epoch == 0) {
+        hib_epoch = hib_image.header.epoch + 1;
+        if (hib_epoch == 0) {
+            hib_epoch = 1;
+        }
+        *CC_Check = 0xFFFFFFFF;
+    }
+
+    // An image that claims to be complete but does not belong to this firmware is not restored.
+    if ((*CC_Check == 1) && !Image_valid()) {
+        *CC_Check = 0xFFFFFFFF;
+    }
+
     /* If the System has been run more than once, but has nothing to recover, indicate error,
     * for a few seconds, then force system to set up the interrupt to hibernate. */
     if(*CC_Check == 0){
+        HIB_STATS_INVALID_IMAGE();
+
         //For debugging: Indicating restoring error with Port 8 LEDs (5 times flash).
         P8OUT   &=  0x0F;
         for (i = 0; i < 5; i++) {
@@ -214,6 +337,7 @@ void Hibernus(void){
     *   - When the system incorrectly saves the state, *CC_Check is set to 0x0010 */
     if ((*CC_Check != 0) && (*CC_Check != 1)){
         *CC_Check = 0;
+        SIM_RESTART();
 
         if (!COMPARATOR_ON){
                 *FLAG_interrupt = 1;
@@ -224,6 +348,7 @@ void Hibernus(void){
 
         *FLAG_interrupt = 2;
         Set_interrupt_hibernate();
+        Policy_start();
         __bis_SR_register(GIE);        // Set interrupt
         __no_operation();
     }
@@ -264,53 +389,312 @@ void Disable_interrupt_flag (void){
 
 //******************************************************************************************************
 
+#ifdef HIBERNUS_HYBRID
+
+/* Logs the peripheral registers that differ from gpr_data[], the ones of the full image.
+ * Returns 0 if there are more than the delta can hold. */
+static uint8_t Save_GPR_delta(void)
+{
+    uint16_t k, n = 0, v;
+
+    for (k = 0; k < 514; k++) {
+        if (!Gpr_restored(k)) {
+            continue;
+        }
+        v = *(uint16_t *) SIM_ADDR(gpr_locations[k]);
+        SIM_CYCLES(14);     // Host: estimated cost of one compare.
+        if (v != gpr_data[k]) {
+            if (n == HIB_DELTA_GPRS) {
+                return 0;
+            }
+            Delta_slot->gpr[n][0] = k;
+            Delta_slot->gpr[n][1] = v;
+            n++;
+            SIM_CYCLES(10);
+        }
+    }
+    Delta_slot->gprs = n;
+    return 1;
+}
+
+/* Copies the RAM in use, .bss/.data from HIB_RAM_START and the stack down to SP. Returns 0 if
+ * it does not fit in the delta. */
+static uint8_t Save_RAM_delta(void)
+{
+    uint16_t *src, *dst = Delta_slot->data;
+    uint16_t low = (HIB_RAM_USED_END - HIB_RAM_START + 1) / 2;
+    uint16_t stack = HIB_STACK_START & ~1u;
+    uint16_t high = (RAM_END - stack) / 2;
+
+    if (low + high > HIB_DELTA_WORDS) {
+        return 0;
+    }
+    for (src = (uint16_t *) SIM_ADDR(HIB_RAM_START); src < (uint16_t *) SIM_ADDR(HIB_RAM_START) + low; ) {
+        *dst++ = *src++;
+        SIM_CYCLES(8);
+    }
+    for (src = (uint16_t *) SIM_ADDR(stack); src < (uint16_t *) SIM_ADDR(RAM_END); ) {
+        *dst++ = *src++;
+        SIM_CYCLES(8);
+    }
+    Delta_slot->low = low;
+    Delta_slot->stack = stack;
+    Delta_slot->header.size = 2 * (dst - Delta_slot->data);
+    return 1;
+}
+
+/* Restored from a periodic or safe-point checkpoint, PORT4_ISR() is not there to arm the
+ * next one. */
+static void Rearm_hibernate(void)
+{
+    if ((*FLAG_interrupt != 2) && COMPARATOR_ON) {
+        *FLAG_interrupt = 2;
+        Set_interrupt_hibernate();
+    }
+}
+
+void Checkpoint_delta(void)
+{
+    hib_delta_t *last;
+
+    if ((*CC_Check == 1) && Image_valid()) {
+        // Into the other slot, the latest delta stays valid until this one is complete.
+        last = Delta_newest();
+        Delta_slot = (last == &hib_delta[0]) ? &hib_delta[1] : &hib_delta[0];
+        Delta_slot->header.magic = 0;
+        Delta_slot->seq = last ? (uint16_t)(last->seq + 1) : 0;
+
+        Hibernate_delta();
+
+        // A restored delta resumes here (Restore() has pointed Delta_slot at it).
+        if (Delta_slot->header.magic == HIB_DELTA_MAGIC) {
+            HIB_STATS_RESUMED();
+            STATS_RESUMED();
+            pro=0;
+            Rearm_hibernate();
+            return;
+        }
+    }
+    Checkpoint();
+}
+
+/* Leaves Delta_slot->header.magic at 0 if the delta does not fit, Checkpoint_delta() then
+ * takes a full checkpoint instead. */
+#pragma FUNC_CANNOT_INLINE (Hibernate_delta)
+void Hibernate_delta(void){
+
+    SIM_PHASE(SIM_PHASE_CHECKPOINT);
+    HIB_STATS_BEGIN(HIB_PHASE_HIBERNATE);
+    TRACE(TRACE_HIBERNATE, 1);
+
+#ifndef T1_HOST
+    // Save Core registers to FRAM (hib_delta_regs.core[])
+    asm(" MOVA R1,&hib_delta_regs+4");
+    asm(" MOVA R2,&hib_delta_regs+8");
+    asm(" MOVA R3,&hib_delta_regs+12");
+    asm(" MOVA R4,&hib_delta_regs+16");
+    asm(" MOVA R5,&hib_delta_regs+20");
+    asm(" MOVA R6,&hib_delta_regs+24");
+    asm(" MOVA R7,&hib_delta_regs+28");
+    asm(" MOVA R8,&hib_delta_regs+32");
+    asm(" MOVA R9,&hib_delta_regs+36");
+    asm(" MOVA R10,&hib_delta_regs+40");
+    asm(" MOVA R11,&hib_delta_regs+44");
+    asm(" MOVA R12,&hib_delta_regs+48");
+    asm(" MOVA R13,&hib_delta_regs+52");
+    asm(" MOVA R14,&hib_delta_regs+56");
+    asm(" MOVA R15,&hib_delta_regs+60");
+
+    // Saving Program Counter (PC), the return address on top of the stack.
+    asm(" MOVX.A @R1,&hib_delta_regs");
+#endif // T1_HOST
+
+    HIB_STATS_BEGIN(HIB_PHASE_SAVE_GPR);
+    if (!Save_GPR_delta()) {
+        SIM_PHASE(SIM_PHASE_APP);
+        return;
+    }
+    HIB_STATS_END(HIB_PHASE_SAVE_GPR);
+
+    HIB_STATS_BEGIN(HIB_PHASE_SAVE_RAM);
+    if (!Save_RAM_delta()) {
+        SIM_PHASE(SIM_PHASE_APP);
+        return;
+    }
+    SIM_SNAPSHOT(1 + (Delta_slot - hib_delta));
+    HIB_STATS_END(HIB_PHASE_SAVE_RAM);  // The host resumes a delta here, the target on the
+                                        // return.
+    Delta_slot->regs = hib_delta_regs;
+    Delta_slot->header.version = HIB_IMAGE_VERSION;
+    Delta_slot->header.epoch = hib_epoch;
+    Delta_slot->header.magic = HIB_DELTA_MAGIC;
+
+    HIB_STATS_END(HIB_PHASE_HIBERNATE);
+    SIM_PHASE(SIM_PHASE_APP);
+}
+
+/* Lays the full image and then Delta_slot's RAM over all of RAM, the live stack included, so
+ * it keeps its state in FRAM, calls nothing once the copy has started and never returns: the
+ * core registers are loaded last, and it leaves through the delta's return address into
+ * Checkpoint_delta(), as if Hibernate_delta() had just returned. */
+RAMFUNC static void Restore_delta(void)
+{
+    hib_delta_regs = Delta_slot->regs;
+
+    FRAM_write_ptr= hib_image.data;
+    RAM_copy_ptr= (uint32_t *) SIM_ADDR(HIB_RAM_START);
+    while (RAM_copy_ptr < (uint32_t *) SIM_ADDR(RAM_END)) {
+        *RAM_copy_ptr++=*FRAM_write_ptr++;
+        SIM_CYCLES(16);
+    }
+
+    Delta_src = Delta_slot->data;
+    Delta_dst = (uint16_t *) SIM_ADDR(HIB_RAM_START);
+    Delta_end = Delta_dst + Delta_slot->low;
+    while (Delta_dst < Delta_end) {
+        *Delta_dst++ = *Delta_src++;
+        SIM_CYCLES(8);
+    }
+    Delta_dst = (uint16_t *) SIM_ADDR(Delta_slot->stack);
+    Delta_end = (uint16_t *) SIM_ADDR(RAM_END);
+    while (Delta_dst < Delta_end) {
+        *Delta_dst++ = *Delta_src++;
+        SIM_CYCLES(8);
+    }
+
+#ifndef T1_HOST
+    *(uint32_t *)(uint16_t) hib_delta_regs.core[0] = hib_delta_regs.pc;
+
+    // Restore Core Registers (hib_delta_regs.core[]), SP and SR last, then the PC from the stack.
+    asm(" MOVA &hib_delta_regs+16,R4");
+    asm(" MOVA &hib_delta_regs+20,R5");
+    asm(" MOVA &hib_delta_regs+24,R6");
+    asm(" MOVA &hib_delta_regs+28,R7");
+    asm(" MOVA &hib_delta_regs+32,R8");
+    asm(" MOVA &hib_delta_regs+36,R9");
+    asm(" MOVA &hib_delta_regs+40,R10");
+    asm(" MOVA &hib_delta_regs+44,R11");
+    asm(" MOVA &hib_delta_regs+48,R12");
+    asm(" MOVA &hib_delta_regs+52,R13");
+    asm(" MOVA &hib_delta_regs+56,R14");
+    asm(" MOVA &hib_delta_regs+60,R15");
+    asm(" MOVA &hib_delta_regs+4,R1");
+    asm(" MOVA &hib_delta_regs+8,R2");
+    asm(" RETA");
+#else
+    SIM_RESUME(1 + (Delta_slot - hib_delta));   // Host: continues in the snapshot, returns
+                                                // only if there is none.
+#endif // T1_HOST
+}
+
+#endif // HIBERNUS_HYBRID
+
 void Hibernate (void){
 
+#ifdef HIBERNUS_BURST
+    clock_profile_t profile = clock_get_profile();
+
+    clock_set_profile(CLOCK_BURST);
+#endif // HIBERNUS_BURST
+
+#ifdef HIBERNUS_HYBRID
+    Checkpoint_delta();     // Only the delta, with a full image in place.
+#else
+    Checkpoint();
+#endif // HIBERNUS_HYBRID
+
+#ifdef HIBERNUS_BURST
+    clock_set_profile(profile);     // A restore resumes above, this re-applies it too.
+#endif // HIBERNUS_BURST
+}
+
+//******************************************************************************************************
+
+void Checkpoint (void){
+
+    SIM_PHASE(SIM_PHASE_CHECKPOINT);
+    HIB_STATS_BEGIN(HIB_PHASE_HIBERNATE);
+    TRACE(TRACE_HIBERNATE, 0);
+
 	*CC_Check=0;
+    hib_image.header.magic = 0;     // Image incomplete until the header is written back.
+#ifdef HIBERNUS_HYBRID
+    for (i = 0; i < HIB_DELTAS; i++) {
+        hib_delta[i].header.magic = 0;  // Taken against the old image.
+    }
+#endif // HIBERNUS_HYBRID
 
-    // Save Core registers to FRAM
+#ifndef T1_HOST
+    // Save Core registers to FRAM (hib_image.core[])
     // These increment in 4 bytes. The first register R0 is actually the PC.
-	asm(" MOVA R1,&0x600C");
-    asm(" MOVA R2,&0x6010");
-    asm(" MOVA R3,&0x6014");
-    asm(" MOVA R4,&0x6018");
-    asm(" MOVA R5,&0x601C");
-    asm(" MOVA R6,&0x6020");
-    asm(" MOVA R7,&0x6024");
-    asm(" MOVA R8,&0x6028");
-    asm(" MOVA R9,&0x602C");
-    asm(" MOVA R10,&0x6030");
-    asm(" MOVA R11,&0x6034");
-    asm(" MOVA R12,&0x6038");
-    asm(" MOVA R13,&0x603C");
-    asm(" MOVA R14,&0x6040");
-    asm(" MOVA R15,&0x6044");
+	asm(" MOVA R1,&hib_image+20");
+    asm(" MOVA R2,&hib_image+24");
+    asm(" MOVA R3,&hib_image+28");
+    asm(" MOVA R4,&hib_image+32");
+    asm(" MOVA R5,&hib_image+36");
+    asm(" MOVA R6,&hib_image+40");
+    asm(" MOVA R7,&hib_image+44");
+    asm(" MOVA R8,&hib_image+48");
+    asm(" MOVA R9,&hib_image+52");
+    asm(" MOVA R10,&hib_image+56");
+    asm(" MOVA R11,&hib_image+60");
+    asm(" MOVA R12,&hib_image+64");
+    asm(" MOVA R13,&hib_image+68");
+    asm(" MOVA R14,&hib_image+72");
+    asm(" MOVA R15,&hib_image+76");
 
     // Saving Program Counter (PC)
     current_SP = (void*) _get_SP_register();
     *PC_in_FRAM= *current_SP;
+#endif // T1_HOST
 
     // Copy all the RAM and Registers onto the FRAM
+    HIB_STATS_BEGIN(HIB_PHASE_SAVE_RAM);
     Save_RAM();
+    SIM_SNAPSHOT(0);     // Host: the core registers and stack are snapshotted here instead.
+    HIB_STATS_END(HIB_PHASE_SAVE_RAM);  // A restored image resumes here.
+    STATS_RESUMED();
 
     pro=0;
 
+    HIB_STATS_BEGIN(HIB_PHASE_SAVE_GPR);
     Save_GPR();
-
+    HIB_STATS_END(HIB_PHASE_SAVE_GPR);
+
+    hib_image.header.version = HIB_IMAGE_VERSION;
+    hib_image.header.epoch = hib_epoch;
+#ifdef HIBERNUS_COMPRESS
+    hib_image.header.magic = HIB_IMAGE_MAGIC_PACKED;
+#else
+    hib_image.header.size = HIB_RAM_SIZE;
+    hib_image.header.magic = HIB_IMAGE_MAGIC;
+#endif // HIBERNUS_COMPRESS
     *CC_Check = 1;
+
+#ifdef HIBERNUS_HYBRID
+    Rearm_hibernate();
+#endif // HIBERNUS_HYBRID
+
+    HIB_STATS_END(HIB_PHASE_HIBERNATE);
+    SIM_PHASE(SIM_PHASE_APP);
 }
 
 //******************************************************************************************************
 
-void Save_RAM (void){
+RAMFUNC void Save_RAM (void){
 
-	FRAM_write_ptr= (unsigned long int *) SAVING_RAM_LOCATION_START;
-	RAM_copy_ptr= (unsigned long int *) RAM_START;
+#ifdef HIBERNUS_COMPRESS
+    Pack_RAM();     // Sets hib_image.header.size.
+#else
+	FRAM_write_ptr= hib_image.data;
+	RAM_copy_ptr= (uint32_t *) SIM_ADDR(HIB_RAM_START);
 
 	// copy all RAM onto the FRAM
-	while(RAM_copy_ptr < (unsigned long int *) (RAM_END)){
+	while(RAM_copy_ptr < (uint32_t *) SIM_ADDR(RAM_END)){
 	    *FRAM_write_ptr++ = *RAM_copy_ptr++;
+	    SIM_CYCLES(16);     // Host: estimated cost of one iteration (FRAM-resident pointers).
 	}
+#endif // HIBERNUS_COMPRESS
 }
 
 //******************************************************************************************************
@@ -318,8 +702,9 @@ void Save_RAM (void){
 void Save_GPR(void)
 {
     for (i = 0; i < 514; i++) {
-        Reg_copy_ptr = (unsigned int *)gpr_locations[i];
+        Reg_copy_ptr = (uint16_t *) SIM_ADDR(gpr_locations[i]);
         gpr_data[i] = *Reg_copy_ptr;
+        SIM_CYCLES(20);     // Host: estimated cost of one iteration.
     }
 }
 
@@ -327,28 +712,48 @@ void Save_GPR(void)
 
 void Restore (void){
 
+    SIM_PHASE(SIM_PHASE_RESTORE);
+    HIB_STATS_BEGIN(HIB_PHASE_RESTORE);
+    TRACE(TRACE_RESTORE, 0);
+    STATS_RESTORE();
+
+#ifdef HIBERNUS_HYBRID
+    Delta_slot = Delta_newest();
+#endif // HIBERNUS_HYBRID
+
+    HIB_STATS_BEGIN(HIB_PHASE_RESTORE_GPR);
     Restore_GPR();
+    HIB_STATS_END(HIB_PHASE_RESTORE_GPR);
 
-    // Restore Core Registers
-    asm(" MOVA &0x600C,R1");
-    asm(" MOVA &0x6010,R2");
-    asm(" MOVA &0x6014,R3");
-    asm(" MOVA &0x6018,R4");
-    asm(" MOVA &0x601C,R5");
-    asm(" MOVA &0x6020,R6");
-    asm(" MOVA &0x6024,R7");
-    asm(" MOVA &0x6028,R8");
-    asm(" MOVA &0x602C,R9");
-    asm(" MOVA &0x6030,R10");
-    asm(" MOVA &0x6034,R11");
-    asm(" MOVA &0x6038,R12");
-    asm(" MOVA &0x603C,R13");
-    asm(" MOVA &0x6040,R14");
-    asm(" MOVA &0x6044,R15");
+#ifdef HIBERNUS_HYBRID
+    if (Delta_slot) {
+        Restore_delta();    // Does not return on the target.
+    }
+#endif // HIBERNUS_HYBRID
+
+#ifndef T1_HOST
+    // Restore Core Registers (hib_image.core[])
+    asm(" MOVA &hib_image+20,R1");
+    asm(" MOVA &hib_image+24,R2");
+    asm(" MOVA &hib_image+28,R3");
+    asm(" MOVA &hib_image+32,R4");
+    asm(" MOVA &hib_image+36,R5");
+    asm(" MOVA &hib_image+40,R6");
+    asm(" MOVA &hib_image+44,R7");
+    asm(" MOVA &hib_image+48,R8");
+    asm(" MOVA &hib_image+52,R9");
+    asm(" MOVA &hib_image+56,R10");
+    asm(" MOVA &hib_image+60,R11");
+    asm(" MOVA &hib_image+64,R12");
+    asm(" MOVA &hib_image+68,R13");
+    asm(" MOVA &hib_image+72,R14");
+    asm(" MOVA &hib_image+76,R15");
 
     *current_SP = *PC_in_FRAM;
+#endif // T1_HOST
 
     Restore_RAM();
+    SIM_RESUME(0);       // Host: continues in the snapshot, returns only if there is none.
 
     /* If debugging reaches this next line, it will mean the restoration was not successful.
      * In this case all that is required is to set CC_Check to 0 to indicate that it is not
@@ -359,19 +764,26 @@ void Restore (void){
     // Setting interrupt for next hibernation.
     *FLAG_interrupt=2;
     Set_interrupt_hibernate();
+    Policy_start();
 
     *CC_Check=0;
     pro=1;
+    HIB_STATS_RESTORE_FAILED();
+    STATS_RESTORE_FAILED();
+    SIM_RESTART();
 
     __bis_SR_register(GIE);     //inetrrupts enabled
     __no_operation();           // For debug
 
+    SIM_PHASE(SIM_PHASE_APP);
 }
 
 //******************************************************************************************************
 
 void Restore_GPR(void)
 {
+    uint16_t ctl1;
+
     /* Some register addresses MUST BE skipped during restoring, these are:
      * PMM0CTRL0    (0x120)     gpr_loc[3]
      * FRAMCTRL0    (0x140)     gpr_loc[6]
@@ -388,6 +800,14 @@ void Restore_GPR(void)
      * P3DIR        (0x224)     gpr_loc[55]
      *
      * P3 is dedicated to Zeta+ pins, these must not be altered so that zeta+ doesn't get triggered.
+     *
+     * CSCTL1       (0x162)     gpr_loc[16]
+     *
+     * The DCO is put back with clock_set_profile(), which lets it settle with MCLK divided,
+     * instead of writing CSCTL1 under the running clock. It also sets the FRAM wait state.
+     *
+     * With HIBERNUS_STATS, Timer_A1 (0x380-0x3ae, gpr_loc[136]-[145]) is skipped as well, it is
+     * timing this restore.
      */
 
     // Unlock registers.
@@ -398,60 +818,104 @@ void Restore_GPR(void)
 
     // Restore registers.
     for (i = 0; i < 3; i++) {
-        Reg_copy_ptr = (unsigned int *)gpr_locations[i];
+        Reg_copy_ptr = (uint16_t *) SIM_ADDR(gpr_locations[i]);
         *Reg_copy_ptr = gpr_data[i];
+        SIM_CYCLES(20);
     }
 
     for (i = 4; i < 6; i++) {
-        Reg_copy_ptr = (unsigned int *)gpr_locations[i];
+        Reg_copy_ptr = (uint16_t *) SIM_ADDR(gpr_locations[i]);
         *Reg_copy_ptr = gpr_data[i];
+        SIM_CYCLES(20);
     }
 
     for (i = 7; i < 14; i++) {
-        Reg_copy_ptr = (unsigned int *)gpr_locations[i];
+        Reg_copy_ptr = (uint16_t *) SIM_ADDR(gpr_locations[i]);
         *Reg_copy_ptr = gpr_data[i];
+        SIM_CYCLES(20);
     }
 
-    for (i = 16; i < 54; i++) {
-        Reg_copy_ptr = (unsigned int *)gpr_locations[i];
+    for (i = 17; i < 54; i++) {
+        Reg_copy_ptr = (uint16_t *) SIM_ADDR(gpr_locations[i]);
         *Reg_copy_ptr = gpr_data[i];
+        SIM_CYCLES(20);
     }
 
+#ifdef HIBERNUS_STATS
+    for (i = 56; i < 136; i++) {
+        Reg_copy_ptr = (uint16_t *) SIM_ADDR(gpr_locations[i]);
+        *Reg_copy_ptr = gpr_data[i];
+        SIM_CYCLES(20);
+    }
+
+    for (i = 146; i < 270; i++) {
+        Reg_copy_ptr = (uint16_t *) SIM_ADDR(gpr_locations[i]);
+        *Reg_copy_ptr = gpr_data[i];
+        SIM_CYCLES(20);
+    }
+#else
     for (i = 56; i < 270; i++) {
-        Reg_copy_ptr = (unsigned int *)gpr_locations[i];
+        Reg_copy_ptr = (uint16_t *) SIM_ADDR(gpr_locations[i]);
         *Reg_copy_ptr = gpr_data[i];
+        SIM_CYCLES(20);
     }
+#endif // HIBERNUS_STATS
 
     for (i = 271; i < 514; i++) {
-        Reg_copy_ptr = (unsigned int *)gpr_locations[i];
+        Reg_copy_ptr = (uint16_t *) SIM_ADDR(gpr_locations[i]);
         *Reg_copy_ptr = gpr_data[i];
+        SIM_CYCLES(20);
     }
 
+    ctl1 = gpr_data[16];
+#ifdef HIBERNUS_HYBRID
+    // Registers that changed after the full image, from the delta.
+    if (Delta_slot) {
+        for (i = 0; i < Delta_slot->gprs; i++) {
+            if (Delta_slot->gpr[i][0] == 16) {
+                ctl1 = Delta_slot->gpr[i][1];
+            }
+            else if (Delta_slot->gpr[i][0] < 514) {
+                Reg_copy_ptr = (uint16_t *) SIM_ADDR(gpr_locations[Delta_slot->gpr[i][0]]);
+                *Reg_copy_ptr = Delta_slot->gpr[i][1];
+            }
+            SIM_CYCLES(24);
+        }
+    }
+#endif // HIBERNUS_HYBRID
+
     // Lock registers.
     MPUCTL0_H = 0x01;
     PMMCTL0_H = 0x01;
     FRCTL0_H = 0x01;
     CSCTL0_H = 0x01;
+
+    clock_set_profile(clock_profile_of(ctl1));
 }
 
 //******************************************************************************************************
 
-void Restore_RAM (void){
+RAMFUNC void Restore_RAM (void){
 
-    FRAM_write_ptr= (unsigned long int *) SAVING_RAM_LOCATION_START;
-    RAM_copy_ptr= (unsigned long int *) RAM_START;
+#ifdef HIBERNUS_COMPRESS
+    Unpack_RAM();
+#else
+    FRAM_write_ptr= hib_image.data;
+    RAM_copy_ptr= (uint32_t *) SIM_ADDR(HIB_RAM_START);
 
     //Copy RAM values in FRAM back into RAM.
-     while(RAM_copy_ptr < (unsigned long int *) (RAM_END)) {
+     while(RAM_copy_ptr < (uint32_t *) SIM_ADDR(RAM_END)) {
 
          *RAM_copy_ptr++=*FRAM_write_ptr++;
+         SIM_CYCLES(16);
      }
+#endif // HIBERNUS_COMPRESS
 }
 
 //******************************************************************************************************
 
 #pragma vector=PORT4_VECTOR
-__interrupt void PORT4_ISR(void)
+RAMFUNC __interrupt void PORT4_ISR(void)
 {
     switch (__even_in_range(P4IV, P4IV_P4IFG1)) {
     case P4IV_P4IFG1:
@@ -480,15 +944,9 @@ __interrupt void PORT4_ISR(void)
                     *FLAG_interrupt = 2;
                     Set_interrupt_hibernate();
                     /* There's a chance the interrupt was stuck on the active operation
-                     * loop. Must initialise the counting of the timer again to prevent
-                     * being stuck forever in the loop. */
-
-                    // Stop timerB.
-                    TB0CTL = MC_0; // Stop counting.
-                    TB0R = 0;      // Reset counter.
-                    __bic_SR_register(GIE);
-
-                    timerB_start();
+                     * loop. Set the software timers' compare up again from the restored
+                     * table to prevent being stuck forever in the loop. */
+                    timer_resync();
                     __bis_SR_register(GIE);             // Set interrupt
                     __no_operation();
                 }
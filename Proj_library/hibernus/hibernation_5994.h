@@ -25,21 +25,134 @@ Date modified by P. Krawiec: 07/04/2023.
 
 //**************************************************************************************************************
 #include <msp430.h>
+#include <stdint.h>
 #include <Proj_library/h_files/t1_util.h>
-//Interrupt and Restoring
-// In lnk_msp430fr5994, FRAM starts at 0x4000 & ends at 0xFF80, FRAM2 starts at 0x10000 & ends at 0x40000.
-// First available address to safely write data to FRAM is at 0x4150.
-#define INT 0x6000
-#define CHECK 0x6004
 
-//Program Counter (PC)
-#define PROGRAM_COUNTER 0x6008
-
-//RAM to FRAM saving location
-#define SAVING_RAM_LOCATION_START 0x6050    // First address to save RAM to after saving SP + MCU core.
+/* Checkpoint image. Lives in its own NOINIT section, .hibernus, which lnk_msp430fr5994.cmd
+ * places in the HIBERNUS region so nothing else can be linked over it. The header is checked
+ * before anything else is read: an image is only restored if its magic, version and size match
+ * this build and its epoch matches hib_epoch, which is re-initialised by every reflash. */
+#define HIB_IMAGE_MAGIC     0x4849  ///< 'HI', marks a complete image.
+#define HIB_IMAGE_MAGIC_PACKED 0x485A   ///< 'HZ', complete image with packed RAM.
+#define HIB_IMAGE_VERSION   1u      ///< Bumped whenever hib_image_t changes layout.
 
 //Location of RAM
-#define RAM_END 0x2C00  // In lnk_msp430fr5994.cmd, RAM_START = 0x1C00, RAM_LENGTH = 0x1000, so RAM_END = 0x2C00.
+#define RAM_SIZE 0x1000 // In lnk_msp430fr5994.cmd, RAM_START = 0x1C00, RAM_LENGTH = 0x1000.
+#define RAM_END (RAM_START + RAM_SIZE)
+
+/* RAM in the image, from HIB_RAM_START to RAM_END. With T1_RAMFUNC the RAMFUNC code sits below
+ * HIB_RAM_START: the boot code copies it there before Hibernus runs, so it is neither saved
+ * nor overwritten by a restore (Restore_RAM() may be running from it). */
+#if defined(T1_RAMFUNC) && !defined(T1_HOST)
+extern char hib_ramfunc_end;    ///< End of .TI.ramfunc, see lnk_msp430fr5994.cmd.
+#define HIB_RAM_START   ((uint16_t) &hib_ramfunc_end)
+#elif defined(T1_RAMFUNC)
+#define HIB_RAM_START   (RAM_START + SIM_RAMFUNC_USED)
+#else
+#define HIB_RAM_START   RAM_START
+#endif
+#define HIB_RAM_SIZE    (RAM_END - HIB_RAM_START)
+
+/* RAM image compression. The RAM is packed into runs of 32-bit words: a run header holds the
+ * run length, with HIB_PACK_ZEROS set for a run of zero words (nothing else stored) or clear
+ * for literal words that follow it. Zero runs shorter than 2 words are stored as literals,
+ * so the packed image is at most one word larger than RAM. Costs cycles on every word that
+ * is not zero, time it with HIBERNUS_STATS (Save_RAM) before enabling it for an application,
+ * host/hib_pack_bench estimates it for a dump of RAM. */
+//#define HIBERNUS_COMPRESS  ///< "Uncomment" to pack the RAM image.
+
+#define HIB_PACK_ZEROS  0x80000000UL    ///< Run header: run of zero words.
+#define HIB_PACK_WORDS  (RAM_SIZE / 4 + 1)  ///< Worst-case packed size in words.
+
+typedef struct {
+    uint16_t magic;         ///< HIB_IMAGE_MAGIC once the image is complete.
+    uint16_t version;       ///< HIB_IMAGE_VERSION.
+    uint16_t size;          ///< Bytes of RAM image in data[].
+    uint16_t epoch;         ///< hib_epoch of the firmware that wrote it.
+} hib_header_t;
+
+typedef struct {
+    hib_header_t header;
+    uint32_t flag_interrupt;    ///< Which edge the comparator interrupt is set up for.
+    uint32_t cc_check;          ///< 1 when the image is complete, 0 while it is written.
+    uint32_t pc;                ///< Program Counter (PC).
+    uint32_t core[15];          ///< R1-R15, saved with MOVA (20-bit).
+    uint32_t data[HIB_PACK_WORDS];  ///< RAM, raw or packed.
+} hib_image_t;
+
+extern hib_image_t hib_image;
+extern uint16_t hib_epoch;
+
+/* Hybrid checkpointing. On top of the just-in-time checkpoint on the comparator's falling
+ * edge, incremental checkpoints are taken while the supply is good: every period (Timer_A2),
+ * at application safe points (Hibernus_safe_point()), or at the first safe point after each
+ * period when both are enabled. Each one, the just-in-time one included, only saves a delta
+ * on top of the full image: the RAM in use (.bss/.data and the stack) and the peripheral
+ * registers that changed, into the older of the two hib_delta slots. A delta cut short by the
+ * supply leaves the other slot valid, so only the work since the last checkpoint is lost,
+ * not everything since boot. The full image is only taken when there is none yet or a delta
+ * does not fit, and is not protected in the same way. The delta is laid over the raw RAM
+ * image when restoring, so it does not combine with HIBERNUS_COMPRESS. */
+//#define HIBERNUS_HYBRID  ///< "Uncomment" to add periodic/safe-point checkpoints and deltas.
+
+#define HIB_TRIGGER_JIT         0x01    ///< Comparator falling edge, always on.
+#define HIB_TRIGGER_PERIODIC    0x02    ///< Timer_A2, every hib_policy.period_s.
+#define HIB_TRIGGER_SAFE_POINT  0x04    ///< Hibernus_safe_point().
+
+#define HIB_POLICY_TRIGGERS (HIB_TRIGGER_JIT + HIB_TRIGGER_PERIODIC + HIB_TRIGGER_SAFE_POINT)
+#define HIB_POLICY_PERIOD_S 10u     ///< Default period, at most 445s at the nominal VLO.
+#define HIB_POLICY_TICK_HZ  147u    ///< Nominal Timer_A2 tick: VLO (~9.4kHz) / 64.
+
+#define HIB_DELTA_MAGIC     0x4844  ///< 'HD', marks a complete delta.
+#define HIB_DELTAS          2u      ///< Delta slots, written in turn.
+#define HIB_DELTA_WORDS     512u    ///< RAM a delta can hold, in 16-bit words.
+#define HIB_DELTA_GPRS      128u    ///< Changed peripheral registers a delta can hold.
+
+/* Checkpoints at the 16MHz CLOCK_BURST profile (clock_set_profile()), switching back to the
+ * application's profile afterwards. A full checkpoint takes about 40% less time than at
+ * 8MHz for about 20% more energy (the FRAM wait state), as modelled by 'make bench' in host/,
+ * not measured on a board. Worth it where the supply falls quickly after the comparator
+ * trips. */
+//#define HIBERNUS_BURST  ///< "Uncomment" to checkpoint at CLOCK_BURST.
+
+#if defined(HIBERNUS_HYBRID) && defined(HIBERNUS_COMPRESS)
+#error "HIBERNUS_HYBRID needs the raw RAM image, disable HIBERNUS_COMPRESS"
+#endif
+
+typedef struct {
+    uint8_t triggers;       ///< HIB_TRIGGER_* in use.
+    uint16_t period_s;      ///< Period of HIB_TRIGGER_PERIODIC.
+} hib_policy_t;
+
+typedef struct {
+    uint32_t pc;                ///< Program Counter (PC), the return address at R1.
+    uint32_t core[15];          ///< R1-R15, saved with MOVA (20-bit).
+} hib_regs_t;
+
+typedef struct {
+    hib_header_t header;        ///< HIB_DELTA_MAGIC, size = bytes of RAM in data[].
+    uint16_t seq;               ///< One more than the other slot's when it was taken.
+    hib_regs_t regs;            ///< Core registers, from hib_delta_regs.
+    uint16_t low;               ///< Words saved from HIB_RAM_START, the rest is stack.
+    uint16_t stack;             ///< Address of the first saved stack word.
+    uint16_t gprs;              ///< Entries used in gpr[].
+    uint16_t gpr[HIB_DELTA_GPRS][2];    ///< {gpr_locations index, value}.
+    uint16_t data[HIB_DELTA_WORDS];     ///< RAM, from HIB_RAM_START and from the stack.
+} hib_delta_t;
+
+extern hib_delta_t hib_delta[HIB_DELTAS];
+extern hib_regs_t hib_delta_regs;
+extern hib_policy_t hib_policy;
+
+/* RAM in use. The host build has no RAM of its own in sim_mem, it uses estimates. */
+#ifndef T1_HOST
+extern char hib_ram_used_end;   ///< End of .bss/.data/.TI.noinit, see lnk_msp430fr5994.cmd.
+#define HIB_RAM_USED_END    ((uint16_t) &hib_ram_used_end)
+#define HIB_STACK_START     ((uint16_t) _get_SP_register())
+#else
+#define HIB_RAM_USED_END    (HIB_RAM_START + SIM_RAM_USED)
+#define HIB_STACK_START     (RAM_END - SIM_STACK_USED)
+#endif // T1_HOST
 
 // there is also LEA_RAM, but LEAN is not used or concerned in this project.
 
@@ -55,4 +168,48 @@ void Save_GPR(void);
 void Restore (void);
 void Restore_GPR(void);
 void Restore_RAM (void);
+uint16_t Pack_RAM (void);   ///< Also sets hib_image.header.size to the bytes it returns.
+void Unpack_RAM (void);
+void Checkpoint (void);
+
+#ifdef HIBERNUS_HYBRID
+
+/**
+ * @brief Set the checkpoint policy. Kept in FRAM, the defaults apply until it is called.
+ *
+ * @param triggers : HIB_TRIGGER_* to use, HIB_TRIGGER_JIT is always on.
+ * @param period_s : Period of HIB_TRIGGER_PERIODIC [s], 1-445.
+ */
+void Hibernus_policy(uint8_t triggers, uint16_t period_s);
+
+/**
+ * @brief Application safe point, takes an incremental checkpoint if the policy says one is
+ * due.
+ */
+void Hibernus_safe_point(void);
+
+/**
+ * @brief Incremental checkpoint: a delta on top of the full image, or the full image
+ * (Checkpoint()) if there is none yet or the delta does not fit.
+ */
+void Checkpoint_delta(void);
+
+/**
+ * @brief Saves the core registers and a delta into Delta_slot, called by Checkpoint_delta().
+ *
+ * A restored delta resumes on its return, with the registers and the stack it was called
+ * with. Like Checkpoint(), it must not be inlined nor have a stack frame: the PC is read
+ * from the top of the stack next to the register saves.
+ */
+void Hibernate_delta(void);
+
+void Policy_start(void);
+
+#else
+
+#define Hibernus_policy(triggers, period_s)
+#define Hibernus_safe_point()
+#define Policy_start()
+
+#endif // HIBERNUS_HYBRID
 
@@ -0,0 +1,85 @@
+/*
+RAM image compression for Hibernus on the MSP430FR5994, by P. Krawiec.
+
+See HIBERNUS_COMPRESS in hibernation_5994.h for the format. Unpack_RAM() overwrites the stack
+it runs on, so like Restore_RAM() it keeps all of its state in FRAM.
+*/
+
+//******************************************************************************************************
+#include <Proj_library/hibernus/hibernation_5994.h>
+
+#pragma SET_DATA_SECTION(".fram_vars")
+
+uint32_t *Pack_ptr SIM_FRAM;    // Position in hib_image.data
+uint32_t *Word_ptr SIM_FRAM;    // Position in RAM
+uint32_t *Run_ptr SIM_FRAM;     // Header of the run being packed
+uint16_t Run_len SIM_FRAM;
+
+#pragma SET_DATA_SECTION()
+
+// A zero run starts at p: two zero words, the last word of RAM is never a run on its own.
+#define ZERO_RUN(p) (((p) + 1 < (uint32_t *) SIM_ADDR(RAM_END)) && !(p)[0] && !(p)[1])
+
+//******************************************************************************************************
+
+uint16_t Pack_RAM (void)
+{
+    Pack_ptr = hib_image.data;
+    Word_ptr = (uint32_t *) SIM_ADDR(HIB_RAM_START);
+
+    while (Word_ptr < (uint32_t *) SIM_ADDR(RAM_END)) {
+        Run_ptr = Pack_ptr++;
+        Run_len = 0;
+
+        if (ZERO_RUN(Word_ptr)) {
+            while ((Word_ptr < (uint32_t *) SIM_ADDR(RAM_END)) && !*Word_ptr) {
+                Word_ptr++;
+                Run_len++;
+                SIM_CYCLES(12);     // Host: estimated cost of one zero word.
+            }
+            *Run_ptr = HIB_PACK_ZEROS | Run_len;
+        }
+        else {
+            while ((Word_ptr < (uint32_t *) SIM_ADDR(RAM_END)) && !ZERO_RUN(Word_ptr)) {
+                *Pack_ptr++ = *Word_ptr++;
+                Run_len++;
+                SIM_CYCLES(24);     // Host: estimated cost of one literal word.
+            }
+            *Run_ptr = Run_len;
+        }
+        SIM_CYCLES(16);             // Host: estimated cost of one run header.
+    }
+
+    /* Set here, not by the caller: a restored image resumes on Pack_RAM()'s return, with the
+     * return value register as it was before the call. */
+    hib_image.header.size = (uint16_t)((Pack_ptr - hib_image.data) * 4);
+    return hib_image.header.size;
+}
+
+//******************************************************************************************************
+
+void Unpack_RAM (void)
+{
+    Pack_ptr = hib_image.data;
+    Word_ptr = (uint32_t *) SIM_ADDR(HIB_RAM_START);
+
+    // Bounded by RAM as well as by the image, a bad run length cannot write past RAM_END.
+    while ((Word_ptr < (uint32_t *) SIM_ADDR(RAM_END))
+            && (Pack_ptr < hib_image.data + HIB_PACK_WORDS)) {
+        Run_len = (uint16_t) *Pack_ptr;
+
+        if (*Pack_ptr++ & HIB_PACK_ZEROS) {
+            while (Run_len-- && (Word_ptr < (uint32_t *) SIM_ADDR(RAM_END))) {
+                *Word_ptr++ = 0;
+                SIM_CYCLES(10);
+            }
+        }
+        else {
+            while (Run_len-- && (Word_ptr < (uint32_t *) SIM_ADDR(RAM_END))) {
+                *Word_ptr++ = *Pack_ptr++;
+                SIM_CYCLES(16);
+            }
+        }
+        SIM_CYCLES(16);
+    }
+}
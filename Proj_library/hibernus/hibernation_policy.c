@@ -0,0 +1,81 @@
+/*
+Hybrid checkpoint policy for Hibernus on the MSP430FR5994, by P. Krawiec.
+
+Decides when an incremental checkpoint (Checkpoint_delta()) is taken besides the just-in-time
+one, see HIBERNUS_HYBRID in hibernation_5994.h. The period is kept by Timer_A2 from ACLK/64 in
+up mode, its CCR0 interrupt either takes the checkpoint or, with safe points enabled, marks
+one as due.
+*/
+
+//******************************************************************************************************
+#include <Proj_library/hibernus/hibernation_5994.h>
+
+#ifdef HIBERNUS_HYBRID
+
+// Only initialised when flashing.
+#pragma PERSISTENT (hib_policy)
+hib_policy_t hib_policy SIM_FRAM = {HIB_POLICY_TRIGGERS, HIB_POLICY_PERIOD_S};
+
+// Set by the timer when a checkpoint is waiting for the next safe point.
+static volatile uint8_t due;
+
+//******************************************************************************************************
+
+void Policy_start(void)
+{
+    TA2CTL = MC_0;
+    due = 0;
+    if (!(hib_policy.triggers & HIB_TRIGGER_PERIODIC)) {
+        return;
+    }
+    TA2EX0 = TAIDEX_7;                                  // /8
+    TA2CCR0 = ((uint32_t) hib_policy.period_s * vlo_cal.hz > 0xFFFFul * 64)
+            ? 0xFFFF : (uint16_t)((uint32_t) hib_policy.period_s * vlo_cal.hz / 64);
+    TA2CCTL0 = CCIE;
+    TA2CTL = TASSEL__ACLK + ID__8 + MC__UP + TACLR;     // /8, ACLK/64 in all.
+}
+
+void Hibernus_policy(uint8_t triggers, uint16_t period_s)
+{
+    if ((period_s == 0) || (period_s > 0xFFFF / HIB_POLICY_TICK_HZ)) {
+        period_s = HIB_POLICY_PERIOD_S;
+    }
+    hib_policy.triggers = triggers | HIB_TRIGGER_JIT;
+    hib_policy.period_s = period_s;
+    Policy_start();
+}
+
+void Hibernus_safe_point(void)
+{
+    if (!(hib_policy.triggers & HIB_TRIGGER_SAFE_POINT)) {
+        return;
+    }
+    if ((hib_policy.triggers & HIB_TRIGGER_PERIODIC) && !due) {
+        return;
+    }
+    if (COMPARATOR_ON) {
+        __bic_SR_register(GIE);
+        due = 0;
+        Checkpoint_delta();
+        __bis_SR_register(GIE);
+    }
+}
+
+//******************************************************************************************************
+
+#pragma vector=TIMER2_A0_VECTOR
+RAMFUNC __interrupt void TIMER2_A0_ISR(void)
+{
+    // Only while the supply is good, a full checkpoint cut short loses the image.
+    if (!COMPARATOR_ON) {
+        return;
+    }
+    if (hib_policy.triggers & HIB_TRIGGER_SAFE_POINT) {
+        due = 1;
+    }
+    else {
+        Checkpoint_delta();
+    }
+}
+
+#endif // HIBERNUS_HYBRID
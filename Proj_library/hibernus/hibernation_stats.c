@@ -0,0 +1,126 @@
+/*
+Hibernus instrumentation for the MSP430FR5994, by P. Krawiec.
+
+See hibernation_stats.h for how the block is laid out and read back.
+*/
+
+//******************************************************************************************************
+#include <Proj_library/hibernus/hibernation_stats.h>
+
+#ifdef HIBERNUS_STATS
+
+// Only initialised when flashing.
+#pragma PERSISTENT (hib_stats)
+hib_stats_t hib_stats SIM_FRAM = {HIB_STATS_MAGIC, HIB_STATS_VERSION, HIB_STATS_TICK_KHZ};
+
+// Time stamps of the inner phases. Kept in RAM, none of them spans a restore.
+static uint16_t phase_start[HIB_PHASES];
+
+// Set once a restored image has resumed, until the next hibernate.
+static uint8_t resumed;
+
+//******************************************************************************************************
+
+static void record(hib_phase_t phase, uint16_t ticks)
+{
+    uint8_t bin = 0;
+    uint16_t t = ticks;
+
+    while (t >>= 1) {
+        bin++;
+    }
+
+    hib_stats.last[phase] = ticks;
+    if (ticks > hib_stats.max[phase]) {
+        hib_stats.max[phase] = ticks;
+    }
+    if (hib_stats.hist[phase][bin] != 0xFFFF) {
+        hib_stats.hist[phase][bin]++;
+    }
+}
+
+//******************************************************************************************************
+
+void hib_stats_begin(hib_phase_t phase)
+{
+    if ((phase == HIB_PHASE_HIBERNATE) || (phase == HIB_PHASE_RESTORE)) {
+        // SMCLK, continuous mode, clear. Restore_GPR() leaves Timer_A1 alone while this
+        // is built in, so the count carries across the restore.
+        TA1CTL = TASSEL__SMCLK + MC__CONTINUOUS + TACLR;
+        resumed = 0;
+        hib_stats.restoring = (phase == HIB_PHASE_RESTORE);
+    }
+    phase_start[phase] = TA1R;
+}
+
+void hib_stats_end(hib_phase_t phase)
+{
+    uint16_t ticks = TA1R - phase_start[phase];
+
+    if (hib_stats.restoring && (phase == HIB_PHASE_SAVE_RAM)) {
+        /* Only a restored image ends Save_RAM() with restoring still set: Restore_RAM()
+         * returned into the snapshot. The timer was cleared on entry to Restore(), so it
+         * now holds the whole restore latency. */
+        hib_stats.restoring = 0;
+        hib_stats.restores++;
+        resumed = 1;
+        phase = HIB_PHASE_RESTORE;
+        ticks = TA1R;
+    }
+    else if (resumed) {
+        return;     // Rest of the resumed Hibernate(), not a checkpoint.
+    }
+
+    if (TA1CTL & TAIFG) {
+        ticks = 0xFFFF; // Counter wrapped, clamp.
+    }
+    record(phase, ticks);
+
+    if ((phase == HIB_PHASE_HIBERNATE) || (phase == HIB_PHASE_RESTORE)) {
+        if (phase == HIB_PHASE_HIBERNATE) {
+            hib_stats.hibernations++;
+        }
+        TA1CTL = MC_0;  // Stop counting.
+    }
+}
+
+void hib_stats_resumed(void)
+{
+    if (hib_stats.restoring) {
+        hib_stats_end(HIB_PHASE_SAVE_RAM);  // Recorded as the restore, see above.
+    }
+}
+
+//******************************************************************************************************
+
+void hib_stats_boot(void)
+{
+    hib_stats.boots++;
+}
+
+void hib_stats_invalid_image(void)
+{
+    hib_stats.invalid_images++;
+}
+
+void hib_stats_restore_failed(void)
+{
+    hib_stats.restoring = 0;
+    hib_stats.restore_failures++;
+    TA1CTL = MC_0;  // Stop counting.
+}
+
+void hib_stats_clear(void)
+{
+    uint16_t *p = (uint16_t *) &hib_stats;
+    uint16_t n;
+
+    for (n = 0; n < sizeof(hib_stats) / sizeof(uint16_t); n++) {
+        p[n] = 0;
+    }
+    hib_stats.magic = HIB_STATS_MAGIC;
+    hib_stats.version = HIB_STATS_VERSION;
+    hib_stats.tick_khz = HIB_STATS_TICK_KHZ;
+}
+
+#endif // HIBERNUS_STATS
@@ -0,0 +1,138 @@
+/*
+Hibernus instrumentation for the MSP430FR5994, by P. Krawiec.
+
+Times every phase of Hibernate() and Restore() with Timer_A1 and keeps success/failure
+counters and latency histograms in a FRAM-resident block (hib_stats). The block survives
+power loss and soft resets, so a node can be left in the field and read back later:
+
+    1. In CCS, open Memory Browser at &hib_stats and save sizeof(hib_stats_t) bytes
+       as raw binary (little-endian).
+    2. On the host: host/hib_stats_decode <dump.bin>
+
+Timer_A1 runs from SMCLK in continuous mode, so one tick is 1us with the 1MHz SMCLK set
+by clock_init(). A phase longer than 65535 ticks is clamped to 0xFFFF.
+
+Histogram bin k counts latencies of [2^k, 2^(k+1)) ticks (bin 0 also holds 0 ticks).
+
+Define HIBERNUS_STATS to build the instrumentation in. Without it every hook compiles away
+and Timer_A1 is left to the application.
+*/
+
+#ifndef HIBERNATION_STATS_H
+#define HIBERNATION_STATS_H
+
+#include <stdint.h>
+#include <msp430.h>
+#include <Proj_library/h_files/t1_util.h>
+
+//#define HIBERNUS_STATS  ///< "Uncomment" to time and count Hibernate()/Restore().
+
+#define HIB_STATS_MAGIC     0x4853  ///< 'HS', marks an initialised block.
+#define HIB_STATS_VERSION   1u      ///< Bumped whenever hib_stats_t changes layout.
+#define HIB_STATS_BINS      16u     ///< log2 histogram bins, enough for 16-bit ticks.
+#define HIB_STATS_TICK_KHZ  1000u   ///< Timer_A1 tick rate (SMCLK @ 1MHz).
+
+/**
+ * @brief Phases timed by the instrumentation.
+ */
+typedef enum {
+    HIB_PHASE_HIBERNATE = 0,    ///< Whole of Hibernate().
+    HIB_PHASE_SAVE_RAM,         ///< Save_RAM().
+    HIB_PHASE_SAVE_GPR,         ///< Save_GPR().
+    HIB_PHASE_RESTORE,          ///< Restore() entry until execution resumes in the image.
+    HIB_PHASE_RESTORE_GPR,      ///< Restore_GPR().
+    HIB_PHASES
+} hib_phase_t;
+
+/**
+ * @brief FRAM-resident statistics block.
+ *
+ * @note Layout is decoded field by field by host/hib_stats_decode.c, keep both in step
+ * and bump HIB_STATS_VERSION on any change.
+ */
+typedef struct {
+    uint16_t magic;                 ///< HIB_STATS_MAGIC.
+    uint16_t version;               ///< HIB_STATS_VERSION.
+    uint16_t tick_khz;              ///< Tick rate of the latencies below.
+    uint16_t restoring;             ///< Set while a Restore() is in flight.
+    uint32_t boots;                 ///< Calls to Hibernus().
+    uint32_t hibernations;          ///< Completed Hibernate() calls.
+    uint32_t restores;              ///< Restores that resumed the saved image.
+    uint32_t restore_failures;      ///< Restore() fell through (pro = 1).
+    uint32_t invalid_images;        ///< Booted with *CC_Check == 0 (interrupted hibernate).
+    uint16_t last[HIB_PHASES];      ///< Latest latency of each phase.
+    uint16_t max[HIB_PHASES];       ///< Worst latency of each phase.
+    uint16_t hist[HIB_PHASES][HIB_STATS_BINS]; ///< Saturating log2 histograms.
+} hib_stats_t;
+
+extern hib_stats_t hib_stats;
+
+#ifdef HIBERNUS_STATS
+
+/**
+ * @brief Start timing a phase.
+ *
+ * HIB_PHASE_HIBERNATE and HIB_PHASE_RESTORE restart Timer_A1 from zero, the inner
+ * phases take a time stamp from it.
+ *
+ * @param[in] phase : Phase being started.
+ */
+void hib_stats_begin(hib_phase_t phase);
+
+/**
+ * @brief Stop timing a phase and record its latency.
+ *
+ * The first hook reached after a successful restore is the end of Save_RAM() inside the
+ * restored image. That call records HIB_PHASE_RESTORE instead, and the remaining hooks of
+ * the resumed Hibernate() are ignored.
+ *
+ * @param[in] phase : Phase being stopped.
+ */
+void hib_stats_end(hib_phase_t phase);
+
+/**
+ * @brief Record the restore latency where a restore resumes past the end of Save_RAM(): a
+ * HIBERNUS_HYBRID delta, which the target resumes on Hibernate_delta()'s return. Does
+ * nothing unless a restore is in flight.
+ */
+void hib_stats_resumed(void);
+
+/**
+ * @brief Count a boot (called on every entry to Hibernus()).
+ */
+void hib_stats_boot(void);
+
+/**
+ * @brief Count a boot that found an interrupted hibernate (*CC_Check == 0).
+ */
+void hib_stats_invalid_image(void);
+
+/**
+ * @brief Count a Restore() that fell through without resuming the image (pro = 1).
+ */
+void hib_stats_restore_failed(void);
+
+/**
+ * @brief Zero the counters and histograms.
+ */
+void hib_stats_clear(void);
+
+#define HIB_STATS_BEGIN(phase)      hib_stats_begin(phase)
+#define HIB_STATS_END(phase)        hib_stats_end(phase)
+#define HIB_STATS_RESUMED()         hib_stats_resumed()
+#define HIB_STATS_BOOT()            hib_stats_boot()
+#define HIB_STATS_INVALID_IMAGE()   hib_stats_invalid_image()
+#define HIB_STATS_RESTORE_FAILED()  hib_stats_restore_failed()
+
+#else
+
+#define HIB_STATS_BEGIN(phase)
+#define HIB_STATS_END(phase)
+#define HIB_STATS_RESUMED()
+#define HIB_STATS_BOOT()
+#define HIB_STATS_INVALID_IMAGE()
+#define HIB_STATS_RESTORE_FAILED()
+
+#endif // HIBERNUS_STATS
+
+#endif // HIBERNATION_STATS_H
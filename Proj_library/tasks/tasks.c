@@ -0,0 +1,90 @@
+/*
+Task-based intermittent execution for the MSP430FR5994, by P. Krawiec.
+
+See tasks.h for the execution model.
+*/
+
+//******************************************************************************************************
+#include <Proj_library/tasks/tasks.h>
+
+// Only initialised when flashing.
+#pragma PERSISTENT (task_state)
+task_state_t task_state SIM_FRAM = {0};
+
+uint8_t task_vars[TASK_VARS_SIZE];
+
+static uint8_t next_task;
+static uint8_t moved;
+
+//******************************************************************************************************
+
+static void copy(uint8_t *dst, const uint8_t *src, uint8_t size)
+{
+    while (size--) {
+        *dst++ = *src++;
+        SIM_CYCLES(6);
+    }
+}
+
+static void reset_state(void)
+{
+    uint8_t k;
+
+    for (k = 0; k < TASK_VARS_SIZE; k++) {
+        task_state.vars[0][k] = 0;
+    }
+    task_state.commit = 0;
+    task_state.magic = TASK_MAGIC;
+    SIM_RESTART();
+}
+
+//******************************************************************************************************
+
+void task_next(uint8_t task)
+{
+    next_task = task;
+    moved = 1;
+}
+
+void task_run(const task_t *tasks, uint8_t count, uint8_t size)
+{
+    uint8_t task, copy_idx;
+
+    if (size > TASK_VARS_SIZE) {
+        size = TASK_VARS_SIZE;
+    }
+
+    if ((task_state.magic != TASK_MAGIC) || ((task_state.commit >> 1) >= count)) {
+        reset_state();
+    }
+    else {
+        SIM_ROLLBACK();
+    }
+
+    for (;;) {
+        task = task_state.commit >> 1;
+        copy_idx = task_state.commit & 1;
+
+        // Privatise the committed state for this run of the task.
+        SIM_PHASE(SIM_PHASE_RESTORE);
+        copy(task_vars, task_state.vars[copy_idx], size);
+        SIM_PHASE(SIM_PHASE_APP);
+
+        moved = 0;
+        tasks[task]();
+        if (!moved) {
+            continue;
+        }
+        if (next_task >= count) {
+            reset_state();      // No such task: start over from task 0 rather than spin.
+            continue;
+        }
+
+        // Write the spare copy, then switch to it and the next task in one word.
+        SIM_PHASE(SIM_PHASE_CHECKPOINT);
+        copy(task_state.vars[copy_idx ^ 1], task_vars, size);
+        task_state.commit = ((uint16_t) next_task << 1) | (copy_idx ^ 1);
+        SIM_COMMIT();
+        SIM_PHASE(SIM_PHASE_APP);
+    }
+}
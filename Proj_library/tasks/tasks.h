@@ -0,0 +1,79 @@
+/*
+Task-based intermittent execution for the MSP430FR5994, by P. Krawiec.
+
+An alternative to Hibernus for applications that can be split into short tasks. Nothing
+is saved when the supply fails. Instead the runtime commits a small amount of state to
+FRAM at the end of every task, and after a power loss it restarts the task that was
+running, from the state committed before it started.
+
+    - A task is a void function. It ends by naming the task to run next with task_next().
+      A task that returns without calling task_next() is run again, from the same state.
+    - State that has to carry over between tasks lives in one application struct, reached
+      through task_vars. A task works on a private RAM copy of it, loaded from FRAM when the
+      task starts, so a task cut short by a power loss leaves the committed copy untouched.
+    - At task_next() the private copy is written to the spare of two FRAM copies, then the
+      next task and the copy to use are switched with a single 16-bit write. That write is the
+      commit point: a power loss before it re-runs the task, after it starts the next one.
+
+Tasks must therefore be idempotent: running one again from its start state must be harmless.
+Plain RAM variables are lost at every power loss, peripherals start from reset and I/O done
+by a task (LEDs, radio packets) is repeated if the task is cut short.
+
+Only the application state is committed, so a commit costs a few cycles per byte of it,
+against Hibernus' copy of the whole 4KB of RAM and the peripheral registers.
+*/
+
+#ifndef TASKS_H
+#define TASKS_H
+
+#include <stdint.h>
+#include <msp430.h>
+#include <Proj_library/h_files/t1_util.h>
+
+#define TASK_MAGIC      0x5453  ///< 'TS', marks initialised runtime state in FRAM.
+#define TASK_VARS_SIZE  32u     ///< Maximum size of the application's task-shared state.
+
+typedef void (*task_t)(void);
+
+/**
+ * @brief Runtime state, kept in FRAM.
+ */
+typedef struct {
+    uint16_t magic;                         ///< TASK_MAGIC once initialised.
+    uint16_t commit;                        ///< (task to run << 1) | FRAM copy of vars.
+    uint8_t vars[2][TASK_VARS_SIZE];        ///< Committed and spare copy of task_vars.
+} task_state_t;
+
+extern task_state_t task_state;
+
+/**
+ * @brief Private copy of the task-shared state, for the running task.
+ *
+ * The application casts it to its own struct, of at most TASK_VARS_SIZE bytes.
+ */
+extern uint8_t task_vars[TASK_VARS_SIZE];
+
+//*************************************************************************************
+
+/**
+ * @brief Run the tasks, from the last committed one. Does not return.
+ *
+ * On the first power-up after flashing, task_vars is zeroed and tasks[0] runs first.
+ *
+ * @param tasks : Task table, task_next() takes indices into it.
+ * @param count : Number of tasks in the table.
+ * @param size : Size of the application's task-shared state.
+ */
+void task_run(const task_t *tasks, uint8_t count, uint8_t size);
+
+
+/**
+ * @brief Commit task_vars and move on to another task once the running one returns.
+ *
+ * @param task : Index of the next task. One outside the table, like a commit word that
+ *               reads back out of range, starts the application over from task 0 with
+ *               task_vars zeroed.
+ */
+void task_next(uint8_t task);
+
+#endif // TASKS_H
@@ -0,0 +1,108 @@
+/*
+ * MCLK cycles and MCU energy of the radio payload encryption on the host simulator, against
+ * the packet's air time, by P. Krawiec.
+ *
+ * Built like aes_test.c: aes_bench on the simulated AES256 module, aes_bench_sw with
+ * T1_AES_SW. At the 8MHz default clock profile it times aes_seal() and aes_open() for
+ * payloads of 1 to 56 bytes, REPEAT calls each, and prints them next to the air time and
+ * radio energy of the sealed packet (t1_energy.h) at the Zeta+'s default baud rate and
+ * power. The software version's round keys are expanded by a first call, not timed, and its
+ * cycles are the library's modelled SW_ROUND_CYCLES, not a measurement.
+ *
+ *     ./aes_bench -t traces/steady.txt -d 30
+ */
+
+#include <stdio.h>
+#include <Proj_library/h_files/t1_util.h>
+#include <Proj_library/h_files/t1_zeta.h>
+#include <Proj_library/h_files/t1_energy.h>
+#include <Proj_library/h_files/t1_aes.h>
+#include "sim.h"
+
+#define REPEAT          16u
+#define MAX_LEN         56u
+
+typedef struct {
+    uint64_t t;
+    double e;
+} mark_t;
+
+static mark_t mark(void)
+{
+    mark_t m = {sim_time, 0.0};
+    int p;
+
+    for (p = 0; p < SIM_PHASES; p++) {
+        m.e += sim_sh->energy[p];
+    }
+    return m;
+}
+
+static void add(mark_t *sum, mark_t from)
+{
+    mark_t to = mark();
+
+    sum->t += to.t - from.t;
+    sum->e += to.e - from.e;
+}
+
+static void report(const char *call, uint8_t len, mark_t sum, uint16_t mv)
+{
+    double s = (double) sum.t / SIM_PS_PER_S / REPEAT;
+    double air = energy_airtime_us(ZETA_AIR_LEN(len), ZETA_RF_BAUD);
+    double tx = energy_tx(ZETA_AIR_LEN(len), ZETA_RF_BAUD, ZETA_RF_POWER, mv);
+    char name[32];
+
+    snprintf(name, sizeof(name), "%s (%u B)", call, len);
+    printf("%-18s %8.0f cycles %10.3f us %9.3f nJ  %5.2f%% of %7.0f us air, %6.3f%% of %5.0f uJ\n",
+           name, s * MCLK_HZ, s * 1e6, sum.e * 1e9 / REPEAT, s * 1e6 * 100 / air, air,
+           sum.e * 1e6 / REPEAT * 100 / tx, tx);
+}
+
+int main(void)
+{
+    static const uint8_t lens[] = {1, 8, 16, 32, MAX_LEN};
+    static uint8_t buf[AES_BUF_LEN(MAX_LEN)];
+    mark_t seal, open, m;
+    uint16_t mv;
+    uint8_t n, len;
+    unsigned k, r;
+
+    PM5CTL0 &= ~(LOCKLPM5);
+    WDTCTL = WDTPW | WDTHOLD;
+    io_init();
+    clock_init();
+    P4IE = 0;
+    supply_mv(&mv);
+
+#ifdef T1_AES_SW
+    printf("AES software, MCLK %u MHz, cycles modelled\n", (unsigned)(MCLK_HZ / 1000000u));
+#else
+    printf("AES256 module, MCLK %u MHz\n", (unsigned)(MCLK_HZ / 1000000u));
+#endif // T1_AES_SW
+    n = aes_seal(buf, 1);
+    aes_open(buf, &n);
+
+    for (k = 0; k < sizeof(lens); k++) {
+        len = lens[k];
+        seal.t = open.t = 0;
+        seal.e = open.e = 0.0;
+        for (r = 0; r < REPEAT; r++) {
+            m = mark();
+            n = aes_seal(buf, len);
+            add(&seal, m);
+            m = mark();
+            if (aes_open(buf, &n) != ERROR_OK) {
+                printf("aes_open (%u B) FAIL\n", len);
+            }
+            add(&open, m);
+        }
+        report("aes_seal", len, seal, mv);
+        report("aes_open", len, open, mv);
+    }
+    printf("supply %u mV, clock errors: %lu FRAM, %lu SPI  %s\n", mv, sim_sh->fram_errors,
+           sim_sh->spi_errors, (sim_sh->fram_errors || sim_sh->spi_errors) ? "FAIL" : "ok");
+
+    fflush(stdout);
+    return 0;
+}
@@ -0,0 +1,210 @@
+/*
+ * Host test of the radio payload encryption (t1_aes.c), by P. Krawiec.
+ *
+ * An application for the power simulator, built twice with T1_AES: aes_test runs the library
+ * on the simulated AES256 module, aes_test_sw with T1_AES_SW on its software AES. It checks
+ *   the simulator's AES (sim_aes.c) against the FIPS-197 appendix C examples, and the module
+ *     model driven through its registers against the AES-256 one,
+ *   aes_seal() for payloads of 0 to MAX_LEN bytes against OFB and CBC-MAC computed here with
+ *     sim_aes.c (t1_aes.h), and that it leaves the memory after AES_BUF_LEN() alone,
+ *   aes_open() on every sealed packet, back to the payload,
+ *   aes_open() rejecting (ERROR_AUTH) a changed ciphertext, nonce or tag byte, a replay,
+ *     an older packet and one shorter than AES_OVERHEAD.
+ *
+ *     ./aes_test -t traces/steady.txt -d 30
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <Proj_library/h_files/t1_util.h>
+#include <Proj_library/h_files/t1_aes.h>
+#include "sim.h"
+
+#define MAX_LEN     40u
+#define GUARD       0xA5u   ///< Fills the bytes after the buffer.
+
+static int fails;
+
+static void result(const char *what, int ok)
+{
+    printf("  %-34s %s\n", what, ok ? "ok" : "FAIL");
+    fails += !ok;
+}
+
+static void hex(const char *s, uint8_t *out, unsigned n)
+{
+    unsigned k, v;
+
+    for (k = 0; k < n; k++) {
+        sscanf(s + 2 * k, "%2x", &v);
+        out[k] = (uint8_t) v;
+    }
+}
+
+// FIPS-197 appendix C: key 000102..., plaintext 00112233...
+static void known_answers(void)
+{
+    static const char *ct[3] = {"69c4e0d86a7b0430d8cdb78070b4c55a",
+                                "dda97ca4864cdfe06eaf70a0ec0d7191",
+                                "8ea2b7ca516745bfeafc49904b496089"};
+    uint8_t key[32], pt[16], want[16], out[16];
+    unsigned k, n;
+    uint16_t w;
+    char what[40];
+
+    for (k = 0; k < 32; k++) {
+        key[k] = (uint8_t) k;
+    }
+    for (k = 0; k < 16; k++) {
+        pt[k] = (uint8_t)(0x11 * k);
+    }
+    for (n = 0; n < 3; n++) {
+        hex(ct[n], want, 16);
+        sim_aes_encrypt(key, 128 + 64 * n, pt, out);
+        snprintf(what, sizeof(what), "FIPS-197 C.%u, AES-%u", n + 1, 128 + 64 * n);
+        result(what, !memcmp(out, want, 16));
+    }
+
+    // The same block through AESAKEY, AESADIN and AESADOUT.
+    AESACTL0 = AESSWRST;
+    AESACTL0 = AESKL_2;
+    for (k = 0; k < 32; k += 2) {
+        AESAKEY = key[k] | (key[k + 1] << 8);
+    }
+    for (k = 0; k < 16; k += 2) {
+        AESADIN = pt[k] | (pt[k + 1] << 8);
+    }
+    while (AESASTAT & AESBUSY)
+        ;
+    for (k = 0; k < 16; k += 2) {
+        w = AESADOUT;
+        out[k] = (uint8_t) w;
+        out[k + 1] = w >> 8;
+    }
+    result("AES256 module, ECB, C.3", !memcmp(out, want, 16));
+}
+
+// What aes_seal() should send for payload p of len bytes with this nonce.
+static void reference(const uint8_t *p, uint8_t len, uint32_t nonce, uint8_t *air)
+{
+    uint8_t ks[16] = {0}, x[16] = {0};
+    unsigned k;
+
+    for (k = 0; k < AES_NONCE_LEN; k++) {
+        ks[k] = x[k] = (uint8_t)(nonce >> (8 * k));
+    }
+    ks[AES_NONCE_LEN] = 0x01;
+    x[AES_NONCE_LEN] = 0x02;
+    x[AES_NONCE_LEN + 1] = len;
+    for (k = 0; k < len; k++) {
+        if (!(k % 16)) {
+            sim_aes_encrypt(aes_key_enc, 256, ks, ks);
+        }
+        air[k] = p[k] ^ ks[k % 16];
+    }
+    sim_aes_encrypt(aes_key_mac, 256, x, x);
+    for (k = 0; k < 16 * AES_BLOCKS(len); k++) {
+        x[k % 16] ^= (k < len) ? air[k] : 0;
+        if (k % 16 == 15) {
+            sim_aes_encrypt(aes_key_mac, 256, x, x);
+        }
+    }
+    for (k = 0; k < AES_NONCE_LEN; k++) {
+        air[len + k] = (uint8_t)(nonce >> (8 * k));
+    }
+    memcpy(&air[len + AES_NONCE_LEN], x, AES_TAG_LEN);
+}
+
+// Seal a payload of len bytes into buf, as the transmitter would.
+static uint8_t seal(uint8_t *buf, uint8_t len, uint8_t seed)
+{
+    unsigned k;
+
+    memset(buf, GUARD, AES_BUF_LEN(MAX_LEN) + 16);
+    for (k = 0; k < len; k++) {
+        buf[k] = (uint8_t)(seed + 7 * k);
+    }
+    return aes_seal(buf, len);
+}
+
+static void round_trips(void)
+{
+    static uint8_t buf[AES_BUF_LEN(MAX_LEN) + 16], payload[MAX_LEN], air[MAX_LEN + 16];
+    int sealed = 1, guarded = 1, opened = 1;
+    uint8_t len, n, k;
+    uint32_t nonce;
+
+    for (len = 0; len <= MAX_LEN; len++) {
+        nonce = aes_tx_nonce + 1;
+        n = seal(buf, len, len);
+        for (k = 0; k < len; k++) {
+            payload[k] = (uint8_t)(len + 7 * k);
+        }
+        reference(payload, len, nonce, air);
+        if ((n != len + AES_OVERHEAD) || memcmp(buf, air, n)) {
+            printf("  seal, %2u bytes: differs from the reference\n", len);
+            sealed = 0;
+        }
+        for (k = AES_BUF_LEN(len); k < AES_BUF_LEN(len) + 16; k++) {
+            guarded &= (buf[k] == GUARD);
+        }
+        if ((aes_open(buf, &n) != ERROR_OK) || (n != len) || memcmp(buf, payload, len)) {
+            printf("  open, %2u bytes: not the payload\n", len);
+            opened = 0;
+        }
+    }
+    result("seal against reference, 0-40 bytes", sealed);
+    result("buffer only to AES_BUF_LEN()", guarded);
+    result("open, 0-40 bytes", opened);
+}
+
+static void rejects(void)
+{
+    static uint8_t buf[AES_BUF_LEN(MAX_LEN) + 16], old[AES_BUF_LEN(MAX_LEN) + 16];
+    static const char *what[3] = {"changed ciphertext rejected", "changed nonce rejected",
+                                  "changed tag rejected"};
+    uint8_t n, m, at[3] = {5, 20, 20 + AES_NONCE_LEN + 3};
+    int k;
+
+    for (k = 0; k < 3; k++) {
+        n = seal(buf, 20, (uint8_t) k);
+        buf[at[k]] ^= 0x10;
+        result(what[k], aes_open(buf, &n) == ERROR_AUTH);
+    }
+    n = seal(old, 20, 0);
+    memcpy(buf, old, sizeof(buf));
+    m = n;
+    aes_open(buf, &m);
+    memcpy(buf, old, sizeof(buf));
+    result("replay rejected", aes_open(buf, &n) == ERROR_AUTH);
+
+    n = seal(old, 12, 1);
+    m = seal(buf, 12, 2);
+    aes_open(buf, &m);
+    result("older nonce rejected", aes_open(old, &n) == ERROR_AUTH);
+
+    n = AES_OVERHEAD - 1;
+    result("short packet rejected", aes_open(buf, &n) == ERROR_AUTH);
+}
+
+int main(void)
+{
+    PM5CTL0 &= ~(LOCKLPM5);
+    WDTCTL = WDTPW | WDTHOLD;
+    io_init();
+    clock_init();
+    P4IE = 0;
+
+#ifdef T1_AES_SW
+    printf("AES software\n");
+#else
+    printf("AES256 module\n");
+#endif // T1_AES_SW
+    known_answers();
+    round_trips();
+    rejects();
+    printf("%s\n", fails ? "FAIL" : "PASS");
+
+    fflush(stdout);
+    return 0;
+}
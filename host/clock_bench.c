@@ -0,0 +1,99 @@
+/*
+ * Time and MCU energy per clock profile, on the host simulator, by P. Krawiec.
+ *
+ * An application for the power simulator (built like sim_tx, see the Makefile). With a steady
+ * supply it switches to each clock profile (clock_set_profile()) in turn and measures
+ *   hibernate   a full Hibernus checkpoint (Hibernate()), RAM and peripheral registers,
+ *   packet      a PACKET_LEN byte packet written to the Zeta+ (zeta_send_packet()),
+ * on the simulated clock and the simulator's energy model (sim/sim_cpu.c), modelled estimates
+ * that rest on the firmware's SIM_CYCLES() charges. Any clock change the simulator flags
+ * (MCLK above 8MHz without a FRAM wait state, SPI above the Zeta+ limit) prints "FAIL".
+ *
+ *     ./clock_bench -t traces/steady.txt -d 30
+ */
+
+#include <stdio.h>
+#include <Proj_library/hibernus/hibernation_5994.h>
+#include <Proj_library/h_files/t1_util.h>
+#include <Proj_library/h_files/t1_spi.h>
+#include <Proj_library/h_files/t1_zeta.h>
+#include "sim.h"
+
+#define PACKET_LEN      32u
+
+static const char *const profile_names[CLOCK_PROFILES] = {"low power", "default", "burst"};
+
+typedef struct {
+    uint64_t t;
+    double e;
+} mark_t;
+
+static mark_t mark(void)
+{
+    mark_t m = {sim_time, 0.0};
+    int p;
+
+    for (p = 0; p < SIM_PHASES; p++) {
+        m.e += sim_sh->energy[p];
+    }
+    return m;
+}
+
+static void report(mark_t from)
+{
+    mark_t to = mark();
+
+    printf("  %10.3f ms %9.3f uJ", (double)(to.t - from.t) / (SIM_PS_PER_S / 1000),
+           (to.e - from.e) * 1e6);
+}
+
+int main(void)
+{
+    uint8_t packet[PACKET_LEN];
+    clock_profile_t p;
+    mark_t m;
+    unsigned k;
+
+    PM5CTL0 &= ~(LOCKLPM5);
+    WDTCTL = WDTPW | WDTHOLD;
+    io_init();
+    clock_init();
+    spi_init();
+    P4IE = 0;
+    zeta_init();
+    zeta_select_mode(0x2);
+
+    for (k = 0; k < PACKET_LEN; k++) {
+        packet[k] = (uint8_t)(k + 0x21);
+    }
+
+    printf("modelled: SIM_CYCLES() charges, sim/sim_cpu.c currents and wait states\n");
+    printf("%-10s %8s %26s %26s\n", "profile", "MCLK", "hibernate", "packet");
+    for (p = CLOCK_LOW_POWER; p < CLOCK_PROFILES; p++) {
+        if (clock_set_profile(p) != ERROR_OK) {
+            printf("%-10s FAIL\n", profile_names[p]);
+            continue;
+        }
+        printf("%-10s %5u MHz", profile_names[p], (p == CLOCK_BURST) ? 16u :
+               (p == CLOCK_DEFAULT) ? 8u : 1u);
+
+        m = mark();
+        Hibernate();
+        report(m);
+
+        m = mark();
+        zeta_send_packet(packet, PACKET_LEN);
+        report(m);
+        printf("\n");
+    }
+    clock_set_profile(CLOCK_DEFAULT);
+
+    if (clock_set_profile(CLOCK_PROFILES) != ERROR_RANGE) {
+        printf("clock_set_profile(CLOCK_PROFILES) accepted  FAIL\n");
+    }
+    printf("clock errors: %lu FRAM, %lu SPI  %s\n", sim_sh->fram_errors, sim_sh->spi_errors,
+           (sim_sh->fram_errors || sim_sh->spi_errors) ? "FAIL" : "ok");
+
+    fflush(stdout);
+    return 0;
+}
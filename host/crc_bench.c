@@ -0,0 +1,137 @@
+/*
+ * MCLK cycles and MCU energy of the packet CRC (t1_crc.c) on the host simulator, against
+ * the packet it is sent with, by P. Krawiec.
+ *
+ * Built four times with T1_CRC: crc_bench on the CRC16 module, crc_bench32 (T1_CRC32) on
+ * the CRC32 module, crc_bench_sw and crc_bench32_sw (T1_CRC_SW) from the software tables.
+ * It checks the CRC of "123456789" against the standard's check value and that a flipped
+ * bit is caught, then, at the 8MHz default clock profile, times the CRC of 1 to 60 bytes
+ * fed a byte at a time (crc_start(), crc_byte(), crc_result()), REPEAT times each, and
+ * zeta_send_packet() of the same payload, which streams it to spi_xfer() with its CRC.
+ * The software tables' cycles are the library's modelled SW_BYTE_CYCLES, not a measurement.
+ *
+ *     ./crc_bench -t traces/steady.txt -d 30
+ */
+
+#include <stdio.h>
+#include <Proj_library/h_files/t1_util.h>
+#include <Proj_library/h_files/t1_spi.h>
+#include <Proj_library/h_files/t1_zeta.h>
+#include <Proj_library/h_files/t1_crc.h>
+#include "sim.h"
+
+#define REPEAT          16u
+#define MAX_LEN         60u     ///< With CRC-32, up to the Zeta+'s 64 bytes on air.
+
+#ifdef T1_CRC32
+#define CHECK           0xCBF43926u
+#define NAME            "CRC-32"
+#else
+#define CHECK           0x29B1u
+#define NAME            "CRC-16/CCITT"
+#endif // T1_CRC32
+
+typedef struct {
+    uint64_t t;
+    double e;
+} mark_t;
+
+static mark_t mark(void)
+{
+    mark_t m = {sim_time, 0.0};
+    int p;
+
+    for (p = 0; p < SIM_PHASES; p++) {
+        m.e += sim_sh->energy[p];
+    }
+    return m;
+}
+
+// Time [s] and MCU energy [J] per call since from.
+static void since(mark_t from, double *s, double *e)
+{
+    mark_t to = mark();
+
+    *s = (double)(to.t - from.t) / SIM_PS_PER_S / REPEAT;
+    *e = (to.e - from.e) / REPEAT;
+}
+
+static void crc(const uint8_t *p, uint8_t len, uint8_t *fcs)
+{
+    uint8_t k;
+
+    crc_start();
+    for (k = 0; k < len; k++) {
+        crc_byte(p[k]);
+    }
+    crc_result(fcs);
+}
+
+int main(void)
+{
+    static const uint8_t lens[] = {1, 8, 16, 32, MAX_LEN};
+    static uint8_t packet[MAX_LEN];
+    uint8_t fcs[CRC_LEN], k, len;
+    double s, e, tx_s, tx_e;
+    uint32_t value = 0;
+    unsigned n;
+    mark_t m;
+
+    PM5CTL0 &= ~(LOCKLPM5);
+    WDTCTL = WDTPW | WDTHOLD;
+    io_init();
+    clock_init();
+    spi_init();
+    __enable_interrupt();
+
+#ifdef T1_CRC_SW
+    printf("%s, software table, MCLK %u MHz, cycles modelled\n", NAME, (unsigned)(MCLK_HZ / 1000000u));
+#else
+    printf("%s, CRC module, MCLK %u MHz\n", NAME, (unsigned)(MCLK_HZ / 1000000u));
+#endif // T1_CRC_SW
+    crc((const uint8_t *) "123456789", 9, fcs);
+    for (k = 0; k < CRC_LEN; k++) {
+        value |= (uint32_t) fcs[k] << (8u * k);
+    }
+    printf("check value %08lx             %s\n", (unsigned long) value,
+           (value == CHECK) ? "ok" : "FAIL");
+
+    for (k = 0; k < MAX_LEN; k++) {
+        packet[k] = (uint8_t)(3 * k + 1);
+    }
+    crc(packet, MAX_LEN, fcs);
+    for (n = 0; n < 2; n++) {
+        packet[MAX_LEN / 2] ^= 0x08;    // A bit error, then the packet as sent.
+        crc_start();
+        for (k = 0; k < MAX_LEN; k++) {
+            crc_byte(packet[k]);
+        }
+        printf("%-32s %s\n", n ? "packet as sent passes" : "bit error caught",
+               (crc_check(fcs) == (n ? ERROR_OK : ERROR_CRC)) ? "ok" : "FAIL");
+    }
+
+    P3OUT |= SDN;
+    zeta_init();
+    zeta_select_mode(0x2);
+    printf("bytes       crc cycles         us         nJ   zeta_send_packet us   crc share\n");
+    for (k = 0; k < sizeof(lens); k++) {
+        len = lens[k];
+        m = mark();
+        for (n = 0; n < REPEAT; n++) {
+            crc(packet, len, fcs);
+        }
+        since(m, &s, &e);
+        m = mark();
+        for (n = 0; n < REPEAT; n++) {
+            zeta_send_packet(packet, len);
+        }
+        since(m, &tx_s, &tx_e);
+        printf("%5u %10.0f cycles %10.3f %10.3f %21.3f %10.2f%%\n", len, s * MCLK_HZ, s * 1e6,
+               e * 1e9, tx_s * 1e6, s * 100 / tx_s);
+    }
+    printf("clock errors: %lu FRAM, %lu SPI  %s\n", sim_sh->fram_errors, sim_sh->spi_errors,
+           (sim_sh->fram_errors || sim_sh->spi_errors) ? "FAIL" : "ok");
+
+    fflush(stdout);
+    return 0;
+}
@@ -0,0 +1,153 @@
+/*
+ * Compression ratio and MCLK cycles per sample of the delta compression (t1_delta.c) on the
+ * host simulator, on sensor traces, by P. Krawiec.
+ *
+ * Built twice: delta_bench with varints, delta_bench_rice with T1_DELTA_RICE. Each trace is
+ * SAMPLES 16-bit samples, generated here the same every run:
+ *   temperature    a 12-bit ADC reading drifting slowly, +-2 LSB of noise,
+ *   supply         a storage capacitor in mV, run down then recharged, +-3 mV of noise,
+ *   vibration      an accelerometer axis, a 3000 LSB sine of 24 samples, +-40 of noise,
+ *   counter        the transmitter's data values, 1 to 16 over and over,
+ *   noise          12-bit random samples, nothing to compress.
+ * It is cut into packets of up to STREAM_MAX bytes of stream, each started again with
+ * delta_begin() as t1_main_Tx.c does, decoded back and checked against the trace. The ratio
+ * is the raw 2 bytes a sample against the stream's bytes; the packets against those of the
+ * raw samples in the same space. Cycles are at the 8MHz default clock profile, from the
+ * library's modelled costs of its work (SAMPLE_CYCLES and the others), not a measurement.
+ *
+ *     ./delta_bench -t traces/steady.txt -d 30
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <Proj_library/h_files/t1_util.h>
+#include <Proj_library/h_files/t1_frame.h>
+#include <Proj_library/h_files/t1_delta.h>
+#include "sim.h"
+
+#define SAMPLES     1024u
+#define STREAM_MAX  (64u - FRAME_HDR_LEN - FRAME_REC_LEN(0u) - 2u)  ///< 64 bytes, a CRC-16.
+
+static int16_t trace[SAMPLES], back[SAMPLES];
+static uint8_t packet[STREAM_MAX];
+static uint32_t rnd_state = 0x9E3779B9u;
+
+// xorshift32, the same sequence every run.
+static uint32_t rnd(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+// Noise of -amp to amp.
+static int noise(int amp)
+{
+    return (int)(rnd() % (2u * amp + 1u)) - amp;
+}
+
+static void generate(unsigned which)
+{
+    unsigned n;
+    double v = 3000.0;
+
+    for (n = 0; n < SAMPLES; n++) {
+        switch (which) {
+        case 0:
+            trace[n] = (int16_t)(1850.0 + 30.0 * sin(2.0 * M_PI * n / 512.0) + noise(2));
+            break;
+        case 1:
+            v = (n % 256u) ? v - 4.5 : 3000.0;
+            trace[n] = (int16_t)(v + noise(3));
+            break;
+        case 2:
+            trace[n] = (int16_t)(3000.0 * sin(2.0 * M_PI * n / 24.0) + noise(40));
+            break;
+        case 3:
+            trace[n] = (int16_t)(1u + n % 16u);
+            break;
+        default:
+            trace[n] = (int16_t)(rnd() & 0x0FFFu);
+            break;
+        }
+    }
+}
+
+static uint64_t cycles(uint64_t from)
+{
+    return (sim_time - from) * MCLK_HZ / SIM_PS_PER_S;
+}
+
+int main(void)
+{
+    static const char *names[] = {"temperature", "supply", "vibration", "counter", "noise"};
+    uint64_t enc = 0, dec = 0, t;
+    unsigned which, n, m, k, bytes, packets, raw_packets;
+    delta_enc_t e;
+    delta_dec_t d;
+    error_t status;
+    uint8_t len;
+    int ok, fails = 0;
+
+    PM5CTL0 &= ~(LOCKLPM5);
+    WDTCTL = WDTPW | WDTHOLD;
+    io_init();
+    clock_init();
+
+#ifdef T1_DELTA_RICE
+    printf("Delta + Rice codes, %u samples a trace, up to %u bytes a packet, cycles modelled\n",
+           SAMPLES, STREAM_MAX);
+#else
+    printf("Delta + varints, %u samples a trace, up to %u bytes a packet, cycles modelled\n",
+           SAMPLES, STREAM_MAX);
+#endif // T1_DELTA_RICE
+    printf("trace         ratio  bits/sample  packets raw  packets  encode cyc  decode cyc\n");
+    for (which = 0; which < sizeof(names) / sizeof(names[0]); which++) {
+        generate(which);
+        bytes = packets = 0;
+        enc = dec = 0;
+        ok = 1;
+        for (n = m = 0; n < SAMPLES; n = m) {
+            t = sim_time;
+            delta_begin(&e, packet, STREAM_MAX);
+            while ((m < SAMPLES) && (delta_put(&e, trace[m]) == ERROR_OK)) {
+                m++;
+            }
+            len = delta_end(&e);
+            enc += cycles(t);
+            bytes += len;
+            packets++;
+
+            t = sim_time;
+            delta_open(&d, packet, len);
+            for (k = n; (status = delta_get(&d, &back[k])) == ERROR_OK; k++) {
+            }
+            dec += cycles(t);
+            ok &= (status == ERROR_NOBUFS) && (k == m) && (m > n);
+            for (k = n; k < m; k++) {
+                ok &= (back[k] == trace[k]);
+            }
+        }
+        raw_packets = (2u * SAMPLES + STREAM_MAX - 1u) / STREAM_MAX;
+        printf("%-12s %6.2f %12.2f %12u %8u %11.1f %11.1f  %s\n", names[which],
+               2.0 * SAMPLES / bytes, 8.0 * bytes / SAMPLES, raw_packets, packets,
+               (double) enc / SAMPLES, (double) dec / SAMPLES, ok ? "ok" : "FAIL");
+        fails += !ok;
+    }
+
+    // A stream cut short is an error, not fewer samples.
+    delta_begin(&e, packet, STREAM_MAX);
+    delta_put(&e, 0);
+    delta_put(&e, 20000);
+    len = delta_end(&e);
+    delta_open(&d, packet, len - 1u);
+    while ((status = delta_get(&d, &back[0])) == ERROR_OK) {
+    }
+    printf("%-72s %s\n", "stream cut short rejected", (status == ERROR_RANGE) ? "ok" : "FAIL");
+    fails += (status != ERROR_RANGE);
+    printf("%s\n", fails ? "FAIL" : "PASS");
+
+    fflush(stdout);
+    return 0;
+}
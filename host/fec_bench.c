@@ -0,0 +1,192 @@
+/*
+ * MCLK cycles of the forward error correction (t1_fec.c) on the host simulator, and the
+ * packets it saves under simulated bit errors, by P. Krawiec.
+ *
+ * Built with T1_FEC. It checks that every single bit error in a block is corrected and every
+ * double bit error in a codeword detected, then, at the 8MHz default clock profile, times
+ * fec_encode() and fec_decode() of a 32 byte payload (the most the Zeta+'s 64 bytes hold
+ * coded), REPEAT times, against its air time at the 500 kbps of RF baud 6; the cycles are
+ * the library's modelled CODE_CYCLES and BIT_CYCLES, not a measurement. Then PACKETS
+ * packets of PAYLOAD bytes and a CRC-16 go through a channel flipping each bit with
+ * probability BER, sent plain and coded: the fraction lost plain (any bit error, dropped by
+ * the CRC), and coded the fraction FEC detects but cannot correct, the fraction it passes
+ * wrong (left to the CRC) and the data bit error rate left. Last, bursts of consecutive bit
+ * errors, corrected up to 2 * FEC_BLOCK bits by the interleaving.
+ *
+ *     ./fec_bench -t traces/steady.txt -d 30
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <Proj_library/h_files/t1_util.h>
+#include <Proj_library/h_files/t1_fec.h>
+#include "sim.h"
+
+#define REPEAT      16u
+#define MAX_LEN     32u
+#define RF_BPS      500000u
+#define PAYLOAD     16u         ///< 14 bytes and a CRC-16, whole blocks.
+#define PACKETS     2000u
+
+static uint32_t rnd_state = 0x12345678u;
+
+// xorshift32, the same sequence every run.
+static uint32_t rnd(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+static double uniform(void)
+{
+    return (double) rnd() / 4294967296.0;
+}
+
+static void encode(const uint8_t *data, uint8_t len, uint8_t *coded)
+{
+    uint8_t i, n;
+
+    for (i = 0; i < len; i += n) {
+        n = ((unsigned)(len - i) < FEC_BLOCK) ? (uint8_t)(len - i) : FEC_BLOCK;
+        fec_encode(&data[i], n, &coded[2u * i]);
+    }
+}
+
+static error_t decode(const uint8_t *coded, uint8_t len, uint8_t *data)
+{
+    error_t status = ERROR_OK;
+    uint8_t i, n;
+
+    for (i = 0; i < len; i += n) {
+        n = ((unsigned)(len - i) < FEC_BLOCK) ? (uint8_t)(len - i) : FEC_BLOCK;
+        if (fec_decode(&coded[2u * i], n, &data[i]) != ERROR_OK) {
+            status = ERROR_CRC;
+        }
+    }
+    return status;
+}
+
+static int corrects(void)
+{
+    uint8_t data[FEC_BLOCK] = {0x5A, 0xC3, 0x0F, 0x96}, coded[2u * FEC_BLOCK], out[FEC_BLOCK];
+    unsigned a, b;
+    int ok = 1;
+
+    fec_encode(data, FEC_BLOCK, coded);
+    for (a = 0; a < 16u * FEC_BLOCK; a++) {
+        coded[a >> 3] ^= 0x80u >> (a & 7u);
+        ok &= (fec_decode(coded, FEC_BLOCK, out) == ERROR_OK) && !memcmp(out, data, FEC_BLOCK);
+        // A second error in the same codeword, 2 * FEC_BLOCK bits on after interleaving.
+        for (b = a + 2u * FEC_BLOCK; b < 16u * FEC_BLOCK; b += 2u * FEC_BLOCK) {
+            coded[b >> 3] ^= 0x80u >> (b & 7u);
+            ok &= (fec_decode(coded, FEC_BLOCK, out) == ERROR_CRC);
+            coded[b >> 3] ^= 0x80u >> (b & 7u);
+        }
+        coded[a >> 3] ^= 0x80u >> (a & 7u);
+    }
+    return ok;
+}
+
+int main(void)
+{
+    static const double bers[] = {1e-4, 1e-3, 3e-3, 1e-2, 2e-2};
+    static const uint8_t bursts[] = {1, 2, 4, 8, 9, 12, 16};
+    uint8_t data[MAX_LEN], coded[2u * MAX_LEN], out[MAX_LEN];
+    unsigned k, n, b, lost, bad, wrong, bits, fixed, start;
+    int ok, fails = 0;
+    uint64_t t;
+    double enc, dec;
+    error_t status;
+
+    PM5CTL0 &= ~(LOCKLPM5);
+    WDTCTL = WDTPW | WDTHOLD;
+    io_init();
+    clock_init();
+
+    printf("FEC Hamming(8,4), %u byte blocks interleaved, MCLK %u MHz, cycles modelled\n",
+           FEC_BLOCK, (unsigned)(MCLK_HZ / 1000000u));
+    ok = corrects();
+    printf("%-40s %s\n", "single errors fixed, double detected", ok ? "ok" : "FAIL");
+    fails += !ok;
+
+    for (k = 0; k < MAX_LEN; k++) {
+        data[k] = (uint8_t) rnd();
+    }
+    t = sim_time;
+    for (n = 0; n < REPEAT; n++) {
+        encode(data, MAX_LEN, coded);
+    }
+    enc = (double)(sim_time - t) / SIM_PS_PER_S / REPEAT;
+    t = sim_time;
+    for (n = 0; n < REPEAT; n++) {
+        status = decode(coded, MAX_LEN, out);
+    }
+    dec = (double)(sim_time - t) / SIM_PS_PER_S / REPEAT;
+    ok = (status == ERROR_OK) && !memcmp(out, data, MAX_LEN);
+    printf("%-40s %s\n", "round trip", ok ? "ok" : "FAIL");
+    fails += !ok;
+    printf("%u bytes   encode %6.0f cycles %7.1f us   decode %6.0f cycles %7.1f us\n", MAX_LEN,
+           enc * MCLK_HZ, enc * 1e6, dec * MCLK_HZ, dec * 1e6);
+    printf("%u bytes coded on air at %u kbps  %7.1f us, decode %.0f%% of it\n", 2u * MAX_LEN,
+           RF_BPS / 1000u, 2e6 * MAX_LEN * 8 / RF_BPS, dec * 100 * RF_BPS / (2.0 * MAX_LEN * 8));
+
+    printf("bit error rate   plain lost   FEC lost   FEC wrong   data BER left\n");
+    for (k = 0; k < sizeof(bers) / sizeof(bers[0]); k++) {
+        lost = bad = wrong = bits = 0;
+        for (n = 0; n < PACKETS; n++) {
+            for (b = 0; b < PAYLOAD; b++) {
+                data[b] = (uint8_t) rnd();
+            }
+            for (b = 0; b < 8u * PAYLOAD; b++) {
+                if (uniform() < bers[k]) {
+                    lost++;
+                    break;
+                }
+            }
+            encode(data, PAYLOAD, coded);
+            for (b = 0; b < 16u * PAYLOAD; b++) {
+                if (uniform() < bers[k]) {
+                    coded[b >> 3] ^= 0x80u >> (b & 7u);
+                }
+            }
+            if (decode(coded, PAYLOAD, out) != ERROR_OK) {
+                bad++;
+            }
+            else if (memcmp(out, data, PAYLOAD)) {
+                wrong++;
+                for (b = 0; b < PAYLOAD; b++) {
+                    bits += __builtin_popcount(out[b] ^ data[b]);
+                }
+            }
+        }
+        printf("%14.0e %11.2f%% %9.2f%% %10.2f%% %15.1e\n", bers[k], 100.0 * lost / PACKETS,
+               100.0 * bad / PACKETS, 100.0 * wrong / PACKETS,
+               (double) bits / (8.0 * PAYLOAD * PACKETS));
+    }
+
+    printf("burst bits   fixed\n");
+    for (k = 0; k < sizeof(bursts); k++) {
+        fixed = 0;
+        for (n = 0; n < PACKETS / 4u; n++) {
+            for (b = 0; b < PAYLOAD; b++) {
+                data[b] = (uint8_t) rnd();
+            }
+            encode(data, PAYLOAD, coded);
+            start = rnd() % (16u * PAYLOAD - bursts[k] + 1u);
+            for (b = start; b < start + bursts[k]; b++) {
+                coded[b >> 3] ^= 0x80u >> (b & 7u);
+            }
+            fixed += (decode(coded, PAYLOAD, out) == ERROR_OK) && !memcmp(out, data, PAYLOAD);
+        }
+        ok = (bursts[k] > 2u * FEC_BLOCK) || (fixed == PACKETS / 4u);
+        printf("%10u %6.1f%%%s\n", bursts[k], 100.0 * fixed / (PACKETS / 4u),
+               (bursts[k] <= 2u * FEC_BLOCK) ? (ok ? "  ok" : "  FAIL") : "");
+        fails += !ok;
+    }
+    printf("%s\n", fails ? "FAIL" : "PASS");
+
+    fflush(stdout);
+    return 0;
+}
@@ -0,0 +1,240 @@
+/*
+ * Host test of the binary payload frames (t1_frame.c), by P. Krawiec.
+ *
+ * An application for the power simulator, built with T1_FRAME. It checks
+ *   round trips: random lists of records written with frame_put() and frame_reserve(), padded
+ *     or not, read back by frame_open() and frame_next() with the same header and records,
+ *     each value a view into the packet,
+ *   the encoder: a record that does not fit is refused (NULL, ERROR_NOBUFS) and leaves the
+ *     frame as it was, FRAME_PAD is not a record type, frame_pad() stops at the buffer,
+ *   the decoder on FUZZ random payloads, bit flips and truncations of good frames: every
+ *     frame it takes has records inside [buf, buf + len) adding up to its length, and a short
+ *     payload, another version or a record past the end is rejected (ERROR_RANGE),
+ * then prints the bytes on air (RADIO_OVERHEAD a packet) of n data values sent as the raw
+ * byte a packet, a frame a packet and one frame of a single n byte record.
+ *
+ *     ./frame_test -t traces/steady.txt -d 30
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <Proj_library/h_files/t1_util.h>
+#include <Proj_library/h_files/t1_frame.h>
+#include "sim.h"
+
+#define MAX_LEN         60u     ///< The Zeta+'s 64 bytes on air less a CRC-32.
+#define ROUNDS          2000u
+#define FUZZ            20000u
+#define RADIO_OVERHEAD  11u     ///< Preamble, sync, length and CRC bytes a packet (sim_radio.c).
+
+static int fails;
+static uint32_t rnd_state = 0x2545F491u;
+
+static void result(const char *what, int ok)
+{
+    printf("  %-34s %s\n", what, ok ? "ok" : "FAIL");
+    fails += !ok;
+}
+
+// xorshift32, the same sequence every run.
+static uint32_t rnd(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+// Reads a frame the decoder took: every view inside the payload, the records adding up.
+static int well_read(const uint8_t *buf, uint8_t len)
+{
+    frame_reader_t r;
+    frame_rec_t rec;
+    unsigned total = FRAME_HDR_LEN;
+
+    if (frame_open(&r, buf, len) != ERROR_OK) {
+        return 1;
+    }
+    if ((r.len > len) || (r.node != buf[1]) || (r.seq != buf[2])) {
+        return 0;
+    }
+    while (frame_next(&r, &rec) == ERROR_OK) {
+        if ((rec.type == FRAME_PAD) || (rec.value < buf) || (rec.value + rec.len > buf + len)) {
+            return 0;
+        }
+        total += FRAME_REC_LEN(rec.len);
+    }
+    return (total == r.len) && ((r.len == len) || (buf[r.len] == FRAME_PAD));
+}
+
+static void round_trips(void)
+{
+    uint8_t buf[MAX_LEN], types[MAX_LEN], lens[MAX_LEN], values[MAX_LEN][MAX_LEN];
+    uint8_t node, seq, n, k, j, *p;
+    int ok = 1, views = 1;
+    frame_reader_t r;
+    frame_rec_t rec;
+    unsigned round;
+    frame_t f;
+
+    for (round = 0; round < ROUNDS; round++) {
+        node = (uint8_t) rnd();
+        seq = (uint8_t) rnd();
+        frame_begin(&f, buf, MAX_LEN, node, seq);
+        for (n = 0; ; n++) {
+            types[n] = (uint8_t)(1 + rnd() % 255);
+            lens[n] = (uint8_t)(rnd() % 8);
+            for (j = 0; j < lens[n]; j++) {
+                values[n][j] = (uint8_t) rnd();
+            }
+            if (rnd() & 1) {
+                if (frame_put(&f, types[n], values[n], lens[n]) != ERROR_OK) {
+                    break;
+                }
+            } else {
+                if (!(p = frame_reserve(&f, types[n], lens[n]))) {
+                    break;
+                }
+                memcpy(p, values[n], lens[n]);
+            }
+        }
+        if (rnd() & 1) {
+            frame_pad(&f, MAX_LEN);
+        }
+
+        if ((frame_open(&r, buf, f.len) != ERROR_OK) || (r.node != node) || (r.seq != seq)) {
+            ok = 0;
+            continue;
+        }
+        for (k = 0; frame_next(&r, &rec) == ERROR_OK; k++) {
+            if ((k >= n) || (rec.type != types[k]) || (rec.len != lens[k])
+                    || memcmp(rec.value, values[k], lens[k])) {
+                ok = 0;
+                break;
+            }
+            views &= (rec.value > buf) && (rec.value + rec.len <= buf + f.len);
+        }
+        ok &= (k == n);
+    }
+    result("records read back as written", ok);
+    result("values are views into the packet", views);
+}
+
+static void encoder(void)
+{
+    uint8_t buf[MAX_LEN + 1], value[MAX_LEN];
+    frame_t f;
+    uint8_t len;
+
+    memset(buf, 0xA5, sizeof(buf));
+    memset(value, 0x5A, sizeof(value));
+    frame_begin(&f, buf, 8, 7, 9);
+    result("header written",
+           (f.len == FRAME_HDR_LEN) && (buf[0] == FRAME_VERSION << 4) && (buf[1] == 7)
+           && (buf[2] == 9));
+    result("record filling the buffer fits",
+           (frame_put(&f, FRAME_DATA, value, 3) == ERROR_OK) && (f.len == 8));
+    len = f.len;
+    result("one more byte refused",
+           (frame_put(&f, FRAME_DATA, value, 0) == ERROR_NOBUFS)
+           && (frame_reserve(&f, FRAME_DATA, 0) == 0) && (f.len == len) && (buf[8] == 0xA5));
+
+    frame_begin(&f, buf, MAX_LEN, 1, 1);
+    result("FRAME_PAD is not a record type",
+           (frame_put(&f, FRAME_PAD, value, 1) == ERROR_NOBUFS) && (f.len == FRAME_HDR_LEN));
+    result("longest record refused",
+           frame_reserve(&f, FRAME_DATA, MAX_LEN - FRAME_HDR_LEN - 1) == 0);
+    frame_put(&f, FRAME_DATA, value, 1);
+    frame_pad(&f, 2 * MAX_LEN);
+    result("padded to the buffer, not past it",
+           (f.len == MAX_LEN) && (buf[MAX_LEN - 1] == FRAME_PAD) && (buf[MAX_LEN] == 0xA5));
+    frame_pad(&f, 4);
+    result("padding never shortens", f.len == MAX_LEN);
+}
+
+static void decoder(void)
+{
+    static const uint8_t good[] = {FRAME_VERSION << 4, 1, 2, FRAME_DATA, 2, 0x10, 0x11,
+                                   FRAME_END, 0, FRAME_PAD, 0x55};
+    uint8_t buf[MAX_LEN];
+    frame_reader_t r;
+    frame_rec_t rec;
+    unsigned n, taken = 0, ok = 1;
+    uint8_t len, k;
+
+    result("good frame taken", (frame_open(&r, good, sizeof(good)) == ERROR_OK)
+           && (r.len == 9) && well_read(good, sizeof(good)));
+    result("end of records",
+           (frame_next(&r, &rec) == ERROR_OK) && (frame_next(&r, &rec) == ERROR_OK)
+           && (rec.type == FRAME_END) && (frame_next(&r, &rec) == ERROR_NOBUFS));
+    result("short payload rejected", frame_open(&r, good, FRAME_HDR_LEN - 1) == ERROR_RANGE);
+    result("header alone taken", (frame_open(&r, good, FRAME_HDR_LEN) == ERROR_OK)
+           && (frame_next(&r, &rec) == ERROR_NOBUFS));
+    memcpy(buf, good, sizeof(good));
+    buf[0] = (FRAME_VERSION + 1) << 4;
+    result("other version rejected", frame_open(&r, buf, sizeof(good)) == ERROR_RANGE);
+    for (len = FRAME_HDR_LEN + 1; len < 9; len++) {
+        if (len != 7) {     // Cut between the records, a good frame.
+            ok &= (frame_open(&r, good, len) == ERROR_RANGE);
+        }
+    }
+    result("truncated records rejected", ok);
+
+    // Random payloads with a good version byte, then bit flips and cuts of the good frame.
+    ok = 1;
+    for (n = 0; n < FUZZ; n++) {
+        len = (uint8_t)(rnd() % (MAX_LEN + 1));
+        for (k = 0; k < len; k++) {
+            buf[k] = (uint8_t) rnd();
+            if ((k > 0) && (rnd() % 4 == 0)) {
+                buf[k] = (uint8_t)(rnd() % 8);  // Short lengths, so some frames are taken.
+            }
+        }
+        if (len) {
+            buf[0] = FRAME_VERSION << 4;
+        }
+        taken += (frame_open(&r, buf, len) == ERROR_OK);
+        ok &= well_read(buf, len);
+    }
+    for (n = 0; n < 8 * sizeof(good); n++) {
+        memcpy(buf, good, sizeof(good));
+        buf[n / 8] ^= 1u << (n % 8);
+        for (len = 0; len <= sizeof(good); len++) {
+            ok &= well_read(buf, len);
+        }
+    }
+    result("fuzzed frames read inside payload", ok);
+    printf("  %u of %u random payloads taken\n", taken, FUZZ);
+}
+
+static void sizes(void)
+{
+    static const uint8_t counts[] = {1, 4, 16, 40};
+    unsigned n, raw, each, one;
+    uint8_t k;
+
+    printf("values   raw a packet   frame a packet   one frame   bytes on air\n");
+    for (k = 0; k < sizeof(counts); k++) {
+        n = counts[k];
+        raw = n * (RADIO_OVERHEAD + 1u);
+        each = n * (RADIO_OVERHEAD + FRAME_DATA_LEN);
+        one = RADIO_OVERHEAD + FRAME_HDR_LEN + FRAME_REC_LEN(n);
+        printf("%6u %14u %16u %11u\n", n, raw, each, one);
+    }
+}
+
+int main(void)
+{
+    PM5CTL0 &= ~(LOCKLPM5);
+    WDTCTL = WDTPW | WDTHOLD;
+
+    printf("Frames, version %u\n", FRAME_VERSION);
+    round_trips();
+    encoder();
+    decoder();
+    sizes();
+    printf("%s\n", fails ? "FAIL" : "PASS");
+
+    fflush(stdout);
+    return 0;
+}
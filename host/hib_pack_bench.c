@@ -0,0 +1,142 @@
+/*
+ * Benchmark of the Hibernus RAM image compression, by P. Krawiec.
+ *
+ * Runs Pack_RAM() and Unpack_RAM() (Proj_library/hibernus/hibernation_pack.c, built against
+ * include/msp430.h) over RAM images and compares them with the plain copy of Save_RAM() and
+ * Restore_RAM(). Cycle counts are the SIM_CYCLES() estimates in the firmware, the same ones
+ * the power simulator charges, so they include the compression work.
+ *
+ * An image is a raw dump of RAM, 0x1C00-0x2BFF (4096 bytes), saved from the CCS Memory
+ * Browser while the application is running. --synthetic adds three generated images:
+ *   sparse  .bss and 160 bytes of stack in use, the rest of RAM zero;
+ *   noise   the same, but unused RAM holds power-up noise (it is not cleared at reset);
+ *   full    every byte random, the worst case.
+ *
+ * Usage: hib_pack_bench [--synthetic] [dump.bin ...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <Proj_library/hibernus/hibernation_5994.h>
+
+#define RAW_CYCLES  ((RAM_SIZE / 4) * 16u)  ///< Save_RAM()/Restore_RAM() copy, 16 per word.
+#define BSS_SIZE    64u
+#define STACK_SIZE  160u
+
+uint8_t sim_mem[SIM_MEM_SIZE];
+hib_image_t hib_image;
+
+static unsigned long cycles;
+static uint32_t seed = 1;
+
+void sim_cycles(uint32_t n)
+{
+    cycles += n;
+}
+
+static uint8_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return (uint8_t)(seed >> 16);
+}
+
+// Used RAM: mostly non-zero bytes, with the odd zero as in real variables and frames.
+static void fill_used(uint8_t *ram, unsigned from, unsigned len)
+{
+    unsigned k;
+
+    for (k = from; k < from + len; k++) {
+        ram[k] = (rnd() < 64) ? 0 : rnd();
+    }
+}
+
+static void synthesize(const char *name, uint8_t *ram)
+{
+    unsigned k;
+
+    memset(ram, 0, RAM_SIZE);
+    if (!strcmp(name, "full")) {
+        for (k = 0; k < RAM_SIZE; k++) {
+            ram[k] = rnd();
+        }
+        return;
+    }
+    if (!strcmp(name, "noise")) {
+        for (k = 0; k < RAM_SIZE; k++) {
+            ram[k] = rnd();
+        }
+    }
+    fill_used(ram, 0, BSS_SIZE);
+    fill_used(ram, RAM_SIZE - STACK_SIZE, STACK_SIZE);
+}
+
+static int bench(const char *name, const uint8_t *image)
+{
+    uint8_t *ram = &sim_mem[RAM_START];
+    unsigned long pack, unpack;
+    uint16_t size;
+
+    memcpy(ram, image, RAM_SIZE);
+    cycles = 0;
+    size = Pack_RAM();
+    pack = cycles;
+
+    memset(ram, 0xA5, RAM_SIZE);
+    cycles = 0;
+    Unpack_RAM();
+    unpack = cycles;
+
+    if (memcmp(ram, image, RAM_SIZE)) {
+        fprintf(stderr, "%s: unpacked RAM differs from the original\n", name);
+        return 1;
+    }
+    printf("%-16s %6u %6.2f %8lu %8lu %+7.1f%% %8lu %8lu %+7.1f%%\n", name, size,
+           (double) RAM_SIZE / size, (unsigned long) RAW_CYCLES, pack,
+           100.0 * ((double) pack - RAW_CYCLES) / RAW_CYCLES, (unsigned long) RAW_CYCLES,
+           unpack, 100.0 * ((double) unpack - RAW_CYCLES) / RAW_CYCLES);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static const char *synthetic[] = {"sparse", "noise", "full"};
+    static uint8_t image[RAM_SIZE];
+    int k, fail = 0;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s [--synthetic] [dump.bin ...]\n", argv[0]);
+        return 2;
+    }
+
+    printf("%-16s %6s %6s %8s %8s %8s %8s %8s %8s\n", "image", "bytes", "ratio",
+           "save raw", "packed", "change", "rest raw", "unpack", "change");
+    for (k = 1; k < argc; k++) {
+        if (!strcmp(argv[k], "--synthetic")) {
+            unsigned s;
+
+            for (s = 0; s < sizeof(synthetic) / sizeof(*synthetic); s++) {
+                synthesize(synthetic[s], image);
+                fail |= bench(synthetic[s], image);
+            }
+        }
+        else {
+            FILE *f = fopen(argv[k], "rb");
+
+            if (!f) {
+                perror(argv[k]);
+                return 1;
+            }
+            if (fread(image, 1, RAM_SIZE, f) != RAM_SIZE) {
+                fprintf(stderr, "%s: expected a %u byte dump of RAM\n", argv[k], RAM_SIZE);
+                fclose(f);
+                return 1;
+            }
+            fclose(f);
+            fail |= bench(argv[k], image);
+        }
+    }
+    printf("\nCycles are modelled MCLK cycles. Hibernate() also saves 514 peripheral registers, about "
+           "%u cycles.\n", 514u * 20u);
+    return fail;
+}
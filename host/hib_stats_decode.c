@@ -0,0 +1,133 @@
+/*
+ * Decoder for Hibernus instrumentation dumps, by P. Krawiec.
+ *
+ * Reads a raw little-endian dump of hib_stats (see Proj_library/hibernus/hibernation_stats.h)
+ * saved from the CCS Memory Browser and prints the counters, per-phase latencies and
+ * histograms. Fields are read byte by byte, so the host's struct layout does not matter.
+ *
+ * Usage: hib_stats_decode <dump.bin>
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HIB_STATS_MAGIC     0x4853
+#define HIB_STATS_VERSION   1u
+#define HIB_STATS_BINS      16u
+#define HIB_PHASES          5u
+
+static const char *phase_names[HIB_PHASES] = {
+    "Hibernate", "Save_RAM", "Save_GPR", "Restore", "Restore_GPR"
+};
+
+static const uint8_t *rd;
+static const uint8_t *rd_end;
+
+static uint16_t get16(void)
+{
+    uint16_t v;
+
+    if (rd + 2 > rd_end) {
+        fprintf(stderr, "hib_stats_decode: dump too short\n");
+        exit(1);
+    }
+    v = (uint16_t)(rd[0] | (rd[1] << 8));
+    rd += 2;
+    return v;
+}
+
+static uint32_t get32(void)
+{
+    uint32_t lo = get16();
+    return lo | ((uint32_t) get16() << 16);
+}
+
+int main(int argc, char **argv)
+{
+    static uint8_t buf[4096];
+    uint16_t last[HIB_PHASES], max[HIB_PHASES], hist[HIB_PHASES][HIB_STATS_BINS];
+    uint16_t magic, version, tick_khz, restoring;
+    uint32_t boots, hibernations, restores, failures, invalid;
+    unsigned p, b;
+    size_t n;
+    FILE *f;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <dump.bin>\n", argv[0]);
+        return 2;
+    }
+    f = fopen(argv[1], "rb");
+    if (!f) {
+        perror(argv[1]);
+        return 1;
+    }
+    n = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+    rd = buf;
+    rd_end = buf + n;
+
+    magic = get16();
+    version = get16();
+    if (magic != HIB_STATS_MAGIC) {
+        fprintf(stderr, "hib_stats_decode: bad magic 0x%04x, not a hib_stats dump\n", magic);
+        return 1;
+    }
+    if (version != HIB_STATS_VERSION) {
+        fprintf(stderr, "hib_stats_decode: layout version %u, expected %u\n", version,
+                HIB_STATS_VERSION);
+        return 1;
+    }
+    tick_khz = get16();
+    restoring = get16();
+    boots = get32();
+    hibernations = get32();
+    restores = get32();
+    failures = get32();
+    invalid = get32();
+    for (p = 0; p < HIB_PHASES; p++) {
+        last[p] = get16();
+    }
+    for (p = 0; p < HIB_PHASES; p++) {
+        max[p] = get16();
+    }
+    for (p = 0; p < HIB_PHASES; p++) {
+        for (b = 0; b < HIB_STATS_BINS; b++) {
+            hist[p][b] = get16();
+        }
+    }
+    if (tick_khz == 0) {
+        tick_khz = 1000;
+    }
+
+    printf("boots              %lu\n", (unsigned long) boots);
+    printf("hibernations       %lu\n", (unsigned long) hibernations);
+    printf("restores           %lu\n", (unsigned long) restores);
+    printf("restore failures   %lu\n", (unsigned long) failures);
+    printf("invalid images     %lu\n", (unsigned long) invalid);
+    if (restoring) {
+        printf("(dump taken with a restore in flight)\n");
+    }
+
+    printf("\n%-12s %12s %12s\n", "phase", "last [us]", "max [us]");
+    for (p = 0; p < HIB_PHASES; p++) {
+        printf("%-12s %12.1f %12.1f\n", phase_names[p], last[p] * 1000.0 / tick_khz,
+               max[p] * 1000.0 / tick_khz);
+    }
+
+    for (p = 0; p < HIB_PHASES; p++) {
+        printf("\n%s latency histogram\n", phase_names[p]);
+        if (!max[p] && !hist[p][0]) {
+            printf("  (no samples)\n");
+            continue;
+        }
+        for (b = 0; b < HIB_STATS_BINS; b++) {
+            if (hist[p][b]) {
+                printf("  [%8.0f, %8.0f) us  %5u%s\n", (b ? (1u << b) : 0) * 1000.0 / tick_khz,
+                       (2u << b) * 1000.0 / tick_khz, hist[p][b],
+                       hist[p][b] == 0xFFFF ? " (saturated)" : "");
+            }
+        }
+    }
+    return 0;
+}
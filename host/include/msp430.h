@@ -0,0 +1,556 @@
+/*
+ * Host stand-in for the TI <msp430.h> device header, by P. Krawiec.
+ *
+ * Used by the Linux build in host/ to compile Proj_library and the Tx/Rx applications
+ * unchanged. Every peripheral register expands to a call into the simulator (host/sim),
+ * which charges the access, advances simulated time, dispatches due interrupts and
+ * applies the register's side effects. Only the registers and bits the firmware uses
+ * are defined; add more here as the library grows.
+ *
+ * The memory map follows the MSP430FR5994 (SLASE54): peripherals below 0x1000, RAM at
+ * 0x1C00, FRAM from 0x4000. All of it lives in sim_mem[], FRAM is shared between power
+ * cycles.
+ */
+
+#ifndef SIM_MSP430_H
+#define SIM_MSP430_H
+
+#include <stdint.h>
+
+#define T1_HOST 1   ///< Building for the host simulator.
+
+//***** Simulator hooks *******************************************************************
+
+#define SIM_MEM_SIZE    0x44000     ///< Up to the end of FRAM2.
+
+extern uint8_t sim_mem[SIM_MEM_SIZE];
+
+void *sim_reg(uint16_t addr);
+void *sim_reg8(uint16_t addr);
+void sim_cycles(uint32_t n);
+void sim_bis_sr(uint16_t bits);
+void sim_bic_sr(uint16_t bits);
+void sim_bis_sr_on_exit(uint16_t bits);
+void sim_bic_sr_on_exit(uint16_t bits);
+uint16_t sim_get_sr(void);
+void sim_phase(int phase);
+int sim_snapshot(int slot);
+void sim_resume(int slot);
+void sim_commit(void);
+void sim_rollback(void);
+void sim_restart(void);
+void sim_mark(const char *stage);
+void sim_write_addr(uint16_t reg, uintptr_t addr);
+
+/* The firmware's variables and stack live in host memory, not in sim_mem's RAM. Code that
+ * sizes the RAM in use (Hibernus deltas) takes these instead [bytes]. */
+#define SIM_RAM_USED    0x0040      ///< .bss/.data of the applications.
+#define SIM_STACK_USED  0x0100      ///< Stack depth at a checkpoint.
+#define SIM_RAMFUNC_USED 0x0180     ///< RAM taken by the RAMFUNC hot paths (T1_RAMFUNC).
+
+/** @brief Map a device address to its host backing store. */
+#define SIM_ADDR(a)     ((void *) &sim_mem[(a)])
+
+/** @brief Place a variable in FRAM that is kept across simulated power cycles. */
+#define SIM_FRAM        __attribute__((section("sim_fram")))
+
+/** @brief Code run from RAM (RAMFUNC): register accesses and SIM_CYCLES() made from it are
+ *  charged without FRAM wait states, see sim/sim_cpu.c. */
+#define SIM_RAMFUNC     __attribute__((section("sim_ramfunc"), noinline))
+
+/** @brief Charge MCLK cycles for work the simulator cannot see (plain memory loops). */
+#define SIM_CYCLES(n)   sim_cycles(n)
+
+/** @brief Mark the start of a phase for the time accounting (SIM_PHASE_*). */
+#define SIM_PHASE(p)    sim_phase(p)
+
+#define SIM_SLOTS       3           ///< Snapshot slots: 0 full image, 1-2 Hibernus deltas.
+
+/** @brief Hibernus snapshot point, returns in the saved image after a restore. */
+#define SIM_SNAPSHOT(slot)  sim_snapshot(slot)
+
+/** @brief Hand over to a saved image, returns only if there is none. */
+#define SIM_RESUME(slot)    sim_resume(slot)
+
+/** @brief Progress committed to FRAM (task runtime), counts as a checkpoint. */
+#define SIM_COMMIT()    sim_commit()
+
+/** @brief Execution restarts from the last commit, the work since is re-executed. */
+#define SIM_ROLLBACK()  sim_rollback()
+
+/** @brief Nothing to resume, the application starts over and everything it did is re-executed. */
+#define SIM_RESTART()   sim_restart()
+
+/** @brief The wake-up has reached a stage, for the latency report (first time per power-up). */
+#define SIM_MARK(stage) sim_mark(stage)
+
+enum {
+    SIM_PHASE_APP = 0,      ///< Application code (the default).
+    SIM_PHASE_CHECKPOINT,   ///< Inside Hibernate(), or a task commit.
+    SIM_PHASE_RESTORE,      ///< Inside Restore() until the image resumes, or loading task state.
+    SIM_PHASE_HALTED,       ///< main() has returned, the CPU spins until power is lost.
+    SIM_PHASES
+};
+
+#define SIM_REG8(a)     (*(volatile uint8_t *) sim_reg8(a))
+#define SIM_REG16(a)    (*(volatile uint16_t *) sim_reg(a))
+
+//***** Intrinsics ************************************************************************
+
+#define __interrupt
+#define __no_operation()                sim_cycles(1)
+#define __delay_cycles(n)               sim_cycles((uint32_t)(n))
+#define __even_in_range(x, y)           (x)
+#define __bis_SR_register(x)            sim_bis_sr(x)
+#define __bic_SR_register(x)            sim_bic_sr(x)
+#define __bis_SR_register_on_exit(x)    sim_bis_sr_on_exit(x)
+#define __bic_SR_register_on_exit(x)    sim_bic_sr_on_exit(x)
+#define __get_SR_register()             sim_get_sr()
+#define __enable_interrupt()            sim_bis_sr(GIE)
+#define __disable_interrupt()           sim_bic_sr(GIE)
+
+/* 20-bit address registers (DMAxSA/DA). The address may be of a host variable, the simulator
+ * keeps it as a host pointer. sim_mem is 64kB-aligned, so (unsigned short) &REG is the
+ * register's device address as on the target. */
+#define __data16_write_addr(reg, addr)  sim_write_addr((uint16_t)(reg), (uintptr_t)(addr))
+
+//***** Bits ******************************************************************************
+
+#define BIT0    (0x0001)
+#define BIT1    (0x0002)
+#define BIT2    (0x0004)
+#define BIT3    (0x0008)
+#define BIT4    (0x0010)
+#define BIT5    (0x0020)
+#define BIT6    (0x0040)
+#define BIT7    (0x0080)
+#define BIT8    (0x0100)
+#define BIT9    (0x0200)
+#define BITA    (0x0400)
+#define BITB    (0x0800)
+#define BITC    (0x1000)
+#define BITD    (0x2000)
+#define BITE    (0x4000)
+#define BITF    (0x8000)
+
+// Status register.
+#define GIE         (0x0008)
+#define CPUOFF      (0x0010)
+#define OSCOFF      (0x0020)
+#define SCG0        (0x0040)
+#define SCG1        (0x0080)
+#define LPM0_bits   (CPUOFF)
+#define LPM1_bits   (SCG0 + CPUOFF)
+#define LPM2_bits   (SCG1 + CPUOFF)
+#define LPM3_bits   (SCG1 + SCG0 + CPUOFF)
+#define LPM4_bits   (SCG1 + SCG0 + OSCOFF + CPUOFF)
+
+//***** Memory map ************************************************************************
+
+#define RAM_START   0x1C00
+
+//***** SFR, PMM, FRAM controller, watchdog ***********************************************
+
+#define SFRIE1      SIM_REG16(0x0100)
+#define SFRIFG1     SIM_REG16(0x0102)
+#define SFRRPCR     SIM_REG16(0x0104)
+
+#define PMMCTL0     SIM_REG16(0x0120)
+#define PMMCTL0_L   SIM_REG8(0x0120)
+#define PMMCTL0_H   SIM_REG8(0x0121)
+#define PM5CTL0     SIM_REG16(0x0130)
+
+#define PMMSWBOR    (0x0004)
+#define PMMSWPOR    (0x0008)
+#define PMMREGOFF   (0x0010)
+#define SVSHE       (0x0040)
+#define LOCKLPM5    (0x0001)
+
+#define FRCTL0      SIM_REG16(0x0140)
+#define FRCTL0_L    SIM_REG8(0x0140)
+#define FRCTL0_H    SIM_REG8(0x0141)
+
+#define FRCTLPW     (0xA500)
+#define NWAITS      (0x0070)
+#define NWAITS_0    (0x0000)
+#define NWAITS_1    (0x0010)
+#define NWAITS_2    (0x0020)
+
+#define WDTCTL      SIM_REG16(0x015C)
+#define WDTPW       (0x5A00)
+#define WDTHOLD     (0x0080)
+
+//***** Clock system **********************************************************************
+
+#define CSCTL0      SIM_REG16(0x0160)
+#define CSCTL0_H    SIM_REG8(0x0161)
+#define CSCTL1      SIM_REG16(0x0162)
+#define CSCTL2      SIM_REG16(0x0164)
+#define CSCTL3      SIM_REG16(0x0166)
+#define CSCTL4      SIM_REG16(0x0168)
+#define CSCTL5      SIM_REG16(0x016A)
+#define CSCTL6      SIM_REG16(0x016C)
+
+#define CSKEY_H     (0xA5)
+#define DCORSEL     (0x0040)
+#define DCOFSEL     (0x000E)
+#define DCOFSEL_0   (0x0000)
+#define DCOFSEL_1   (0x0002)
+#define DCOFSEL_2   (0x0004)
+#define DCOFSEL_3   (0x0006)
+#define DCOFSEL_4   (0x0008)
+#define DCOFSEL_5   (0x000A)
+#define DCOFSEL_6   (0x000C)
+
+#define SELM        (0x0007)
+#define SELS        (0x0070)
+#define SELA        (0x0700)
+#define SELM_0      (0x0000)
+#define SELM_1      (0x0001)
+#define SELM_3      (0x0003)
+#define SELS_0      (0x0000)
+#define SELS_1      (0x0010)
+#define SELS_3      (0x0030)
+#define SELA_0      (0x0000)
+#define SELA_1      (0x0100)
+#define SELA_2      (0x0200)
+
+#define DIVM        (0x0007)
+#define DIVS        (0x0070)
+#define DIVA        (0x0700)
+#define DIVM_0      (0x0000)
+#define DIVM_1      (0x0001)
+#define DIVM_2      (0x0002)
+#define DIVM_3      (0x0003)
+#define DIVM_4      (0x0004)
+#define DIVM_5      (0x0005)
+#define DIVS_0      (0x0000)
+#define DIVS_1      (0x0010)
+#define DIVS_2      (0x0020)
+#define DIVS_3      (0x0030)
+#define DIVS_4      (0x0040)
+#define DIVS_5      (0x0050)
+#define DIVA_0      (0x0000)
+
+#define LFXTOFF     (0x0001)
+#define HFXTOFF     (0x0100)
+#define LFXTOFF_1   (0x0001)
+#define HFXTOFF_1   (0x0100)
+
+//***** Digital I/O ***********************************************************************
+
+#define P1IN        SIM_REG8(0x0200)
+#define P2IN        SIM_REG8(0x0201)
+#define P1OUT       SIM_REG8(0x0202)
+#define P2OUT       SIM_REG8(0x0203)
+#define P1DIR       SIM_REG8(0x0204)
+#define P2DIR       SIM_REG8(0x0205)
+#define P1REN       SIM_REG8(0x0206)
+#define P2REN       SIM_REG8(0x0207)
+#define P1SEL0      SIM_REG8(0x020A)
+#define P2SEL0      SIM_REG8(0x020B)
+#define P1SEL1      SIM_REG8(0x020C)
+#define P2SEL1      SIM_REG8(0x020D)
+#define P1IV        SIM_REG16(0x020E)
+#define P1IES       SIM_REG8(0x0218)
+#define P2IES       SIM_REG8(0x0219)
+#define P1IE        SIM_REG8(0x021A)
+#define P2IE        SIM_REG8(0x021B)
+#define P1IFG       SIM_REG8(0x021C)
+#define P2IFG       SIM_REG8(0x021D)
+#define P2IV        SIM_REG16(0x021E)
+
+#define P3IN        SIM_REG8(0x0220)
+#define P4IN        SIM_REG8(0x0221)
+#define P3OUT       SIM_REG8(0x0222)
+#define P4OUT       SIM_REG8(0x0223)
+#define P3DIR       SIM_REG8(0x0224)
+#define P4DIR       SIM_REG8(0x0225)
+#define P3REN       SIM_REG8(0x0226)
+#define P4REN       SIM_REG8(0x0227)
+#define P3SEL0      SIM_REG8(0x022A)
+#define P4SEL0      SIM_REG8(0x022B)
+#define P3SEL1      SIM_REG8(0x022C)
+#define P4SEL1      SIM_REG8(0x022D)
+#define P3IV        SIM_REG16(0x022E)
+#define P3IES       SIM_REG8(0x0238)
+#define P4IES       SIM_REG8(0x0239)
+#define P3IE        SIM_REG8(0x023A)
+#define P4IE        SIM_REG8(0x023B)
+#define P3IFG       SIM_REG8(0x023C)
+#define P4IFG       SIM_REG8(0x023D)
+#define P4IV        SIM_REG16(0x023E)
+
+#define P5IN        SIM_REG8(0x0240)
+#define P6IN        SIM_REG8(0x0241)
+#define P5OUT       SIM_REG8(0x0242)
+#define P6OUT       SIM_REG8(0x0243)
+#define P5DIR       SIM_REG8(0x0244)
+#define P6DIR       SIM_REG8(0x0245)
+#define P5REN       SIM_REG8(0x0246)
+#define P6REN       SIM_REG8(0x0247)
+#define P5SEL0      SIM_REG8(0x024A)
+#define P6SEL0      SIM_REG8(0x024B)
+#define P5SEL1      SIM_REG8(0x024C)
+#define P6SEL1      SIM_REG8(0x024D)
+
+#define P7IN        SIM_REG8(0x0260)
+#define P8IN        SIM_REG8(0x0261)
+#define P7OUT       SIM_REG8(0x0262)
+#define P8OUT       SIM_REG8(0x0263)
+#define P7DIR       SIM_REG8(0x0264)
+#define P8DIR       SIM_REG8(0x0265)
+#define P7REN       SIM_REG8(0x0266)
+#define P8REN       SIM_REG8(0x0267)
+
+#define P1IV_P1IFG1 (0x0004)
+#define P3IV_P3IFG5 (0x000C)
+#define P3IV_P3IFG7 (0x0010)
+#define P4IV_NONE   (0x0000)
+#define P4IV_P4IFG0 (0x0002)
+#define P4IV_P4IFG1 (0x0004)
+
+//***** Timers ****************************************************************************
+
+#define TA0CTL      SIM_REG16(0x0340)
+#define TA0CCTL0    SIM_REG16(0x0342)
+#define TA0CCTL1    SIM_REG16(0x0344)
+#define TA0CCTL2    SIM_REG16(0x0346)
+#define TA0R        SIM_REG16(0x0350)
+#define TA0CCR0     SIM_REG16(0x0352)
+#define TA0CCR1     SIM_REG16(0x0354)
+#define TA0CCR2     SIM_REG16(0x0356)
+#define TA0EX0      SIM_REG16(0x0360)
+#define TA0IV       SIM_REG16(0x036E)
+
+#define TA1CTL      SIM_REG16(0x0380)
+#define TA1CCTL0    SIM_REG16(0x0382)
+#define TA1CCTL1    SIM_REG16(0x0384)
+#define TA1CCTL2    SIM_REG16(0x0386)
+#define TA1R        SIM_REG16(0x0390)
+#define TA1CCR0     SIM_REG16(0x0392)
+#define TA1CCR1     SIM_REG16(0x0394)
+#define TA1CCR2     SIM_REG16(0x0396)
+#define TA1EX0      SIM_REG16(0x03A0)
+#define TA1IV       SIM_REG16(0x03AE)
+
+#define TA2CTL      SIM_REG16(0x0400)
+#define TA2CCTL0    SIM_REG16(0x0402)
+#define TA2CCTL1    SIM_REG16(0x0404)
+#define TA2R        SIM_REG16(0x0410)
+#define TA2CCR0     SIM_REG16(0x0412)
+#define TA2CCR1     SIM_REG16(0x0414)
+#define TA2EX0      SIM_REG16(0x0420)
+#define TA2IV       SIM_REG16(0x042E)
+
+#define TB0CTL      SIM_REG16(0x03C0)
+#define TB0CCTL0    SIM_REG16(0x03C2)
+#define TB0CCTL1    SIM_REG16(0x03C4)
+#define TB0CCTL2    SIM_REG16(0x03C6)
+#define TB0R        SIM_REG16(0x03D0)
+#define TB0CCR0     SIM_REG16(0x03D2)
+#define TB0CCR1     SIM_REG16(0x03D4)
+#define TB0CCR2     SIM_REG16(0x03D6)
+#define TB0EX0      SIM_REG16(0x03E0)
+#define TB0IV       SIM_REG16(0x03EE)
+
+#define TASSEL__TACLK   (0x0000)
+#define TASSEL__ACLK    (0x0100)
+#define TASSEL__SMCLK   (0x0200)
+#define TBSSEL__ACLK    (0x0100)
+#define TBSSEL__SMCLK   (0x0200)
+#define ID__1           (0x0000)
+#define ID__2           (0x0040)
+#define ID__4           (0x0080)
+#define ID__8           (0x00C0)
+#define MC_0            (0x0000)
+#define MC_1            (0x0010)
+#define MC_2            (0x0020)
+#define MC_3            (0x0030)
+#define MC__STOP        (0x0000)
+#define MC__UP          (0x0010)
+#define MC__CONTINUOUS  (0x0020)
+#define MC__UPDOWN      (0x0030)
+#define TACLR           (0x0004)
+#define TAIE            (0x0002)
+#define TAIFG           (0x0001)
+#define TBCLR           (0x0004)
+#define TBIE            (0x0002)
+#define TBIFG           (0x0001)
+#define TAIDEX_7        (0x0007)
+#define CCIE            (0x0010)
+#define CCIFG           (0x0001)
+
+#define TA0IV_TACCR1    (0x0002)
+#define TA0IV_TACCR2    (0x0004)
+#define TA0IV_TAIFG     (0x000E)
+#define TB0IV_TBIFG     (0x000E)
+
+//***** eUSCI_B1 (SPI) ********************************************************************
+
+#define UCB1CTLW0   SIM_REG16(0x0680)
+#define UCB1CTLW0_L SIM_REG8(0x0680)
+#define UCB1BRW     SIM_REG16(0x0686)
+#define UCB1STATW   SIM_REG16(0x0688)
+#define UCB1RXBUF   SIM_REG16(0x068C)
+#define UCB1TXBUF   SIM_REG16(0x068E)
+#define UCB1IE      SIM_REG16(0x06AA)
+#define UCB1IFG     SIM_REG16(0x06AC)
+#define UCB1IV      SIM_REG16(0x06AE)
+
+#define UCSWRST     (0x0001)
+#define UCSTEM      (0x0002)
+#define UCSSEL_1    (0x0040)
+#define UCSSEL_2    (0x0080)
+#define UCSSEL__SMCLK (0x0080)
+#define UCSYNC      (0x0100)
+#define UCMODE0     (0x0200)
+#define UCMODE1     (0x0400)
+#define UCMST       (0x0800)
+#define UC7BIT      (0x1000)
+#define UCMSB       (0x2000)
+#define UCCKPL      (0x4000)
+#define UCCKPH      (0x8000)
+#define UCBUSY      (0x0001)
+#define UCRXIFG0    (0x0001)
+#define UCTXIFG0    (0x0002)
+#define UCRXIFG     (0x0001)
+#define UCTXIFG     (0x0002)
+
+//***** eUSCI_A0 (UART) ******************************************************************
+
+#define UCA0CTLW0   SIM_REG16(0x05C0)
+#define UCA0BRW     SIM_REG16(0x05C6)
+#define UCA0MCTLW   SIM_REG16(0x05C8)
+#define UCA0STATW   SIM_REG16(0x05CA)
+#define UCA0RXBUF   SIM_REG16(0x05CC)
+#define UCA0TXBUF   SIM_REG16(0x05CE)
+#define UCA0IE      SIM_REG16(0x05DA)
+#define UCA0IFG     SIM_REG16(0x05DC)
+#define UCA0IV      SIM_REG16(0x05DE)
+
+#define UCOS16      (0x0001)
+#define UCBRS0      (0x0100)
+
+//***** DMA *******************************************************************************
+
+#define DMACTL0     SIM_REG16(0x0500)
+#define DMACTL1     SIM_REG16(0x0502)
+#define DMACTL4     SIM_REG16(0x0508)
+#define DMAIV       SIM_REG16(0x050E)
+#define DMA0CTL     SIM_REG16(0x0510)
+#define DMA0SA      SIM_REG16(0x0512)
+#define DMA0DA      SIM_REG16(0x0516)
+#define DMA0SZ      SIM_REG16(0x051A)
+#define DMA1CTL     SIM_REG16(0x0520)
+#define DMA1SA      SIM_REG16(0x0522)
+#define DMA1DA      SIM_REG16(0x0526)
+#define DMA1SZ      SIM_REG16(0x052A)
+#define DMA2CTL     SIM_REG16(0x0530)
+#define DMA2SA      SIM_REG16(0x0532)
+#define DMA2DA      SIM_REG16(0x0536)
+#define DMA2SZ      SIM_REG16(0x053A)
+
+#define DMA0TSEL    (0x001F)
+#define DMA0TSEL__UCA0TXIFG (0x000F)
+#define DMA1TSEL    (0x1F00)
+#define DMA1TSEL_12 (0x0C00)    ///< AES trigger 1.
+#define DMA2TSEL    (0x001F)    ///< In DMACTL1.
+#define DMA2TSEL_11 (0x000B)    ///< AES trigger 0.
+#define DMARMWDIS   (0x0004)
+#define DMAREQ      (0x0001)
+#define DMAABORT    (0x0002)
+#define DMAIE       (0x0004)
+#define DMAIFG      (0x0008)
+#define DMAEN       (0x0010)
+#define DMALEVEL    (0x0020)
+#define DMASRCBYTE  (0x0040)
+#define DMADSTBYTE  (0x0080)
+#define DMASRCINCR_3 (0x0300)
+#define DMADSTINCR_3 (0x0C00)
+#define DMADT_0     (0x0000)
+#define DMADT_4     (0x4000)
+#define DMAIV_NONE  (0x0000)
+#define DMAIV_DMA0IFG (0x0002)
+#define DMAIV_DMA1IFG (0x0004)
+#define DMAIV_DMA2IFG (0x0006)
+
+//***** AES256 ****************************************************************************
+
+#define AESACTL0    SIM_REG16(0x09C0)
+#define AESACTL1    SIM_REG16(0x09C2)
+#define AESASTAT    SIM_REG16(0x09C4)
+#define AESAKEY     SIM_REG16(0x09C6)
+#define AESADIN     SIM_REG16(0x09C8)
+#define AESADOUT    SIM_REG16(0x09CA)
+#define AESAXDIN    SIM_REG16(0x09CC)
+#define AESAXIN     SIM_REG16(0x09CE)
+
+#define AESOP       (0x0003)
+#define AESKL       (0x000C)
+#define AESKL_2     (0x0008)
+#define AESCM       (0x0060)
+#define AESCM_0     (0x0000)
+#define AESCM_1     (0x0020)
+#define AESCM_2     (0x0040)
+#define AESSWRST    (0x0080)
+#define AESRDYIFG   (0x0100)
+#define AESERRFG    (0x0800)
+#define AESCMEN     (0x8000)
+#define AESBLKCNT   (0x00FF)
+#define AESBUSY     (0x0001)
+#define AESKEYWR    (0x0002)
+
+//***** CRC16, CRC32 **********************************************************************
+
+#define CRCDI       SIM_REG16(0x0150)
+#define CRCDI_L     SIM_REG8(0x0150)
+#define CRCDIRB     SIM_REG16(0x0152)
+#define CRCDIRB_L   SIM_REG8(0x0152)
+#define CRCINIRES   SIM_REG16(0x0154)
+#define CRCRESR     SIM_REG16(0x0156)
+
+#define CRC32DIW0       SIM_REG16(0x0980)
+#define CRC32DIW0_L     SIM_REG8(0x0980)
+#define CRC32INIRESW0   SIM_REG16(0x0988)
+#define CRC32INIRESW1   SIM_REG16(0x098A)
+
+//***** REF_A, ADC12_B ********************************************************************
+
+#define REFCTL0     SIM_REG16(0x01B0)
+
+#define REFON       (0x0001)
+#define REFVSEL_0   (0x0000)
+#define REFVSEL_1   (0x0010)
+#define REFVSEL_2   (0x0020)
+#define REFGENRDY   (0x1000)
+
+#define ADC12CTL0   SIM_REG16(0x0800)
+#define ADC12CTL1   SIM_REG16(0x0802)
+#define ADC12CTL2   SIM_REG16(0x0804)
+#define ADC12CTL3   SIM_REG16(0x0806)
+#define ADC12IFGR0  SIM_REG16(0x080C)
+#define ADC12IER0   SIM_REG16(0x0812)
+#define ADC12MCTL0  SIM_REG16(0x0820)
+#define ADC12MEM0   SIM_REG16(0x0860)
+
+#define ADC12SC     (0x0001)
+#define ADC12ENC    (0x0002)
+#define ADC12ON     (0x0010)
+#define ADC12SHT0_2 (0x0200)
+#define ADC12SHT0_3 (0x0300)
+#define ADC12BUSY   (0x0001)
+#define ADC12SHP    (0x0200)
+#define ADC12RES_2  (0x0020)
+#define ADC12BATMAP (0x0040)
+#define ADC12INCH_31 (0x001F)
+#define ADC12VRSEL_1 (0x0100)
+#define ADC12EOS    (0x0080)
+#define ADC12IFG0   (0x0001)
+
+//***** MPU *******************************************************************************
+
+#define MPUCTL0     SIM_REG16(0x05A0)
+#define MPUCTL0_H   SIM_REG8(0x05A1)
+
+#endif // SIM_MSP430_H
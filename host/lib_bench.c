@@ -0,0 +1,147 @@
+/*
+ * MCLK cycles, MCU energy and radio energy of Proj_library calls on the host simulator,
+ * by P. Krawiec.
+ *
+ * An application for the power simulator, linked against the host build of the library
+ * (libt1.a, see 'make lib'). With a steady supply and the 8MHz default clock profile it times
+ * the calls that drive the peripherals: the LEDs, the software timers, clock profile
+ * switches, the VLO calibration, the ADC supply measurement and the Zeta+ commands, each
+ * averaged over up to REPEAT calls. Work that does not touch a register is not charged by
+ * the simulator (see sim/sim_cpu.c), so pure computations are left out. Any clock error the
+ * simulator flags prints "FAIL".
+ *
+ *     ./lib_bench -t traces/steady.txt -d 30
+ */
+
+#include <stdio.h>
+#include <Proj_library/h_files/t1_util.h>
+#include <Proj_library/h_files/t1_spi.h>
+#include <Proj_library/h_files/t1_timer.h>
+#include <Proj_library/h_files/t1_zeta.h>
+#include <Proj_library/h_files/t1_energy.h>
+#include "sim.h"
+
+#define REPEAT          32u
+
+typedef struct {
+    uint64_t t;
+    double e;
+    double radio;
+} mark_t;
+
+static mark_t mark(void)
+{
+    mark_t m = {sim_time, 0.0, sim_sh->radio_energy};
+    int p;
+
+    for (p = 0; p < SIM_PHASES; p++) {
+        m.e += sim_sh->energy[p];
+    }
+    return m;
+}
+
+static void report(const char *call, mark_t from, unsigned n)
+{
+    mark_t to = mark();
+    double s = (double)(to.t - from.t) / SIM_PS_PER_S / n;
+
+    printf("%-26s %10.0f cycles %12.3f us %11.3f nJ %11.3f nJ radio\n", call, s * MCLK_HZ,
+           s * 1e6, (to.e - from.e) * 1e9 / n, (to.radio - from.radio) * 1e9 / n);
+}
+
+static uint8_t never(void)
+{
+    return 0;
+}
+
+int main(void)
+{
+    static uint8_t packet[32];
+    timer_id_t id = TIMER_NONE;
+    uint16_t mv;
+    unsigned n;
+    mark_t m;
+
+    PM5CTL0 &= ~(LOCKLPM5);
+    WDTCTL = WDTPW | WDTHOLD;
+    io_init();
+    clock_init();
+    spi_init();
+    __enable_interrupt();
+
+    m = mark();
+    for (n = 0; n < REPEAT; n++) {
+        led_set((uint8_t) n);
+    }
+    report("led_set", m, REPEAT);
+
+    m = mark();
+    for (n = 0; n < REPEAT; n++) {
+        timer_add(&id, 1000, 0, never);
+        timer_cancel(&id);
+    }
+    report("timer_add + timer_cancel", m, REPEAT);
+
+    m = mark();
+    for (n = 0; n < REPEAT; n++) {
+        clock_set_profile(CLOCK_BURST);
+        clock_set_profile(CLOCK_DEFAULT);
+    }
+    report("clock_set_profile x2", m, REPEAT);
+
+    m = mark();
+    for (n = 0; n < 4; n++) {
+        vlo_calibrate();
+    }
+    report("vlo_calibrate", m, 4);
+
+    m = mark();
+    for (n = 0; n < REPEAT; n++) {
+        supply_mv(&mv);
+    }
+    report("supply_mv", m, REPEAT);
+
+    m = mark();
+    for (n = 0; n < 4; n++) {
+        P3OUT |= SDN;       // Shut down, zeta_init() boots it again.
+        zeta_init();
+    }
+    report("zeta_init", m, 4);
+
+    m = mark();
+    for (n = 0; n < REPEAT; n++) {
+        zeta_select_mode(0x2);
+    }
+    report("zeta_select_mode", m, REPEAT);
+
+    m = mark();
+    for (n = 0; n < REPEAT; n++) {
+        zeta_rx_mode(CHANNEL, 1u);
+    }
+    report("zeta_rx_mode", m, REPEAT);
+
+    m = mark();
+    for (n = 0; n < REPEAT; n++) {
+        zeta_get_rssi();
+    }
+    report("zeta_get_rssi", m, REPEAT);
+
+    zeta_select_mode(0x2);
+    m = mark();
+    for (n = 0; n < REPEAT; n++) {
+        zeta_send_packet(packet, 1u);
+    }
+    report("zeta_send_packet (1 B)", m, REPEAT);
+
+    m = mark();
+    for (n = 0; n < REPEAT; n++) {
+        zeta_send_packet(packet, sizeof(packet));
+    }
+    report("zeta_send_packet (32 B)", m, REPEAT);
+
+    printf("supply %u mV, clock errors: %lu FRAM, %lu SPI  %s\n", mv, sim_sh->fram_errors,
+           sim_sh->spi_errors, (sim_sh->fram_errors || sim_sh->spi_errors) ? "FAIL" : "ok");
+
+    fflush(stdout);
+    return 0;
+}
@@ -0,0 +1,150 @@
+/*
+ * Zeta+ throughput and latency at each RF baud rate on the host simulator, by P. Krawiec.
+ *
+ * An application for the power simulator, built twice: radio_bench_tx sends and
+ * radio_bench_rx (RADIO_BENCH_RX) receives, through an air log. Both power up at the
+ * start of the same steady trace and step through the RF baud rates together, one
+ * WINDOW_MS window each. The transmitter switches baud rate (zeta_set_baud_rf()) at the
+ * start of a window and, from SEND_MS into it, sends PACKET_LEN byte packets back to back
+ * with zeta_send_packet(), each after the air time of the one before. A packet carries
+ * the time it was sent and its number. The receiver polls nIRQ and reads packets with
+ * zeta_rx_packet(), then prints per baud rate the packets received against sent, the
+ * payload throughput and the latency from the call to zeta_send_packet() to the packet
+ * read, all on the simulated clock.
+ *
+ *     ./radio_bench_tx -t traces/steady.txt -d 14 --air-out air.log
+ *     ./radio_bench_rx -t traces/steady.txt -d 14 --air-in air.log --loss 0.1
+ *
+ * Prints "FAIL" for a packet that comes back corrupted, out of its window or out of order.
+ */
+
+#include <stdio.h>
+#include <Proj_library/h_files/t1_util.h>
+#include <Proj_library/h_files/t1_spi.h>
+#include <Proj_library/h_files/t1_zeta.h>
+#include <Proj_library/h_files/t1_energy.h>
+#include "sim.h"
+
+#define PACKET_LEN      32u
+#define START_MS        1000u   ///< First window.
+#define WINDOW_MS       2000u   ///< Per baud rate.
+#define SEND_MS         200u    ///< Into the window, once both radios have restarted.
+#define STOP_MS         1900u   ///< Last send, leaves the air time of a packet at 4800bps.
+#define POLL_CYCLES     80u     ///< 10us at 8MHz.
+
+static const uint32_t bps[7] = {0, 4800, 9600, 38400, 128000, 256000, 500000};
+
+static uint64_t ms_ps(uint32_t ms)
+{
+    return (uint64_t) ms * (SIM_PS_PER_S / 1000);
+}
+
+static void until(uint64_t ps)
+{
+    while (sim_time < ps) {
+        __delay_cycles(POLL_CYCLES);
+    }
+}
+
+#ifndef RADIO_BENCH_RX
+//*************************************************************************************
+static void send_window(uint8_t baud, uint64_t start)
+{
+    static uint8_t packet[PACKET_LEN];
+    uint64_t t, air = (uint64_t) energy_airtime_us(PACKET_LEN, baud) * SIM_PS_PER_US;
+    uint32_t us;
+    uint16_t seq = 0;
+    uint8_t k;
+
+    zeta_set_baud_rf(baud);
+    zeta_select_mode(0x2);
+    for (t = start + ms_ps(SEND_MS); t < start + ms_ps(STOP_MS); t = sim_time + air) {
+        until(t);
+        for (k = 0; k < PACKET_LEN; k++) {
+            packet[k] = (uint8_t)(k * 7u + seq);
+        }
+        packet[0] = baud;
+        packet[1] = (uint8_t)(seq >> 8);
+        packet[2] = (uint8_t) seq;
+        us = (uint32_t)(sim_time / SIM_PS_PER_US);
+        packet[3] = (uint8_t)(us >> 24);
+        packet[4] = (uint8_t)(us >> 16);
+        packet[5] = (uint8_t)(us >> 8);
+        packet[6] = (uint8_t) us;
+        zeta_send_packet(packet, PACKET_LEN);
+        seq++;
+    }
+    printf("baud %u %6lu bps  sent %4u\n", baud, (unsigned long) bps[baud], seq);
+}
+#else
+//*************************************************************************************
+static void receive_window(uint8_t baud, uint64_t start)
+{
+    static uint8_t packet[4 + PACKET_LEN];
+    uint64_t end = start + ms_ps(WINDOW_MS), t, sum = 0, max = 0, first = 0, last = 0;
+    unsigned n = 0, bad = 0;
+    int seq = -1;
+    uint8_t k;
+
+    zeta_set_baud_rf(baud);
+    zeta_rx_mode(CHANNEL, PACKET_LEN);
+    while (sim_time < end) {
+        if (P3IN & IRQ) {
+            __delay_cycles(POLL_CYCLES);
+            continue;
+        }
+        if (zeta_rx_packet(packet)) {
+            bad++;
+            continue;
+        }
+        t = sim_time;
+        for (k = 7; (k < PACKET_LEN) && (packet[4 + k] == (uint8_t)(k * 7u + packet[6])); k++)
+            ;
+        if ((packet[0] != '#') || (packet[1] != 'R') || (packet[2] != PACKET_LEN)
+                || (packet[4] != baud) || (k < PACKET_LEN)
+                || ((int)((packet[5] << 8) | packet[6]) <= seq)) {
+            bad++;
+            continue;
+        }
+        seq = (packet[5] << 8) | packet[6];
+        t -= (((uint64_t) packet[7] << 24) | ((uint64_t) packet[8] << 16)
+              | ((uint64_t) packet[9] << 8) | packet[10]) * SIM_PS_PER_US;
+        sum += t;
+        max = (t > max) ? t : max;
+        first = n ? first : sim_time;
+        last = sim_time;
+        n++;
+    }
+    printf("baud %u %6lu bps  received %4u/%-4d %7.0f B/s", baud, (unsigned long) bps[baud], n,
+           seq + 1, (n > 1) ? (double)(n - 1) * PACKET_LEN * SIM_PS_PER_S / (last - first) : 0.0);
+    printf("  latency %7.3f ms mean %7.3f max  %s\n", n ? (double) sum / n / ms_ps(1) : 0.0,
+           (double) max / ms_ps(1), bad ? "FAIL" : "ok");
+}
+#endif // RADIO_BENCH_RX
+
+int main(void)
+{
+    uint8_t baud;
+
+    PM5CTL0 &= ~(LOCKLPM5);
+    WDTCTL = WDTPW | WDTHOLD;
+    io_init();
+    clock_init();
+    spi_init();
+    __enable_interrupt();
+    zeta_init();
+
+    for (baud = 1; baud <= 6; baud++) {
+        uint64_t start = ms_ps(START_MS + (uint32_t)(baud - 1) * WINDOW_MS);
+
+        until(start);
+#ifndef RADIO_BENCH_RX
+        send_window(baud, start);
+#else
+        receive_window(baud, start);
+#endif
+    }
+
+    fflush(stdout);
+    return 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * MCLK cycles and MCU energy of the hot paths, run from FRAM or from RAM, on the host
+ * simulator, by P. Krawiec.
+ *
+ * An application for the power simulator (built like sim_tx, see the Makefile), built twice:
+ * ramfunc_bench with the library as it is, ramfunc_bench_ram with T1_RAMFUNC (t1_util.h), so
+ * that the RAMFUNC paths run from RAM. With a steady supply it times, at the 8MHz default and
+ * the 16MHz burst clock profiles (clock_set_profile()),
+ *   spi_xfer        one byte to the Zeta+,
+ *   Save_RAM        the Hibernus RAM copy into the image,
+ *   Restore_RAM     and back,
+ *   PORT4_ISR       a comparator interrupt that hibernates (Hibernate() from the ISR),
+ *   TIMER0_B0_ISR   a software timer interrupt with no timer due (t1_timer.c),
+ * on the simulated clock and energy model (sim/sim_cpu.c), averaged over REPEAT calls: modelled
+ * estimates resting on the firmware's SIM_CYCLES() charges, not measurements. Any clock
+ * error the simulator flags prints "FAIL".
+ *
+ *     ./ramfunc_bench -t traces/steady.txt -d 30
+ *     ./ramfunc_bench_ram -t traces/steady.txt -d 30
+ */
+
+#include <stdio.h>
+#include <Proj_library/hibernus/hibernation_5994.h>
+#include <Proj_library/h_files/t1_util.h>
+#include <Proj_library/h_files/t1_spi.h>
+#include <Proj_library/h_files/t1_timer.h>
+#include "sim.h"
+
+#define REPEAT          32u
+
+#ifdef T1_RAMFUNC
+#define CODE_IN         "RAM"
+#else
+#define CODE_IN         "FRAM"
+#endif
+
+void TIMER0_B0_ISR(void);
+void PORT4_ISR(void);
+
+typedef struct {
+    uint64_t t;
+    double e;
+} mark_t;
+
+static mark_t mark(void)
+{
+    mark_t m = {sim_time, 0.0};
+    int p;
+
+    for (p = 0; p < SIM_PHASES; p++) {
+        m.e += sim_sh->energy[p];
+    }
+    return m;
+}
+
+static void report(const char *path, uint32_t mclk_hz, mark_t from, unsigned n)
+{
+    mark_t to = mark();
+    double s = (double)(to.t - from.t) / SIM_PS_PER_S / n;
+
+    printf("%-14s %-5s %3u MHz %10.0f cycles %10.3f us %9.3f nJ\n", path, CODE_IN,
+           (unsigned)(mclk_hz / 1000000u), s * mclk_hz, s * 1e6, (to.e - from.e) * 1e9 / n);
+}
+
+// The comparator interrupt as Hibernus takes it, called directly with interrupts off.
+static void port4_hibernate(void)
+{
+    __disable_interrupt();
+    hib_image.flag_interrupt = 2;
+    P4IE = EXT_COMP;
+    P4IFG |= EXT_COMP;
+    PORT4_ISR();            // Hibernates, and sets GIE again.
+    __disable_interrupt();
+    P4IE = 0;
+    __enable_interrupt();
+}
+
+int main(void)
+{
+    static const clock_profile_t profiles[] = {CLOCK_DEFAULT, CLOCK_BURST};
+    static const uint32_t mclk_hz[] = {8000000u, 16000000u};
+    unsigned k, n;
+    mark_t m;
+
+    PM5CTL0 &= ~(LOCKLPM5);
+    WDTCTL = WDTPW | WDTHOLD;
+    io_init();
+    clock_init();
+    spi_init();
+    P4IE = 0;
+
+    printf("modelled: SIM_CYCLES() charges, sim/sim_cpu.c currents and wait states\n");
+    for (k = 0; k < sizeof(profiles) / sizeof(profiles[0]); k++) {
+        clock_set_profile(profiles[k]);
+
+        m = mark();
+        for (n = 0; n < REPEAT; n++) {
+            spi_xfer((uint8_t) n);
+        }
+        report("spi_xfer", mclk_hz[k], m, REPEAT);
+
+        m = mark();
+        for (n = 0; n < REPEAT; n++) {
+            Save_RAM();
+        }
+        report("Save_RAM", mclk_hz[k], m, REPEAT);
+
+        m = mark();
+        for (n = 0; n < REPEAT; n++) {
+            Restore_RAM();
+        }
+        report("Restore_RAM", mclk_hz[k], m, REPEAT);
+
+        m = mark();
+        for (n = 0; n < REPEAT; n++) {
+            port4_hibernate();
+        }
+        report("PORT4_ISR", mclk_hz[k], m, REPEAT);
+
+        __disable_interrupt();
+        m = mark();
+        for (n = 0; n < REPEAT; n++) {
+            TIMER0_B0_ISR();
+        }
+        report("TIMER0_B0_ISR", mclk_hz[k], m, REPEAT);
+        __enable_interrupt();
+    }
+    clock_set_profile(CLOCK_DEFAULT);
+
+    printf("clock errors: %lu FRAM, %lu SPI  %s\n", sim_sh->fram_errors, sim_sh->spi_errors,
+           (sim_sh->fram_errors || sim_sh->spi_errors) ? "FAIL" : "ok");
+
+    fflush(stdout);
+    return 0;
+}
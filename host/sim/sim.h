@@ -0,0 +1,166 @@
+/*
+ * Host intermittent-power simulator, internal interface, by P. Krawiec.
+ *
+ * The simulator runs the unmodified library and a Tx or Rx application on Linux. Register
+ * accesses go through host/include/msp430.h into sim_cpu.c, which keeps simulated time,
+ * the clock system and FRAM wait states, Timer_A0/A1/B0, ports 1-4, eUSCI_B1, eUSCI_A0,
+ * DMA channels 0-2, the AES256 accelerator (sim_aes.c), ADC12_B and interrupt dispatch.
+ * The supply voltage comes from a piecewise-linear trace (sim_power.c), which drives the
+ * external comparator on P4.1 and the brown-out of the node, or from a storage capacitor
+ * the trace charges and the node's load discharges. sim_radio.c stands in for the Zeta+.
+ *
+ * Every power-up of the node is a fresh child process of the harness (sim_main.c). FRAM
+ * (sim_mem from 0x4000, and every SIM_FRAM variable) is shared between them, RAM and
+ * registers are not. A Hibernus snapshot is a frozen fork() of the running node, a restore
+ * hands over to a copy of it, so execution really continues from the checkpoint.
+ *
+ * Interrupt service routines are found by name (weak symbols), see sim_cpu.c for the list.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <semaphore.h>
+#include <sys/types.h>
+#include <msp430.h>
+
+#define SIM_PS_PER_S        1000000000000ULL    ///< Simulated time is kept in picoseconds.
+#define SIM_PS_PER_US       1000000ULL
+#define SIM_NEVER           UINT64_MAX
+
+#define SIM_FRAM_START      0x4000              ///< Start of the shared (FRAM) part of sim_mem.
+#define SIM_FRAM_VARS_MAX   0x10000             ///< Room for the SIM_FRAM variables.
+#define SIM_MARKS           16                  ///< Stages SIM_MARK() can tell apart.
+#define SIM_MARK_NAME       24
+#define SIM_MARK_BOOTS      1024                ///< Power-ups whose marks are kept.
+
+//***** Configuration *********************************************************************
+
+typedef enum {
+    SIM_WAKE_SUPPLY = 0,    ///< Boots when the supply comes up (transmitter).
+    SIM_WAKE_RF             ///< Boots at the end of an incoming packet (receiver).
+} sim_wake_t;
+
+typedef struct {
+    double v_on;            ///< Supply voltage at which the node powers up [V].
+    double v_off;           ///< Brown-out voltage [V].
+    double v_comp;          ///< External comparator threshold, P4.1 goes high [V].
+    double hyst;            ///< Comparator hysteresis, P4.1 goes low at v_comp - hyst [V].
+    double cap;             ///< Storage capacitor [F], 0 to run straight off the trace.
+    double rsrc;            ///< Harvester source resistance, with cap [ohm].
+    uint32_t vlo_hz;        ///< VLO frequency, ACLK source.
+    uint64_t duration;      ///< Length of the run [ps].
+    sim_wake_t wake;        ///< Power-up policy.
+    uint8_t rssi;           ///< RSSI byte reported for received packets.
+    double loss;            ///< Fraction of the packets on air lost to this node.
+    uint32_t seed;          ///< Of the packet losses and bit errors.
+    double corrupt;         ///< Fraction of the packets on air with a bit error.
+    double ber;             ///< Bit error rate of the payloads on air.
+    int verbose;            ///< Log boots, checkpoints and restores to stderr.
+} sim_config_t;
+
+extern sim_config_t sim_cfg;
+
+//***** State shared between node processes ***********************************************
+
+typedef enum {
+    SIM_END_BROWNOUT = 0,   ///< Supply fell below v_off.
+    SIM_END_LATCH,          ///< Firmware released the supply latch (P2.5 high).
+    SIM_END_TIME            ///< End of the run.
+} sim_end_t;
+
+typedef struct {
+    sem_t done;             ///< Posted when the running node dies.
+    sem_t resume[SIM_SLOTS];    ///< Posted to hand over to a snapshot image.
+    pid_t running;          ///< Process currently executing the node.
+    pid_t image[SIM_SLOTS];     ///< Frozen snapshot images, 0 if none.
+    uint64_t now;           ///< Time at the last hand-over [ps].
+    sim_end_t end;          ///< Why the last node process died.
+
+    uint64_t active[SIM_PHASES];    ///< CPU active time per phase [ps].
+    uint64_t sleep[SIM_PHASES];     ///< Low-power mode time per phase [ps].
+    double energy[SIM_PHASES];      ///< MCU energy per phase, active and asleep [J].
+    uint64_t app;           ///< Application time, active and asleep [ps].
+    uint64_t progress;      ///< Application time along the current line of execution [ps].
+    uint64_t progress_at[SIM_SLOTS];    ///< progress when each snapshot was taken.
+    int last_slot;          ///< Slot of the latest snapshot or commit.
+    uint64_t wasted;        ///< Application time discarded by restores (re-executed) [ps].
+
+    unsigned long boots, brownouts, latch_offs;
+    unsigned long ckpt_started, ckpt_done;
+    unsigned long restores, restores_failed;
+    unsigned long radio_tx, radio_rx;
+    double radio_energy;    ///< Radio energy [J].
+    unsigned long air_packets, air_collided, air_lost;  ///< --air-in packets, see sim_radio.c.
+    unsigned long air_corrupted;    ///< With a bit error (--corrupt, --ber).
+    unsigned long radio_rx_bad;     ///< Received with a bit error, ATE off.
+    unsigned long radio_baud_lost;  ///< ATB not applied, SDN pulse too short.
+    double v_store;         ///< Storage capacitor voltage (with cap) [V],
+    uint64_t t_store;       ///< at this time [ps].
+    unsigned long unhandled;
+    unsigned long fram_errors;      ///< Clock changes leaving MCLK too fast for the FRAM.
+    unsigned long spi_errors;       ///< SPI transfers above the Zeta+ clock limit.
+    unsigned long uart_bytes;       ///< Sent on eUSCI_A0.
+
+    int marks;              ///< Stages marked so far, in the order first seen.
+    char mark_name[SIM_MARKS][SIM_MARK_NAME];
+    uint64_t mark_ref[SIM_MARK_BOOTS];  ///< Start of each power-up's wake-up [ps].
+    uint64_t mark_at[SIM_MARK_BOOTS][SIM_MARKS];    ///< First time at each stage, or SIM_NEVER.
+
+    size_t fram_vars_size;
+    uint8_t fram_vars[SIM_FRAM_VARS_MAX];
+} sim_shared_t;
+
+extern sim_shared_t *sim_sh;
+
+//***** sim_cpu.c *************************************************************************
+
+extern uint64_t sim_time;   ///< Current simulated time [ps].
+
+void sim_cpu_boot(void);
+void sim_cpu_freeze(void);
+void sim_cpu_resumed(void);
+void sim_halt(void);
+int sim_uart_open(const char *path);
+
+//***** sim_aes.c *************************************************************************
+
+void sim_aes_encrypt(const uint8_t *key, unsigned key_bits, const uint8_t in[16], uint8_t out[16]);
+
+//***** sim_main.c ************************************************************************
+
+void sim_die(sim_end_t end) __attribute__((noreturn));
+void sim_log(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+//***** sim_power.c ***********************************************************************
+
+#define SIM_STORE_STEP_PS   (100 * SIM_PS_PER_US)  ///< Brown-out checks on the capacitor voltage.
+
+int sim_trace_load(const char *path);
+double sim_trace_v(uint64_t t);
+uint64_t sim_trace_cross(uint64_t from, double level, int rising);
+int sim_store(void);
+void sim_store_draw(uint64_t t, double amps);
+uint64_t sim_store_charge(uint64_t from, double level, double trace_min);
+double sim_supply_v(uint64_t t);
+
+//***** sim_radio.c ***********************************************************************
+
+int sim_radio_load(const char *arg);
+int sim_radio_set_bps(const char *arg);
+void sim_radio_medium(void);
+int sim_radio_open_log(const char *path);
+uint64_t sim_radio_next_packet_end(uint64_t from);
+uint64_t sim_radio_packet_start(uint64_t end);
+void sim_radio_reset(void);
+void sim_radio_sdn(int high);
+uint8_t sim_radio_xfer(uint8_t mosi);
+uint64_t sim_radio_next_event(void);
+void sim_radio_update(void);
+uint64_t sim_radio_next_detect(void);
+int sim_radio_detect(void);
+int sim_radio_nirq(void);
+double sim_radio_amps(void);
+
+#endif // SIM_H
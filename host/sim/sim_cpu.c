@@ -0,0 +1,1546 @@
+/*
+ * MSP430FR5994 register file and peripherals for the host simulator, by P. Krawiec.
+ *
+ * Every register access (SIM_REG8/16 in msp430.h) calls sim_reg(), which
+ *   1. applies the side effects of the previous access (writes are spotted by comparing
+ *      the register with its value before the access, TXBUF counts as written),
+ *   2. charges ACCESS_CYCLES of MCLK, handling timer, comparator, radio and SPI events
+ *      and taking interrupts on the way,
+ *   3. prepares registers with read side effects (TAxR, interrupt vectors, RXBUF).
+ * Code that does not touch registers costs nothing unless it calls SIM_CYCLES().
+ *
+ * Modelled: CS (DCO, VLO, MODOSC, dividers), FRAM wait states, Timer_A0-A2, Timer_B0 (up and
+ * continuous mode, CCR0-2 compare, TAIFG), ports 1-4 inputs and edge interrupts, eUSCI_B1
+ * SPI master, the status register (GIE, LPMx, __bic_SR_register_on_exit). Clock gating in
+ * low-power modes is not modelled, the timers keep counting from the selected clock.
+ * eUSCI_A0 sends UART frames (start, 8 data, stop) at BRCLK / UCBRx, or / 16 UCBRx with UCOS16,
+ * the modulation is left out. It is single-buffered: UCTXIFG comes back when the frame is
+ * out, and the byte goes to --uart. DMA channels 0-2 do single or repeated single transfers,
+ * bytes or words, each on its trigger (DMAxTSEL): UCA0TXIFG's rising edge, as the real
+ * trigger, or the AES256 engine's. DMAxSA/DA point at host memory or a register; the cycles
+ * a transfer takes from the CPU are not charged, but for the AES runs below.
+ * AES256 encrypts (AESOP = 0 only) with 128, 192 or 256-bit keys, sim_aes.c computing the
+ * blocks, in 168, 204 or 234 MCLK cycles (SLASE54). Written by the CPU (words, always counted
+ * as written, like TXBUF) or by DMA (bytes or words): AESAKEY loads the key, AESADIN a block
+ * to encrypt (ECB), AESAXDIN one XORed with the last output first (CBC), AESAXIN is XORed
+ * into the last output without starting anything (the IV). With AESCMEN, writing a block
+ * count to AESACTL1 starts a run: the engine asks for each block's input on DMA trigger 12
+ * (AES trigger 1) and, when it is done, for its output on trigger 11 (AES trigger 0), a
+ * transfer at a time, and each block takes DMA_CYCLES more per transfer. In OFB mode the
+ * run's input goes to AESAXIN and is XORed with the key stream, which starts from the IV.
+ * AESASTAT's AESBUSY is up from the start of a block, or of a run, to its end.
+ * The CRC16 module (CRC-CCITT) and the CRC32 module's CRC-32 (ISO 3309) take each byte
+ * written to their data input, in the cycles of the write. CRCDIRB feeds the CRC16 its bits
+ * MSB first, as the standard CRC-CCITT, CRCDI LSB first; CRCINIRES holds the result, CRCRESR
+ * it bit-reversed. CRC32DIW0 feeds the CRC32 LSB first, CRC32INIRESW0/W1 holding the
+ * reflected register, as zlib's crc32() before the final inversion. Byte writes (SIM_REG8,
+ * sim_reg8()) are one byte, word writes two, low byte first; like TXBUF, the same byte
+ * twice is two writes.
+ * ADC12_B does single conversions of MEM0 on MODOSC, polled (no interrupt), of the one input
+ * the firmware uses: channel 31, AVCC/2 with ADC12BATMAP, against AVCC or the REF_A
+ * reference (REFCTL0, ready as soon as it is on).
+ *
+ * Energy: the MCU's supply current times the supply voltage, charged per phase. Active
+ * current grows linearly with MCLK (I_ACTIVE_*, close to the datasheet's figures for a 75%
+ * FRAM cache hit rate), LPM0-2 and LPM3-4 draw a fixed current. A wait state makes each
+ * cycle take 1 + NWAITS/FRAM_MISS_DIV MCLK periods, for the FRAM accesses that miss the cache.
+ * Running MCLK above 8MHz without a wait state, or the SPI clock above the Zeta+ limit,
+ * is counted and logged (on the target the reads from FRAM would be corrupt). The ADC and
+ * the reference add I_ADC_A and I_REF_A while they are on. The radio's current is charged
+ * separately (sim_radio_amps()), all of it is drawn from the storage capacitor if there is one.
+ *
+ * Code run from RAM (RAMFUNC, in the sim_ramfunc section) is told apart by the return
+ * address of sim_reg()/sim_cycles(): its cycles take one MCLK period each and draw the RAM
+ * execution current (I_ACTIVE_RAM_A_PER_HZ). FRAM data accesses made from it are charged
+ * as RAM too, so its gain at 16MHz is an upper bound. Functions it calls that are not
+ * RAMFUNC are charged as FRAM, as on the target.
+ *
+ * Interrupt vectors, highest priority first, and the ISR names they call:
+ *   TIMER0_B0_ISR, TIMER0_B1_ISR, TIMER0_A0_ISR, TIMER0_A1_ISR, DMA_ISR, TIMER1_A0_ISR,
+ *   TIMER1_A1_ISR, PORT1_ISR, TIMER2_A0_ISR, TIMER2_A1_ISR, PORT2_ISR, USCI_B1_ISR,
+ *   PORT3_ISR, PORT4_ISR.
+ * A pending interrupt without an ISR is counted and its flag cleared (the target would
+ * end in isr_trap).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "sim.h"
+
+uint8_t sim_mem[SIM_MEM_SIZE] __attribute__((aligned(0x10000)));    // See __data16_write_addr.
+uint64_t sim_time;
+
+#define MEM8(a)     sim_mem[(a)]
+#define MEM16(a)    (*(uint16_t *) &sim_mem[(a)])
+
+#define ACCESS_CYCLES       3u      ///< Average cost of an instruction touching a register.
+#define ISR_ENTRY_CYCLES    6u
+#define ISR_EXIT_CYCLES     5u
+#define ISR_NESTING_MAX     16
+
+#define MODOSC_HZ           5000000u
+#define FRAM_MAX_HZ         8000000u    ///< Fastest MCLK without FRAM wait states.
+#define FRAM_MISS_DIV       4u      ///< One cycle in FRAM_MISS_DIV waits on the FRAM.
+#define SPI_MAX_HZ          1400000u    ///< Zeta+ SPI clock limit.
+
+#define I_ACTIVE_A          100e-6  ///< Active current at 0Hz, extrapolated [A].
+#define I_ACTIVE_A_PER_HZ   115e-12 ///< Active current per Hz of MCLK [A].
+#define I_ACTIVE_RAM_A_PER_HZ 70e-12    ///< Same, code and data in RAM [A].
+#define I_LPM0_A            70e-6   ///< CPU off, DCO running [A].
+#define I_LPM3_A            0.7e-6  ///< CPU and DCO off, VLO running [A].
+#define I_ADC_A             150e-6  ///< ADC12_B on [A].
+#define I_REF_A             30e-6   ///< REF_A on [A].
+
+#define ADC_CONV_CYCLES     14u     ///< ADC12CLK cycles of a 12-bit conversion after sampling.
+
+// Register addresses used by the models below.
+#define FRCTL0_ADDR         0x0140
+#define CS_BASE             0x0160
+#define PORT_BASE           0x0200
+#define UCB1_CTLW0          0x0680
+#define UCB1_BRW            0x0686
+#define UCB1_RXBUF          0x068C
+#define UCB1_TXBUF          0x068E
+#define UCB1_IE             0x06AA
+#define UCB1_IFG            0x06AC
+#define UCB1_IV             0x06AE
+#define UCA0_CTLW0          0x05C0
+#define UCA0_BRW            0x05C6
+#define UCA0_MCTLW          0x05C8
+#define UCA0_STATW          0x05CA
+#define UCA0_TXBUF          0x05CE
+#define UCA0_IFG            0x05DC
+#define DMA_CTL0            0x0500
+#define DMA_CTL1            0x0502
+#define DMA_IV              0x050E
+#define DMA_BASE            0x0510      ///< Channel 0, then one block of 0x10 per channel.
+#define AES_CTL0            0x09C0
+#define AES_CTL1            0x09C2
+#define AES_STAT            0x09C4
+#define AES_KEY             0x09C6
+#define AES_DIN             0x09C8
+#define AES_DOUT            0x09CA
+#define AES_XDIN            0x09CC
+#define AES_XIN             0x09CE
+#define CRC_DI              0x0150
+#define CRC_DIRB            0x0152
+#define CRC_INIRES          0x0154
+#define CRC_RESR            0x0156
+#define CRC32_DI            0x0980
+#define CRC32_INIRES0       0x0988
+#define CRC32_INIRES1       0x098A
+#define REFCTL0_ADDR        0x01B0
+#define ADC12_CTL0          0x0800
+#define ADC12_CTL1          0x0802
+#define ADC12_CTL2          0x0804
+#define ADC12_CTL3          0x0806
+#define ADC12_IFGR0         0x080C
+#define ADC12_MCTL0         0x0820
+#define ADC12_MEM0          0x0860
+
+// Timer register offsets.
+#define T_CTL               0x00
+#define T_CCTL(n)           (0x02 + 2 * (n))
+#define T_R                 0x10
+#define T_CCR(n)            (0x12 + 2 * (n))
+#define T_EX0               0x20
+#define T_IV                0x2E
+#define T_SIZE              0x30
+
+// DMA channel register offsets.
+#define DMA_CTL             0x00
+#define DMA_SA              0x02
+#define DMA_DA              0x06
+#define DMA_SZ              0x0A
+#define DMA_CHANNELS        3
+
+#define AES_TRIG_OUT        11      ///< DMA trigger AES trigger 0: output ready.
+#define AES_TRIG_IN         12      ///< DMA trigger AES trigger 1: input wanted.
+#define DMA_CYCLES          2u      ///< MCLK cycles a DMA transfer takes from the CPU.
+
+// Board wiring (see t1_util.h and t1_zeta.h).
+#define LATCH_BIT           BIT5    ///< P2.5, supply latch, off when high.
+#define SDN_BIT             BIT4    ///< P3.4, radio shutdown.
+#define NIRQ_BIT            BIT5    ///< P3.5, radio nIRQ.
+#define COMP_BIT            BIT1    ///< P4.1, external comparator.
+#define DET_BIT             BIT2    ///< P4.2, wake-up detector (t1_wake.h), when an input.
+
+//***** ISRs ******************************************************************************
+
+#define SIM_ISR(name)   extern void name(void) __attribute__((weak));
+SIM_ISR(TIMER0_B0_ISR)
+SIM_ISR(TIMER0_B1_ISR)
+SIM_ISR(TIMER0_A0_ISR)
+SIM_ISR(TIMER0_A1_ISR)
+SIM_ISR(DMA_ISR)
+SIM_ISR(TIMER1_A0_ISR)
+SIM_ISR(TIMER1_A1_ISR)
+SIM_ISR(PORT1_ISR)
+SIM_ISR(TIMER2_A0_ISR)
+SIM_ISR(TIMER2_A1_ISR)
+SIM_ISR(PORT2_ISR)
+SIM_ISR(USCI_B1_ISR)
+SIM_ISR(PORT3_ISR)
+SIM_ISR(PORT4_ISR)
+
+typedef enum { SRC_TIMER0, SRC_TIMER1, SRC_PORT, SRC_UCB1, SRC_DMA } sim_src_t;
+
+typedef struct {
+    const char *name;
+    void (*isr)(void);
+    sim_src_t src;
+    int unit;               ///< Timer index or port number.
+} sim_vector_t;
+
+//***** State *****************************************************************************
+
+typedef struct {
+    uint16_t base;          ///< Register block.
+    uint32_t hz;            ///< Tick rate.
+    uint32_t period;        ///< Counter modulus.
+    int running;
+    uint64_t base_ps;       ///< Time at which the counter held base_cnt.
+    uint32_t base_cnt;
+    uint64_t done;          ///< Ticks since base_ps already checked for compares.
+    uint64_t next_ps;       ///< Next tick that sets a flag.
+} sim_timer_t;
+
+enum { TA0, TA1, TA2, TB0, TIMERS };
+
+typedef struct {
+    uint16_t base;          ///< DMAxCTL.
+    uint8_t *sa, *da;       ///< DMAxSA/DA as host pointers.
+    uint8_t *src, *dst;     ///< Next transfer's, from sa/da when the channel is enabled.
+    uint16_t size;          ///< DMAxSZ when the channel was enabled.
+} sim_dma_t;
+
+typedef struct {
+    uint8_t key[32];
+    unsigned key_n;         ///< Key bytes written.
+    uint8_t state[16];      ///< Last output (OFB: key stream), AESAXIN writes XOR into it.
+    unsigned xin_n;
+    uint8_t in[16];         ///< Block being written.
+    unsigned in_n;
+    uint8_t out[16];        ///< Block for AESADOUT.
+    unsigned out_n;         ///< Bytes of it read, 16 when there is none.
+    int run;                ///< Cipher mode (AESCMEN) blocks under way,
+    unsigned blocks;        ///< this many still to write.
+    uint64_t done;          ///< End of the block being encrypted.
+} sim_aes_t;
+
+static sim_timer_t timers[TIMERS] = {{.base = 0x0340}, {.base = 0x0380}, {.base = 0x0400},
+                                     {.base = 0x03C0}};
+
+static const sim_vector_t vectors[] = {
+    {"TIMER0_B0", TIMER0_B0_ISR, SRC_TIMER0, TB0},
+    {"TIMER0_B1", TIMER0_B1_ISR, SRC_TIMER1, TB0},
+    {"TIMER0_A0", TIMER0_A0_ISR, SRC_TIMER0, TA0},
+    {"TIMER0_A1", TIMER0_A1_ISR, SRC_TIMER1, TA0},
+    {"DMA", DMA_ISR, SRC_DMA, 0},
+    {"TIMER1_A0", TIMER1_A0_ISR, SRC_TIMER0, TA1},
+    {"TIMER1_A1", TIMER1_A1_ISR, SRC_TIMER1, TA1},
+    {"PORT1", PORT1_ISR, SRC_PORT, 1},
+    {"TIMER2_A0", TIMER2_A0_ISR, SRC_TIMER0, TA2},
+    {"TIMER2_A1", TIMER2_A1_ISR, SRC_TIMER1, TA2},
+    {"PORT2", PORT2_ISR, SRC_PORT, 2},
+    {"USCI_B1", USCI_B1_ISR, SRC_UCB1, 0},
+    {"PORT3", PORT3_ISR, SRC_PORT, 3},
+    {"PORT4", PORT4_ISR, SRC_PORT, 4},
+};
+
+#define VECTORS (sizeof(vectors) / sizeof(vectors[0]))
+
+static uint16_t sr;
+static uint16_t sr_saved[ISR_NESTING_MAX];
+static int depth;
+static int phase;
+
+static uint32_t f_mclk, f_smclk, f_aclk;
+static uint32_t f_cpu;      ///< Cycle rate, MCLK less the FRAM wait states.
+static int ram_code;        ///< The time being charged is spent in RAMFUNC code.
+static uint64_t t_death;
+static uint64_t store_next;
+static int comp;
+static uint64_t comp_next;
+static uint64_t spi_done;
+static uint8_t spi_byte;
+static uint64_t adc_done;
+static uint64_t uart_done;
+static uint8_t uart_byte;
+static int uart_fd = -1;
+static sim_dma_t dma[DMA_CHANNELS] = {{.base = DMA_BASE}, {.base = DMA_BASE + 0x10},
+                                      {.base = DMA_BASE + 0x20}};
+static sim_aes_t aes;
+static unsigned long unhandled_seen;
+
+// Access waiting for its side effects.
+static struct {
+    int active;
+    uint16_t addr;          ///< Word address.
+    uint16_t old;           ///< Word before the access.
+    int byte;               ///< Byte access: 1 the low byte, 2 the high one. 0 a word.
+} pend;
+
+static void run(uint64_t until);
+
+//***** Time ******************************************************************************
+
+static uint64_t cycles_ps(uint32_t n, uint32_t hz)
+{
+    return (uint64_t)(((unsigned __int128) n * SIM_PS_PER_S + hz - 1) / hz);
+}
+
+// Charge the interval up to t to the current phase, or die if power runs out first.
+static void advance(uint64_t t)
+{
+    uint64_t stop = (t_death < sim_cfg.duration) ? t_death : sim_cfg.duration;
+    uint64_t dt;
+    double amps, radio, v, s;
+
+    if (t < sim_time) {
+        t = sim_time;
+    }
+    if (t >= stop) {
+        t = stop;
+    }
+    dt = t - sim_time;
+    if (sr & CPUOFF) {
+        sim_sh->sleep[phase] += dt;
+        amps = (sr & SCG1) && (sr & SCG0) ? I_LPM3_A : I_LPM0_A;
+    }
+    else {
+        sim_sh->active[phase] += dt;
+        amps = I_ACTIVE_A + (ram_code ? I_ACTIVE_RAM_A_PER_HZ : I_ACTIVE_A_PER_HZ) * f_mclk;
+    }
+    amps += ((MEM16(ADC12_CTL0) & ADC12ON) ? I_ADC_A : 0.0)
+          + ((MEM16(REFCTL0_ADDR) & REFON) ? I_REF_A : 0.0);
+    radio = sim_radio_amps();
+    v = sim_supply_v(sim_time);
+    s = (double) dt / SIM_PS_PER_S;
+    sim_sh->energy[phase] += amps * v * s;
+    sim_sh->radio_energy += radio * v * s;
+    sim_store_draw(t, amps + radio);
+    if (phase == SIM_PHASE_APP) {
+        sim_sh->app += dt;
+        sim_sh->progress += dt;
+    }
+    sim_time = t;
+    if (t == stop) {
+        sim_die((t == t_death) ? SIM_END_BROWNOUT : SIM_END_TIME);
+    }
+}
+
+//***** Clock system **********************************************************************
+
+static uint32_t clk_source(unsigned sel, uint32_t dco)
+{
+    switch (sel) {
+    case 1:
+        return sim_cfg.vlo_hz;
+    case 3:
+        return dco;
+    case 4:
+    case 5:                 // HFXT not fitted, falls back to MODOSC.
+        return MODOSC_HZ;
+    default:                // LFMODCLK, and LFXT (not fitted) falling back to it.
+        return MODOSC_HZ / 128;
+    }
+}
+
+static void clocks_update(void)
+{
+    static const uint32_t dco0[8] = {1000000, 2670000, 3330000, 4000000,
+                                     5330000, 6670000, 8000000, 8000000};
+    static const uint32_t dco1[8] = {1000000, 5330000, 6670000, 8000000,
+                                     16000000, 21330000, 24000000, 24000000};
+    uint16_t c1 = MEM16(CS_BASE + 2), c2 = MEM16(CS_BASE + 4), c3 = MEM16(CS_BASE + 6);
+    uint32_t dco = ((c1 & DCORSEL) ? dco1 : dco0)[(c1 & DCOFSEL) >> 1];
+    unsigned da = (c3 >> 8) & 7, ds = (c3 >> 4) & 7, dm = c3 & 7, nwaits;
+
+    f_aclk = clk_source((c2 >> 8) & 7, dco) >> (da > 5 ? 5 : da);
+    f_smclk = clk_source((c2 >> 4) & 7, dco) >> (ds > 5 ? 5 : ds);
+    f_mclk = clk_source(c2 & 7, dco) >> (dm > 5 ? 5 : dm);
+
+    nwaits = (MEM16(FRCTL0_ADDR) & NWAITS) >> 4;
+    f_cpu = (uint32_t)((uint64_t) f_mclk * FRAM_MISS_DIV / (FRAM_MISS_DIV + nwaits));
+    if ((f_mclk > FRAM_MAX_HZ) && !nwaits) {
+        sim_sh->fram_errors++;
+        sim_log("MCLK %u Hz without FRAM wait states", (unsigned) f_mclk);
+    }
+}
+
+//***** Timers ****************************************************************************
+
+static uint64_t timer_ticks(const sim_timer_t *tm, uint64_t t)
+{
+    return (uint64_t)(((unsigned __int128)(t - tm->base_ps) * tm->hz) / SIM_PS_PER_S);
+}
+
+static uint32_t timer_count(const sim_timer_t *tm, uint64_t t)
+{
+    return tm->running ? (uint32_t)((tm->base_cnt + timer_ticks(tm, t)) % tm->period)
+                       : tm->base_cnt;
+}
+
+// First tick after the checked ones at which the counter equals c.
+static uint64_t timer_match(const sim_timer_t *tm, uint32_t c)
+{
+    uint64_t k = ((uint64_t) c + tm->period - tm->base_cnt % tm->period) % tm->period;
+
+    if (k <= tm->done) {
+        k += ((tm->done - k) / tm->period + 1) * tm->period;
+    }
+    return k;
+}
+
+static void timer_schedule(sim_timer_t *tm)
+{
+    uint64_t k = SIM_NEVER;
+    int n;
+
+    tm->next_ps = SIM_NEVER;
+    if (!tm->running) {
+        return;
+    }
+    for (n = 0; n < 3; n++) {
+        uint32_t c = MEM16(tm->base + T_CCR(n));
+        if ((c < tm->period) && (timer_match(tm, c) < k)) {
+            k = timer_match(tm, c);
+        }
+    }
+    if (timer_match(tm, 0) < k) {
+        k = timer_match(tm, 0);
+    }
+    tm->next_ps = tm->base_ps + (uint64_t)(((unsigned __int128) k * SIM_PS_PER_S + tm->hz - 1)
+                                           / tm->hz);
+}
+
+// Restart counting from cnt now, with the current register settings.
+static void timer_set(sim_timer_t *tm, uint32_t cnt)
+{
+    uint16_t ctl = MEM16(tm->base + T_CTL);
+    unsigned mode = (ctl >> 4) & 3;
+    uint32_t src = 0;
+
+    switch ((ctl >> 8) & 3) {
+    case 1:
+        src = f_aclk;
+        break;
+    case 2:
+        src = f_smclk;
+        break;
+    default:                // TACLK/INCLK pins are not connected.
+        break;
+    }
+    tm->hz = (src >> ((ctl >> 6) & 3)) / ((MEM16(tm->base + T_EX0) & 7) + 1);
+    tm->period = (mode == 2) ? 0x10000 : (uint32_t) MEM16(tm->base + T_CCR(0)) + 1;
+    tm->running = mode && tm->hz && (tm->period > 1);
+    tm->base_ps = sim_time;
+    tm->base_cnt = cnt;
+    tm->done = 0;
+    timer_schedule(tm);
+}
+
+static void timer_process(sim_timer_t *tm)
+{
+    uint64_t kt;
+    int n;
+
+    if (sim_time < tm->next_ps) {
+        return;
+    }
+    kt = timer_ticks(tm, sim_time);
+    for (n = 0; n < 3; n++) {
+        uint32_t c = MEM16(tm->base + T_CCR(n));
+        if ((c < tm->period) && (timer_match(tm, c) <= kt)) {
+            MEM16(tm->base + T_CCTL(n)) |= CCIFG;
+        }
+    }
+    if (timer_match(tm, 0) <= kt) {
+        MEM16(tm->base + T_CTL) |= TAIFG;
+    }
+    tm->done = kt;
+    timer_schedule(tm);
+}
+
+static void timer_write(sim_timer_t *tm, uint16_t off, uint16_t val)
+{
+    uint32_t cnt = timer_count(tm, sim_time);
+
+    if ((off == T_CTL) && (val & TACLR)) {
+        MEM16(tm->base + T_CTL) &= ~TACLR;
+        cnt = 0;
+    }
+    else if (off == T_R) {
+        cnt = val;
+    }
+    else if ((off == T_IV) || ((off >= T_CCTL(0)) && (off < T_R))) {
+        return;
+    }
+    timer_set(tm, cnt);
+}
+
+static uint16_t timer_iv(sim_timer_t *tm)
+{
+    uint16_t *ctl = &MEM16(tm->base + T_CTL);
+    int n;
+
+    for (n = 1; n < 3; n++) {
+        uint16_t *cctl = &MEM16(tm->base + T_CCTL(n));
+        if ((*cctl & CCIE) && (*cctl & CCIFG)) {
+            *cctl &= ~CCIFG;
+            return 2 * n;
+        }
+    }
+    if ((*ctl & TAIE) && (*ctl & TAIFG)) {
+        *ctl &= ~TAIFG;
+        return 0x0E;
+    }
+    return 0;
+}
+
+//***** Ports *****************************************************************************
+
+static uint16_t port_reg(int port, uint16_t off)
+{
+    return PORT_BASE + ((port - 1) / 2) * 0x20 + off + ((port - 1) & 1);
+}
+
+static uint16_t port_iv_addr(int port)
+{
+    return PORT_BASE + ((port - 1) / 2) * 0x20 + (((port - 1) & 1) ? 0x1E : 0x0E);
+}
+
+// Drive an input pin, raising its interrupt flag on the edge selected by PxIES.
+static void port_input(int port, uint8_t bit, int level, int edges)
+{
+    uint8_t *in = &MEM8(port_reg(port, 0x00));
+    int was = !!(*in & bit);
+
+    if (level) {
+        *in |= bit;
+    }
+    else {
+        *in &= ~bit;
+    }
+    if (edges && (level != was) && (((MEM8(port_reg(port, 0x18)) & bit) ? !level : level))) {
+        MEM8(port_reg(port, 0x1C)) |= bit;
+    }
+}
+
+static uint16_t port_iv(int port)
+{
+    uint8_t *ifg = &MEM8(port_reg(port, 0x1C));
+    uint8_t act = *ifg & MEM8(port_reg(port, 0x1A));
+    int b;
+
+    for (b = 0; b < 8; b++) {
+        if (act & (1u << b)) {
+            *ifg &= ~(1u << b);
+            return 2 * b + 2;
+        }
+    }
+    return 0;
+}
+
+//***** Board: supply latch, comparator, radio pins ***************************************
+
+static void latch_check(void)
+{
+    if (MEM8(port_reg(2, 0x02)) & MEM8(port_reg(2, 0x04)) & LATCH_BIT) {
+        sim_die(SIM_END_LATCH);
+    }
+}
+
+static void comp_schedule(void)
+{
+    comp_next = comp ? sim_trace_cross(sim_time, sim_cfg.v_comp - sim_cfg.hyst, 0)
+                     : sim_trace_cross(sim_time, sim_cfg.v_comp, 1);
+}
+
+static void comp_init(void)
+{
+    comp = sim_trace_v(sim_time) >= sim_cfg.v_comp;
+    port_input(4, COMP_BIT, comp, 0);
+    comp_schedule();
+}
+
+/* Brown-out. With a storage capacitor the load decides when it happens, its voltage is
+ * checked every SIM_STORE_STEP_PS instead (store_check()). */
+static void supply_init(void)
+{
+    if (sim_store()) {
+        t_death = SIM_NEVER;
+        store_next = sim_time + SIM_STORE_STEP_PS;
+    }
+    else {
+        t_death = sim_trace_cross(sim_time, sim_cfg.v_off, 0);
+        store_next = SIM_NEVER;
+    }
+}
+
+static void store_check(void)
+{
+    if (sim_sh->v_store < sim_cfg.v_off) {
+        sim_die(SIM_END_BROWNOUT);
+    }
+    store_next = sim_time + SIM_STORE_STEP_PS;
+}
+
+// The wake-up detector only once the firmware has made P4.2 an input.
+static int det_input(void)
+{
+    return !(MEM8(port_reg(4, 0x04)) & DET_BIT);
+}
+
+static void radio_pins(int edges)
+{
+    port_input(3, NIRQ_BIT, sim_radio_nirq(), edges);
+    if (det_input()) {
+        port_input(4, DET_BIT, sim_radio_detect(), edges);
+    }
+}
+
+// SDN is high when driven high, or when P3.4 is not an output (pull-up on the module).
+static void radio_sdn_update(int edges)
+{
+    int sdn = (MEM8(port_reg(3, 0x04)) & SDN_BIT) ? !!(MEM8(port_reg(3, 0x02)) & SDN_BIT) : 1;
+
+    sim_radio_sdn(sdn);
+    radio_pins(edges);
+}
+
+//***** eUSCI_B1 **************************************************************************
+
+static void spi_start(uint8_t byte)
+{
+    uint16_t ctl = MEM16(UCB1_CTLW0);
+    uint32_t brclk = ((ctl & 0xC0) == UCSSEL_1) ? f_aclk : f_smclk;
+    uint32_t br = MEM16(UCB1_BRW) ? MEM16(UCB1_BRW) : 1;
+
+    if ((ctl & UCSWRST) || !brclk) {
+        return;
+    }
+    if (brclk / br > SPI_MAX_HZ) {
+        sim_sh->spi_errors++;
+        sim_log("SPI clock %u Hz", (unsigned)(brclk / br));
+    }
+    MEM16(UCB1_IFG) &= ~UCTXIFG;
+    spi_byte = byte;
+    spi_done = sim_time + cycles_ps(8 * br, brclk);
+}
+
+static void spi_finish(void)
+{
+    spi_done = SIM_NEVER;
+    MEM16(UCB1_RXBUF) = sim_radio_xfer(spi_byte);
+    MEM16(UCB1_IFG) |= UCRXIFG | UCTXIFG;
+    radio_pins(1);
+}
+
+static void spi_reset(void)
+{
+    spi_done = SIM_NEVER;
+    MEM16(UCB1_IFG) = UCTXIFG;
+}
+
+//***** eUSCI_A0, DMA, AES256 *************************************************************
+
+static void uart_start(uint8_t byte)
+{
+    uint16_t ctl = MEM16(UCA0_CTLW0);
+    uint32_t brclk = ((ctl & 0xC0) == UCSSEL_1) ? f_aclk : f_smclk;
+    uint32_t br = MEM16(UCA0_BRW) ? MEM16(UCA0_BRW) : 1;
+
+    if ((ctl & UCSWRST) || !brclk) {
+        return;
+    }
+    if (MEM16(UCA0_MCTLW) & UCOS16) {
+        br *= 16;
+    }
+    MEM16(UCA0_IFG) &= ~UCTXIFG;
+    MEM16(UCA0_STATW) |= UCBUSY;
+    uart_byte = byte;
+    uart_done = sim_time + cycles_ps(10 * br, brclk);
+}
+
+static int aes_input(uint16_t a)
+{
+    return (a == AES_KEY) || (a == AES_DIN) || (a == AES_XDIN) || (a == AES_XIN);
+}
+
+// Encrypt the block written, the input complete.
+static void aes_block(void)
+{
+    static const uint32_t cycles[3] = {168, 204, 234};  ///< Per key length (SLASE54).
+    uint16_t ctl = MEM16(AES_CTL0);
+    unsigned kl = (ctl & AESKL) >> 2;
+    int k;
+
+    if (aes.run && ((ctl & AESCM) == AESCM_2)) {
+        sim_aes_encrypt(aes.key, 128 + 64 * kl, aes.state, aes.state);   // OFB: next key stream block.
+        for (k = 0; k < 16; k++) {
+            aes.out[k] = aes.in[k] ^ aes.state[k];
+        }
+    }
+    else {
+        sim_aes_encrypt(aes.key, 128 + 64 * kl, aes.in, aes.out);
+        memcpy(aes.state, aes.out, 16);
+    }
+    aes.in_n = 0;
+    aes.out_n = 16;     // Readable when done.
+    MEM16(AES_STAT) |= AESBUSY;
+    aes.done = sim_time + cycles_ps(cycles[kl] + (aes.run ? 32 * DMA_CYCLES : 0), f_mclk);
+    if (aes.run) {
+        aes.blocks--;
+    }
+}
+
+// A byte written to AESAKEY, AESADIN, AESAXDIN or AESAXIN, by the CPU or a DMA channel.
+static void aes_write(uint16_t a, uint8_t byte)
+{
+    unsigned key_len = 16 + 8 * ((MEM16(AES_CTL0) & AESKL) >> 2);
+
+    switch (a) {
+    case AES_KEY:
+        aes.key[aes.key_n++] = byte;
+        if (aes.key_n >= key_len) {
+            aes.key_n = 0;
+            MEM16(AES_STAT) |= AESKEYWR;
+        }
+        return;
+    case AES_XIN:
+        if (!aes.run) {
+            aes.state[aes.xin_n] ^= byte;   // The IV, or any block to chain from.
+            aes.xin_n = (aes.xin_n + 1) & 0x0F;
+            return;
+        }
+        aes.in[aes.in_n] = byte;    // OFB input, XORed with the key stream.
+        break;
+    case AES_XDIN:
+        aes.in[aes.in_n] = byte ^ aes.state[aes.in_n];
+        break;
+    default:
+        aes.in[aes.in_n] = byte;
+        break;
+    }
+    if ((++aes.in_n == 16) && (aes.done == SIM_NEVER)) {
+        aes_block();
+    }
+}
+
+static uint8_t aes_read(void)
+{
+    if (aes.out_n >= 16) {
+        return 0;
+    }
+    return aes.out[aes.out_n++];
+}
+
+static int dma_trigger(int trigger);
+
+/* Cipher mode: the engine asks for each block's output to be read (trigger AES_TRIG_OUT) and
+ * then for the next block's input (AES_TRIG_IN), a byte per DMA transfer, until the block
+ * count is done or a channel does not answer. */
+static void aes_pump(void)
+{
+    while (aes.run && (aes.done == SIM_NEVER)) {
+        if (aes.out_n < 16) {
+            if (!dma_trigger(AES_TRIG_OUT)) {
+                return;
+            }
+        }
+        else if (!aes.blocks) {
+            aes.run = 0;
+            MEM16(AES_STAT) &= ~AESBUSY;
+            MEM16(AES_CTL0) |= AESRDYIFG;
+        }
+        else if (!dma_trigger(AES_TRIG_IN)) {
+            return;
+        }
+    }
+}
+
+static void aes_finish(void)
+{
+    aes.done = SIM_NEVER;
+    aes.out_n = 0;
+    if (aes.run) {
+        aes_pump();
+        return;
+    }
+    MEM16(AES_STAT) &= ~AESBUSY;
+    MEM16(AES_CTL0) |= AESRDYIFG;
+    if (aes.in_n == 16) {
+        aes_block();    // Written while the one before was being encrypted.
+    }
+}
+
+// AESACTL1 written: with AESCMEN, a run of that many blocks.
+static void aes_start(uint16_t blocks)
+{
+    if (!(MEM16(AES_CTL0) & AESCMEN) || !(blocks & AESBLKCNT)) {
+        return;
+    }
+    aes.run = 1;
+    aes.blocks = blocks & AESBLKCNT;
+    aes.in_n = 0;
+    aes.out_n = 16;
+    MEM16(AES_STAT) |= AESBUSY;
+    aes_pump();
+}
+
+static void aes_reset(void)
+{
+    memset(&aes, 0, sizeof(aes));
+    aes.out_n = 16;
+    aes.done = SIM_NEVER;
+    MEM16(AES_CTL0) = 0;
+    MEM16(AES_CTL1) = 0;
+    MEM16(AES_STAT) = 0;
+}
+
+static uint16_t dma_read(const uint8_t *p, int byte)
+{
+    uint16_t a;
+
+    if ((p >= sim_mem) && (p < sim_mem + SIM_MEM_SIZE)) {
+        a = (uint16_t)(p - sim_mem);
+        if ((a & ~1u) == AES_DOUT) {
+            return byte ? aes_read() : (uint16_t)(aes_read() | (aes_read() << 8));
+        }
+    }
+    return byte ? *p : (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static void dma_write(uint8_t *p, uint16_t val, int byte)
+{
+    uint16_t a;
+
+    if ((p >= sim_mem) && (p < sim_mem + SIM_MEM_SIZE)) {
+        a = (uint16_t)(p - sim_mem);
+        if (a == UCA0_TXBUF) {
+            MEM16(UCA0_TXBUF) = val & 0xFF;
+            uart_start(val & 0xFF);
+            return;
+        }
+        if (aes_input(a & ~1u)) {
+            aes_write(a & ~1u, val & 0xFF);
+            if (!byte) {
+                aes_write(a & ~1u, val >> 8);
+            }
+            return;
+        }
+    }
+    p[0] = val & 0xFF;
+    if (!byte) {
+        p[1] = val >> 8;
+    }
+}
+
+static int dma_tsel(int n)
+{
+    return (n == 0) ? (MEM16(DMA_CTL0) & 0x1F) : (n == 1) ? ((MEM16(DMA_CTL0) >> 8) & 0x1F)
+         : (MEM16(DMA_CTL1) & 0x1F);
+}
+
+// One transfer of channel d.
+static void dma_transfer(sim_dma_t *d)
+{
+    uint16_t ctl = MEM16(d->base + DMA_CTL);
+    int src_byte = (ctl & DMASRCBYTE) != 0, dst_byte = (ctl & DMADSTBYTE) != 0;
+
+    dma_write(d->dst, dma_read(d->src, src_byte), dst_byte);
+    if ((ctl & DMASRCINCR_3) == DMASRCINCR_3) {
+        d->src += src_byte ? 1 : 2;
+    }
+    if ((ctl & DMADSTINCR_3) == DMADSTINCR_3) {
+        d->dst += dst_byte ? 1 : 2;
+    }
+    if (--MEM16(d->base + DMA_SZ) == 0) {
+        MEM16(d->base + DMA_SZ) = d->size;
+        if ((ctl & 0x7000) == DMADT_4) {
+            d->src = d->sa;     // Repeated single transfer: reloaded, still enabled.
+            d->dst = d->da;
+            MEM16(d->base + DMA_CTL) |= DMAIFG;
+        }
+        else {
+            MEM16(d->base + DMA_CTL) = (MEM16(d->base + DMA_CTL) & ~DMAEN) | DMAIFG;
+        }
+    }
+}
+
+/* A trigger: one transfer on each enabled channel waiting for it, channel 0 first. Returns
+ * the number of transfers. */
+static int dma_trigger(int trigger)
+{
+    int n, moved = 0;
+
+    for (n = 0; n < DMA_CHANNELS; n++) {
+        if ((MEM16(dma[n].base + DMA_CTL) & DMAEN) && (dma_tsel(n) == trigger) && dma[n].src
+                && dma[n].dst) {
+            dma_transfer(&dma[n]);
+            moved++;
+        }
+    }
+    return moved;
+}
+
+static void uart_finish(void)
+{
+    uart_done = SIM_NEVER;
+    if ((uart_fd >= 0) && (write(uart_fd, &uart_byte, 1) != 1)) {
+        perror("sim: uart");
+        uart_fd = -1;
+    }
+    sim_sh->uart_bytes++;
+    MEM16(UCA0_STATW) &= ~UCBUSY;
+    MEM16(UCA0_IFG) |= UCTXIFG;
+    dma_trigger(DMA0TSEL__UCA0TXIFG);
+}
+
+static void uart_reset(void)
+{
+    uart_done = SIM_NEVER;
+    MEM16(UCA0_STATW) = 0;
+    MEM16(UCA0_IFG) = UCTXIFG;
+}
+
+static void dma_reset(void)
+{
+    int n;
+
+    for (n = 0; n < DMA_CHANNELS; n++) {
+        dma[n].sa = dma[n].da = dma[n].src = dma[n].dst = NULL;
+    }
+}
+
+//***** ADC12_B ***************************************************************************
+
+static void adc_start(void)
+{
+    static const uint16_t sht[16] = {4, 8, 16, 32, 64, 96, 128, 192, 256, 384, 512, 512, 512,
+                                     512, 512, 512};
+
+    MEM16(ADC12_CTL0) &= ~ADC12SC;
+    MEM16(ADC12_CTL1) |= ADC12BUSY;
+    adc_done = sim_time + cycles_ps(sht[(MEM16(ADC12_CTL0) >> 8) & 0x0F] + ADC_CONV_CYCLES,
+                                    MODOSC_HZ);
+}
+
+static void adc_finish(void)
+{
+    uint16_t mctl = MEM16(ADC12_MCTL0);
+    uint16_t ref = MEM16(REFCTL0_ADDR);
+    unsigned bits = 8 + 2 * ((MEM16(ADC12_CTL2) >> 4) & 0x03);
+    double vin = 0.0, vref = sim_supply_v(sim_time), code;
+
+    adc_done = SIM_NEVER;
+    MEM16(ADC12_CTL1) &= ~ADC12BUSY;
+    if (!(MEM16(ADC12_CTL0) & ADC12ON)) {
+        return;
+    }
+    if (((mctl & 0x1F) == 31) && (MEM16(ADC12_CTL3) & ADC12BATMAP)) {
+        vin = sim_supply_v(sim_time) / 2;
+    }
+    if (mctl & 0x0F00) {
+        vref = !(ref & REFON) ? 0.0 : ((ref & 0x30) == REFVSEL_1) ? 2.0
+             : ((ref & 0x30) == REFVSEL_2) ? 2.5 : 1.2;
+    }
+    code = (vref > 0.0) ? vin / vref * (1u << bits) : 0.0;
+    MEM16(ADC12_MEM0) = (code >= (1u << bits)) ? (1u << bits) - 1 : (uint16_t) code;
+    MEM16(ADC12_IFGR0) |= ADC12IFG0;
+}
+
+static void adc_reset(void)
+{
+    adc_done = SIM_NEVER;
+}
+
+//***** CRC16, CRC32 **********************************************************************
+
+static uint8_t bit_reverse8(uint8_t b)
+{
+    b = (uint8_t)((b & 0xF0) >> 4 | (b & 0x0F) << 4);
+    b = (uint8_t)((b & 0xCC) >> 2 | (b & 0x33) << 2);
+    return (uint8_t)((b & 0xAA) >> 1 | (b & 0x55) << 1);
+}
+
+// A byte written to CRCDI, CRCDIRB or CRC32DIW0.
+static void crc_write(uint16_t a, uint8_t byte)
+{
+    uint32_t crc;
+    int k;
+
+    if (a == CRC32_DI) {
+        crc = MEM16(CRC32_INIRES0) | ((uint32_t) MEM16(CRC32_INIRES1) << 16);
+        crc ^= byte;
+        for (k = 0; k < 8; k++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        }
+        MEM16(CRC32_INIRES0) = (uint16_t) crc;
+        MEM16(CRC32_INIRES1) = (uint16_t)(crc >> 16);
+        return;
+    }
+    crc = MEM16(CRC_INIRES) ^ ((uint32_t)((a == CRC_DI) ? bit_reverse8(byte) : byte) << 8);
+    for (k = 0; k < 8; k++) {
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    MEM16(CRC_INIRES) = (uint16_t) crc;
+    MEM16(CRC_RESR) = (uint16_t)(bit_reverse8((uint8_t) crc) << 8 | bit_reverse8(crc >> 8));
+}
+
+//***** Register side effects *************************************************************
+
+static void settle(void)
+{
+    uint16_t a = pend.addr, val;
+    int n;
+
+    if (!pend.active) {
+        return;
+    }
+    pend.active = 0;
+    val = MEM16(a);
+
+    if (a == UCB1_TXBUF) {
+        spi_start(val & 0xFF);      // Only ever written.
+        return;
+    }
+    if (a == UCA0_TXBUF) {
+        uart_start(val & 0xFF);
+        return;
+    }
+    if (aes_input(a)) {
+        aes_write(a, val & 0xFF);   // Word writes, only ever written.
+        aes_write(a, val >> 8);
+        return;
+    }
+    if (a == AES_CTL1) {
+        aes_start(val);     // Only ever written, the same count twice is two runs.
+        return;
+    }
+    if ((a == CRC_DI) || (a == CRC_DIRB) || (a == CRC32_DI)) {
+        if (pend.byte) {
+            crc_write(a, (pend.byte == 2) ? val >> 8 : val & 0xFF);
+        }
+        else {
+            crc_write(a, val & 0xFF);
+            crc_write(a, val >> 8);
+        }
+        return;
+    }
+    if (val == pend.old) {
+        return;
+    }
+    if (a == FRCTL0_ADDR) {
+        clocks_update();
+        return;
+    }
+    if ((a >= CS_BASE) && (a <= CS_BASE + 0x0C)) {
+        for (n = 0; n < TIMERS; n++) {
+            timers[n].base_cnt = timer_count(&timers[n], sim_time);
+        }
+        clocks_update();
+        for (n = 0; n < TIMERS; n++) {
+            timer_set(&timers[n], timers[n].base_cnt);
+        }
+        return;
+    }
+    for (n = 0; n < TIMERS; n++) {
+        if ((a >= timers[n].base) && (a < timers[n].base + T_SIZE)) {
+            timer_write(&timers[n], a - timers[n].base, val);
+            return;
+        }
+    }
+    for (n = 0; n < DMA_CHANNELS; n++) {
+        if ((a == dma[n].base + DMA_CTL) && (val & DMAEN) && !(pend.old & DMAEN)) {
+            dma[n].size = MEM16(a + DMA_SZ);
+            dma[n].src = dma[n].sa;
+            dma[n].dst = dma[n].da;
+            return;
+        }
+    }
+    switch (a) {
+    case PORT_BASE + 0x02:          // P1OUT/P2OUT
+    case PORT_BASE + 0x04:          // P1DIR/P2DIR
+        latch_check();
+        break;
+    case PORT_BASE + 0x22:          // P3OUT/P4OUT
+    case PORT_BASE + 0x24:          // P3DIR/P4DIR
+        radio_sdn_update(1);
+        break;
+    case UCB1_CTLW0:
+        if (val & UCSWRST) {
+            spi_reset();
+        }
+        break;
+    case UCA0_CTLW0:
+        if (val & UCSWRST) {
+            uart_done = SIM_NEVER;
+            MEM16(UCA0_STATW) = 0;
+            MEM16(UCA0_IFG) = UCTXIFG;
+        }
+        break;
+    case UCA0_IFG:
+        if ((val & UCTXIFG) && !(pend.old & UCTXIFG)) {
+            dma_trigger(DMA0TSEL__UCA0TXIFG);   // Set by software, how a transfer is started.
+        }
+        break;
+    case AES_CTL0:
+        if (val & AESSWRST) {
+            aes_reset();
+        }
+        break;
+    case ADC12_CTL0:
+        if ((val & (ADC12ON | ADC12ENC | ADC12SC)) == (ADC12ON | ADC12ENC | ADC12SC)) {
+            adc_start();
+        }
+        break;
+    case REFCTL0_ADDR:
+        MEM16(a) = (val & REFON) ? (val | REFGENRDY) : (val & ~REFGENRDY);
+        break;
+    default:
+        break;
+    }
+}
+
+// Registers whose value depends on the moment they are read, or that change on reading.
+static void pre_access(uint16_t a)
+{
+    int n;
+
+    for (n = 0; n < TIMERS; n++) {
+        if (a == timers[n].base + T_R) {
+            MEM16(a) = timer_count(&timers[n], sim_time);
+            return;
+        }
+        if (a == timers[n].base + T_IV) {
+            MEM16(a) = timer_iv(&timers[n]);
+            return;
+        }
+    }
+    for (n = 1; n <= 4; n++) {
+        if (a == port_iv_addr(n)) {
+            MEM16(a) = port_iv(n);
+            return;
+        }
+    }
+    if (a == UCB1_RXBUF) {
+        MEM16(UCB1_IFG) &= ~UCRXIFG;
+    }
+    else if (a == ADC12_MEM0) {
+        MEM16(ADC12_IFGR0) &= ~ADC12IFG0;
+    }
+    else if (a == DMA_IV) {
+        MEM16(a) = DMAIV_NONE;
+        for (n = 0; n < DMA_CHANNELS; n++) {
+            if ((MEM16(dma[n].base + DMA_CTL) & (DMAIE | DMAIFG)) == (DMAIE | DMAIFG)) {
+                MEM16(a) = 2 * (n + 1);
+                MEM16(dma[n].base + DMA_CTL) &= ~DMAIFG;
+                break;
+            }
+        }
+    }
+    else if (a == AES_DOUT) {
+        MEM16(a) = aes_read();
+        MEM16(a) |= aes_read() << 8;
+    }
+    else if (a == UCB1_IV) {
+        uint16_t f = MEM16(UCB1_IFG) & MEM16(UCB1_IE);
+        MEM16(a) = (f & UCRXIFG) ? 2 : ((f & UCTXIFG) ? 4 : 0);
+        MEM16(UCB1_IFG) &= ~((f & UCRXIFG) ? UCRXIFG : 0);
+    }
+}
+
+//***** Events and interrupts *************************************************************
+
+static uint64_t next_event(void)
+{
+    uint64_t t = t_death;
+    int n;
+
+#define EARLIER(x)  if ((x) < t) t = (x)
+    EARLIER(sim_cfg.duration);
+    EARLIER(comp_next);
+    EARLIER(store_next);
+    EARLIER(spi_done);
+    EARLIER(adc_done);
+    EARLIER(uart_done);
+    EARLIER(aes.done);
+    EARLIER(sim_radio_next_event());
+    if (det_input()) {
+        EARLIER(sim_radio_next_detect());
+    }
+    for (n = 0; n < TIMERS; n++) {
+        EARLIER(timers[n].next_ps);
+    }
+#undef EARLIER
+    return t;
+}
+
+static void process_events(void)
+{
+    int n;
+
+    for (n = 0; n < TIMERS; n++) {
+        timer_process(&timers[n]);
+    }
+    if (comp_next <= sim_time) {
+        comp = !comp;
+        port_input(4, COMP_BIT, comp, 1);
+        comp_schedule();
+    }
+    if (store_next <= sim_time) {
+        store_check();
+    }
+    if (spi_done <= sim_time) {
+        spi_finish();
+    }
+    if (adc_done <= sim_time) {
+        adc_finish();
+    }
+    if (uart_done <= sim_time) {
+        uart_finish();
+    }
+    if (aes.done <= sim_time) {
+        aes_finish();
+    }
+    sim_radio_update();
+    radio_pins(1);
+}
+
+static int pending(const sim_vector_t *v)
+{
+    uint16_t base = timers[v->unit].base;
+    uint16_t c0, c1, c2, ctl;
+    int n;
+
+    switch (v->src) {
+    case SRC_TIMER0:
+        c0 = MEM16(base + T_CCTL(0));
+        return (c0 & CCIE) && (c0 & CCIFG);
+    case SRC_TIMER1:
+        c1 = MEM16(base + T_CCTL(1));
+        c2 = MEM16(base + T_CCTL(2));
+        ctl = MEM16(base + T_CTL);
+        return ((c1 & CCIE) && (c1 & CCIFG)) || ((c2 & CCIE) && (c2 & CCIFG))
+                || ((ctl & TAIE) && (ctl & TAIFG));
+    case SRC_PORT:
+        return MEM8(port_reg(v->unit, 0x1C)) & MEM8(port_reg(v->unit, 0x1A));
+    case SRC_UCB1:
+        return MEM16(UCB1_IFG) & MEM16(UCB1_IE);
+    case SRC_DMA:
+        for (n = 0; n < DMA_CHANNELS; n++) {
+            if ((MEM16(dma[n].base + DMA_CTL) & (DMAIE | DMAIFG)) == (DMAIE | DMAIFG)) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+    return 0;
+}
+
+static void discard(const sim_vector_t *v)
+{
+    uint16_t base = timers[v->unit].base;
+    int n;
+
+    switch (v->src) {
+    case SRC_TIMER0:
+        MEM16(base + T_CCTL(0)) &= ~CCIFG;
+        break;
+    case SRC_TIMER1:
+        MEM16(base + T_CCTL(1)) &= ~CCIFG;
+        MEM16(base + T_CCTL(2)) &= ~CCIFG;
+        MEM16(base + T_CTL) &= ~TAIFG;
+        break;
+    case SRC_PORT:
+        MEM8(port_reg(v->unit, 0x1C)) = 0;
+        break;
+    case SRC_UCB1:
+        MEM16(UCB1_IE) = 0;
+        break;
+    case SRC_DMA:
+        for (n = 0; n < DMA_CHANNELS; n++) {
+            MEM16(dma[n].base + DMA_CTL) &= ~DMAIFG;
+        }
+        break;
+    }
+}
+
+// Take the highest priority pending interrupt, if interrupts are enabled.
+static int dispatch(void)
+{
+    const sim_vector_t *v;
+    int ram;
+
+    if (!(sr & GIE)) {
+        return 0;
+    }
+    for (v = vectors; v < vectors + VECTORS; v++) {
+        if (pending(v)) {
+            break;
+        }
+    }
+    if (v == vectors + VECTORS) {
+        return 0;
+    }
+    if (!v->isr) {
+        discard(v);
+        sim_sh->unhandled++;
+        if (!(unhandled_seen & (1ul << (v - vectors)))) {
+            unhandled_seen |= 1ul << (v - vectors);
+            fprintf(stderr, "sim: %s interrupt without an ISR, flag cleared\n", v->name);
+        }
+        return 1;
+    }
+    if (depth == ISR_NESTING_MAX) {
+        fprintf(stderr, "sim: interrupts nested too deep\n");
+        abort();
+    }
+    if (v->src == SRC_TIMER0) {
+        MEM16(timers[v->unit].base + T_CCTL(0)) &= ~CCIFG;  // Single source, cleared on entry.
+    }
+    sr_saved[depth++] = sr;
+    sr &= SCG0;
+    ram = ram_code;
+    ram_code = 0;
+    run(sim_time + cycles_ps(ISR_ENTRY_CYCLES, f_cpu));
+    v->isr();
+    settle();
+    ram_code = 0;
+    run(sim_time + cycles_ps(ISR_EXIT_CYCLES, f_cpu));
+    sr = sr_saved[--depth];
+    ram_code = ram;
+    return 1;
+}
+
+// Run until the given time, handling events and interrupts on the way.
+static void run(uint64_t until)
+{
+    for (;;) {
+        uint64_t t;
+
+        while (dispatch())
+            ;
+        t = next_event();
+        if (t > until) {
+            break;
+        }
+        advance(t);
+        process_events();
+    }
+    advance(until);
+}
+
+// Low-power mode: wait for events until an ISR clears CPUOFF on exit.
+static void sleep_lpm(void)
+{
+    while (sr & CPUOFF) {
+        if (dispatch()) {
+            continue;
+        }
+        advance(next_event());
+        process_events();
+    }
+}
+
+//***** Hooks called through msp430.h *****************************************************
+
+extern const char __start_sim_ramfunc[] __attribute__((weak));
+extern const char __stop_sim_ramfunc[] __attribute__((weak));
+
+// Cycle rate of the code at pc, and whether it runs from RAM.
+static uint32_t code_hz(const void *pc)
+{
+    ram_code = __start_sim_ramfunc && ((const char *) pc >= __start_sim_ramfunc)
+               && ((const char *) pc < __stop_sim_ramfunc);
+    return ram_code ? f_mclk : f_cpu;
+}
+
+static void *reg_access(uint16_t addr, int byte, const void *pc)
+{
+    settle();
+    run(sim_time + cycles_ps(ACCESS_CYCLES, code_hz(pc)));
+    pre_access(addr & ~1u);
+    pend.addr = addr & ~1u;
+    pend.old = MEM16(pend.addr);
+    pend.byte = byte ? 1 + (addr & 1) : 0;
+    pend.active = 1;
+    return &sim_mem[addr];
+}
+
+void *sim_reg(uint16_t addr)
+{
+    return reg_access(addr, 0, __builtin_return_address(0));
+}
+
+void *sim_reg8(uint16_t addr)
+{
+    return reg_access(addr, 1, __builtin_return_address(0));
+}
+
+void sim_cycles(uint32_t n)
+{
+    settle();
+    run(sim_time + cycles_ps(n, code_hz(__builtin_return_address(0))));
+}
+
+void sim_bis_sr(uint16_t bits)
+{
+    settle();
+    sr |= bits;
+    if (sr & CPUOFF) {
+        sleep_lpm();
+    }
+    else {
+        run(sim_time);      // Take interrupts that were waiting for GIE.
+    }
+}
+
+void sim_bic_sr(uint16_t bits)
+{
+    settle();
+    sr &= ~bits;
+}
+
+void sim_bis_sr_on_exit(uint16_t bits)
+{
+    if (depth) {
+        sr_saved[depth - 1] |= bits;
+    }
+}
+
+void sim_bic_sr_on_exit(uint16_t bits)
+{
+    if (depth) {
+        sr_saved[depth - 1] &= ~bits;
+    }
+}
+
+// DMA address registers, see __data16_write_addr in msp430.h.
+void sim_write_addr(uint16_t reg, uintptr_t addr)
+{
+    uint8_t *p = (uint8_t *) addr;
+    int n;
+
+    pend.active = 0;    // Left by taking the registers' addresses, not an access.
+    run(sim_time + cycles_ps(ACCESS_CYCLES, code_hz(__builtin_return_address(0))));
+    if ((p >= sim_mem) && (p < sim_mem + SIM_MEM_SIZE)) {
+        addr = (uintptr_t)(p - sim_mem);    // A register or device memory.
+    }
+    reg &= ~1u;
+    MEM16(reg) = (uint16_t) addr;
+    for (n = 0; n < DMA_CHANNELS; n++) {
+        if (reg == dma[n].base + DMA_SA) {
+            dma[n].sa = p;
+        }
+        else if (reg == dma[n].base + DMA_DA) {
+            dma[n].da = p;
+        }
+    }
+}
+
+int sim_uart_open(const char *path)
+{
+    uart_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (uart_fd < 0) {
+        perror(path);
+        return -1;
+    }
+    return 0;
+}
+
+uint16_t sim_get_sr(void)
+{
+    return sr;
+}
+
+void sim_phase(int p)
+{
+    if (p == SIM_PHASE_CHECKPOINT) {
+        sim_sh->ckpt_started++;
+    }
+    phase = p;
+}
+
+//***** Power cycles **********************************************************************
+
+void sim_cpu_boot(void)
+{
+    int n;
+
+    memset(sim_mem, 0, SIM_FRAM_START);
+    MEM16(CS_BASE + 0x02) = 0x000C;     // DCO 8MHz
+    MEM16(CS_BASE + 0x04) = 0x0033;     // ACLK = LFXT, SMCLK = MCLK = DCO
+    MEM16(CS_BASE + 0x06) = 0x0033;     // SMCLK/8, MCLK/8
+    MEM16(0x0130) = LOCKLPM5;
+    MEM16(0x015C) = 0x6904;
+    MEM16(CRC_INIRES) = 0xFFFF;
+    MEM16(CRC_RESR) = 0xFFFF;
+    MEM16(CRC32_INIRES0) = 0xFFFF;
+    MEM16(CRC32_INIRES1) = 0xFFFF;
+    MEM16(UCB1_CTLW0) = 0x01C1;
+    MEM16(UCA0_CTLW0) = UCSWRST;
+    sr = 0;
+    depth = 0;
+    phase = SIM_PHASE_APP;
+    pend.active = 0;
+    clocks_update();
+    for (n = 0; n < TIMERS; n++) {
+        timer_set(&timers[n], 0);
+    }
+    spi_reset();
+    uart_reset();
+    dma_reset();
+    aes_reset();
+    adc_reset();
+    supply_init();
+    comp_init();
+    sim_radio_reset();
+    radio_pins(0);
+}
+
+void sim_cpu_freeze(void)
+{
+    int n;
+
+    settle();
+    for (n = 0; n < TIMERS; n++) {
+        timer_set(&timers[n], timer_count(&timers[n], sim_time));
+    }
+}
+
+void sim_cpu_resumed(void)
+{
+    int n;
+
+    sim_time = sim_sh->now;
+    pend.active = 0;
+    phase = SIM_PHASE_RESTORE;
+    for (n = 0; n < TIMERS; n++) {
+        timer_set(&timers[n], timers[n].base_cnt);
+    }
+    spi_reset();
+    uart_reset();
+    dma_reset();
+    aes_reset();
+    adc_reset();
+    supply_init();
+    comp_init();
+    sim_radio_reset();
+    radio_sdn_update(0);
+}
+
+void sim_halt(void)
+{
+    settle();
+    phase = SIM_PHASE_HALTED;
+    for (;;) {
+        run(SIM_NEVER - 1);
+    }
+}
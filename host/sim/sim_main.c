@@ -0,0 +1,662 @@
+/*
+ * Host intermittent-power simulator, harness, by P. Krawiec.
+ *
+ * Powers the node up and down along a supply voltage trace and reports forward progress,
+ * checkpoints and wasted re-execution. See host/readme.txt for usage.
+ *
+ * Each power-up runs the application's main() (renamed firmware_main by the Makefile) in
+ * a child process. The harness waits for it to die (brown-out, supply latch released or
+ * end of the run) and then picks the next power-up time from the wake-up policy:
+ *   supply: when the trace reaches v_on, or v_comp after the firmware released the latch
+ *           (the comparator re-enables the supply);
+ *   rf:     at the end of the next packet in the --air-in log, if the supply is above v_on.
+ * With a storage capacitor (--cap, see sim_power.c) the supply is its voltage, charged by
+ * the trace while the node is off: the node powers up when it reaches v_on, after a latch
+ * release only once the trace has also reached v_comp.
+ *
+ * Time accounting: "progress" is the application time along the current line of execution.
+ * A snapshot (or task commit) records it, a restore of that snapshot (or a task restarting
+ * from the commit) winds it back, and the application time in between becomes wasted
+ * re-execution. A power-up with nothing to resume starts the application over, all of its
+ * progress is wasted. Forward progress is application time less wasted time. Hibernus can keep two
+ * snapshots, a full image (slot 0) and a delta on top of it (slot 1).
+ *
+ * Wake-up latency: the firmware marks the stages of its wake-up (SIM_MARK()). Each power-up
+ * records the first time it reaches each stage, from the start of the packet that woke it
+ * (rf) or from the power-up (supply). The report gives, per stage, the distribution over the
+ * power-ups of the time since the stage before it.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "sim.h"
+
+#define SEM_POLL_MS     10      ///< See sem_wait_poll().
+
+int firmware_main(void);
+
+// Bounds of the SIM_FRAM section, provided by the linker.
+extern uint8_t __start_sim_fram[] __attribute__((weak));
+extern uint8_t __stop_sim_fram[] __attribute__((weak));
+
+sim_config_t sim_cfg = {
+    2.0, 1.8, 2.5, 0.05,    // v_on, v_off, v_comp, hyst
+    0.0, 100.0,             // no storage capacitor, source resistance
+    9400,                   // VLO
+    300 * SIM_PS_PER_S,     // duration
+    SIM_WAKE_SUPPLY,
+    0x60,                   // RSSI
+    0.0, 1,                 // no packet loss, seed
+    0.0, 0.0,               // no bit errors: corrupted packets, bit error rate
+    0
+};
+
+sim_shared_t *sim_sh;
+
+static const char *phase_names[SIM_PHASES] = {"app", "checkpoint", "restore", "halted"};
+
+//***** FRAM variables ********************************************************************
+
+static size_t fram_vars_size(void)
+{
+    return __start_sim_fram ? (size_t)(__stop_sim_fram - __start_sim_fram) : 0;
+}
+
+static void fram_vars_load(void)
+{
+    memcpy(__start_sim_fram, sim_sh->fram_vars, sim_sh->fram_vars_size);
+}
+
+static void fram_vars_flush(void)
+{
+    memcpy(sim_sh->fram_vars, __start_sim_fram, sim_sh->fram_vars_size);
+}
+
+//***** Node life cycle *******************************************************************
+
+/*
+ * sem_wait() on a process-shared semaphore, but waking every SEM_POLL_MS to look at it again:
+ * a wake-up has been seen to get lost (value 1, the waiter still asleep in the kernel) after
+ * frozen images waiting on the same semaphore were killed. Gives up after timeout_ms if it
+ * is not negative. Returns 0 once the semaphore is taken, -1 on timeout.
+ */
+static int sem_wait_poll(sem_t *sem, long timeout_ms)
+{
+    struct timespec ts;
+    long waited = 0;
+
+    for (;;) {
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += SEM_POLL_MS * 1000000L;
+        if (ts.tv_nsec >= 1000000000L) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        if (!sem_timedwait(sem, &ts)) {
+            return 0;
+        }
+        if (errno == ETIMEDOUT) {
+            waited += SEM_POLL_MS;
+            if ((timeout_ms >= 0) && (waited >= timeout_ms)) {
+                return -1;
+            }
+        }
+        else if (errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+void sim_log(const char *fmt, ...)
+{
+    va_list ap;
+
+    if (!sim_cfg.verbose) {
+        return;
+    }
+    fprintf(stderr, "[%11.6f] ", (double) sim_time / SIM_PS_PER_S);
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+}
+
+void sim_die(sim_end_t end)
+{
+    static const char *why[] = {"brown-out", "latch released", "end of run"};
+
+    fram_vars_flush();
+    if (end == SIM_END_BROWNOUT) {
+        sim_sh->brownouts++;
+    }
+    else if (end == SIM_END_LATCH) {
+        sim_sh->latch_offs++;
+    }
+    sim_log("power off: %s", why[end]);
+    sim_sh->now = sim_time;
+    sim_sh->end = end;
+    fflush(NULL);
+    sem_post(&sim_sh->done);
+    _exit(0);
+}
+
+static void rewind_to(int slot)
+{
+    sim_sh->wasted += sim_sh->progress - sim_sh->progress_at[slot];
+    sim_sh->progress = sim_sh->progress_at[slot];
+}
+
+int sim_snapshot(int slot)
+{
+    pid_t pid;
+
+    sim_cpu_freeze();
+    if (sim_sh->image[slot]) {
+        kill(sim_sh->image[slot], SIGKILL);
+        sim_sh->image[slot] = 0;
+    }
+    fflush(NULL);
+    pid = fork();
+    if (pid < 0) {
+        perror("sim: fork");
+        return 0;
+    }
+    if (pid == 0) {
+        // Frozen image. Each restore runs in a fresh copy, so it can be restored again.
+        for (;;) {
+            sem_wait_poll(&sim_sh->resume[slot], -1);
+            if (fork() == 0) {
+                break;
+            }
+        }
+        sim_sh->running = getpid();
+        fram_vars_load();
+        sim_cpu_resumed();
+        sim_log("resumed from checkpoint%s", slot ? " (delta)" : "");
+        return 1;
+    }
+    sim_sh->image[slot] = pid;
+    sim_sh->ckpt_done++;
+    sim_sh->progress_at[slot] = sim_sh->progress;
+    sim_sh->last_slot = slot;
+    sim_log("checkpoint%s", slot ? " (delta)" : "");
+    return 0;
+}
+
+void sim_resume(int slot)
+{
+    if (!sim_sh->image[slot]) {
+        sim_sh->restores_failed++;
+        sim_log("restore failed, no checkpoint");
+        return;
+    }
+    fram_vars_flush();
+    sim_sh->restores++;
+    rewind_to(slot);
+    sim_sh->now = sim_time;
+    fflush(NULL);
+    sem_post(&sim_sh->resume[slot]);
+    _exit(0);
+}
+
+void sim_commit(void)
+{
+    sim_sh->ckpt_done++;
+    sim_sh->progress_at[0] = sim_sh->progress;
+    sim_sh->last_slot = 0;
+}
+
+void sim_rollback(void)
+{
+    sim_sh->restores++;
+    rewind_to(0);
+    sim_log("restarting from the last commit");
+}
+
+void sim_restart(void)
+{
+    int n;
+
+    if (sim_sh->progress) {
+        sim_sh->wasted += sim_sh->progress;
+        sim_sh->progress = 0;
+        sim_log("starting over, nothing to resume");
+    }
+    // Snapshots left from the old line of execution (incomplete images) count from here.
+    for (n = 0; n < SIM_SLOTS; n++) {
+        sim_sh->progress_at[n] = 0;
+    }
+}
+
+static void kill_images(void)
+{
+    int n;
+
+    for (n = 0; n < SIM_SLOTS; n++) {
+        if (sim_sh->image[n]) {
+            kill(sim_sh->image[n], SIGKILL);
+        }
+    }
+}
+
+static void node(void)
+{
+    sim_sh->running = getpid();
+    sim_time = sim_sh->now;
+    fram_vars_load();
+    sim_cpu_boot();
+    sim_log("power on");
+    sim_mark("power-up");
+    firmware_main();
+    sim_log("main() returned");
+    sim_halt();
+}
+
+//***** Wake-up latency ******************************************************************
+
+void sim_mark(const char *stage)
+{
+    unsigned long boot = sim_sh->boots - 1;
+    int k;
+
+    if (boot >= SIM_MARK_BOOTS) {
+        return;
+    }
+    for (k = 0; (k < sim_sh->marks) && strcmp(sim_sh->mark_name[k], stage); k++)
+        ;
+    if (k == sim_sh->marks) {
+        if (k == SIM_MARKS) {
+            return;
+        }
+        snprintf(sim_sh->mark_name[k], SIM_MARK_NAME, "%s", stage);
+        sim_sh->marks++;
+    }
+    if (sim_sh->mark_at[boot][k] == SIM_NEVER) {
+        sim_sh->mark_at[boot][k] = sim_time;
+    }
+}
+
+static void mark_boot(uint64_t t)
+{
+    unsigned long boot = sim_sh->boots - 1;
+    int k;
+
+    if (boot >= SIM_MARK_BOOTS) {
+        return;
+    }
+    sim_sh->mark_ref[boot] = (sim_cfg.wake == SIM_WAKE_RF) ? sim_radio_packet_start(t) : t;
+    for (k = 0; k < SIM_MARKS; k++) {
+        sim_sh->mark_at[boot][k] = SIM_NEVER;
+    }
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+
+    return (x > y) - (x < y);
+}
+
+static void mark_row(const char *name, double *ms, int n)
+{
+    if (!n) {
+        printf("%-14s %6d\n", name, 0);
+        return;
+    }
+    qsort(ms, n, sizeof(*ms), cmp_double);
+    printf("%-14s %6d %10.3f %10.3f %10.3f %10.3f\n", name, n, ms[0], ms[n / 2],
+           ms[(n * 9) / 10], ms[n - 1]);
+}
+
+// Per stage: time since the last stage reached before it (or the start), over the power-ups.
+static void mark_report(void)
+{
+    static double ms[SIM_MARK_BOOTS];
+    unsigned long boots = (sim_sh->boots < SIM_MARK_BOOTS) ? sim_sh->boots : SIM_MARK_BOOTS;
+    unsigned long b;
+    int k, j, n;
+
+    if (sim_sh->marks < 2) {
+        return;     // Only the harness's "power-up".
+    }
+    printf("\n%-14s %6s %10s %10s %10s %10s\n", "wake-up [ms]", "n", "min", "median", "p90",
+           "max");
+    for (k = 0; k < sim_sh->marks; k++) {
+        for (b = 0, n = 0; b < boots; b++) {
+            uint64_t from = sim_sh->mark_ref[b];
+
+            if (sim_sh->mark_at[b][k] == SIM_NEVER) {
+                continue;
+            }
+            for (j = k - 1; j >= 0; j--) {
+                if (sim_sh->mark_at[b][j] != SIM_NEVER) {
+                    from = sim_sh->mark_at[b][j];
+                    break;
+                }
+            }
+            ms[n++] = (double)(sim_sh->mark_at[b][k] - from) * 1e3 / SIM_PS_PER_S;
+        }
+        mark_row(sim_sh->mark_name[k], ms, n);
+    }
+    k = sim_sh->marks - 1;
+    for (b = 0, n = 0; b < boots; b++) {
+        if (sim_sh->mark_at[b][k] != SIM_NEVER) {
+            ms[n++] = (double)(sim_sh->mark_at[b][k] - sim_sh->mark_ref[b]) * 1e3 / SIM_PS_PER_S;
+        }
+    }
+    mark_row("total", ms, n);
+}
+
+//***** Harness ***************************************************************************
+
+static uint64_t next_boot(uint64_t t, sim_end_t last)
+{
+    if (sim_cfg.wake == SIM_WAKE_RF) {
+        for (;;) {
+            t = sim_radio_next_packet_end(t);
+            if (t == SIM_NEVER) {
+                return t;
+            }
+            sim_store_draw(t, 0.0);
+            if (sim_supply_v(t) >= sim_cfg.v_on) {
+                return t;
+            }
+        }
+    }
+    if (sim_store()) {
+        return sim_store_charge(t, sim_cfg.v_on, (last == SIM_END_LATCH) ? sim_cfg.v_comp : 0.0);
+    }
+    return sim_trace_cross(t, (last == SIM_END_LATCH) ? sim_cfg.v_comp : sim_cfg.v_on, 1);
+}
+
+static int wait_done(int timeout_s)
+{
+    return sem_wait_poll(&sim_sh->done, timeout_s * 1000L);
+}
+
+static double sec(uint64_t ps)
+{
+    return (double) ps / SIM_PS_PER_S;
+}
+
+static void report(uint64_t end)
+{
+    uint64_t on = 0, active = 0, overhead;
+    int p;
+
+    for (p = 0; p < SIM_PHASES; p++) {
+        on += sim_sh->active[p] + sim_sh->sleep[p];
+        active += sim_sh->active[p];
+    }
+    overhead = sim_sh->active[SIM_PHASE_CHECKPOINT] + sim_sh->sleep[SIM_PHASE_CHECKPOINT]
+             + sim_sh->active[SIM_PHASE_RESTORE] + sim_sh->sleep[SIM_PHASE_RESTORE];
+
+    printf("simulated time        %12.3f s\n", sec(end));
+    printf("powered time          %12.3f s\n", sec(on));
+    printf("power-ups             %12lu  (brown-outs %lu, latch releases %lu)\n",
+           sim_sh->boots, sim_sh->brownouts, sim_sh->latch_offs);
+    printf("checkpoints           %12lu  (started %lu)\n", sim_sh->ckpt_done,
+           sim_sh->ckpt_started);
+    printf("restores              %12lu  (failed %lu)\n", sim_sh->restores,
+           sim_sh->restores_failed);
+    printf("radio packets         %12lu tx %lu rx", sim_sh->radio_tx, sim_sh->radio_rx);
+    if (sim_sh->radio_rx && sim_sh->boots) {
+        printf("  (%.2f rx per power-up)", (double) sim_sh->radio_rx / sim_sh->boots);
+    }
+    printf("\n");
+    printf("radio energy          %12.3f mJ\n", sim_sh->radio_energy * 1e3);
+    if (sim_sh->air_packets) {
+        printf("packets on air        %12lu  (collided %lu, lost %lu", sim_sh->air_packets,
+               sim_sh->air_collided, sim_sh->air_lost);
+        if ((sim_cfg.corrupt > 0.0) || (sim_cfg.ber > 0.0)) {
+            printf(", corrupted %lu, %lu of them received", sim_sh->air_corrupted,
+                   sim_sh->radio_rx_bad);
+        }
+        printf(")\n");
+    }
+    if (sim_sh->radio_baud_lost) {
+        printf("RF baud changes lost  %12lu  (SDN pulse too short)\n", sim_sh->radio_baud_lost);
+    }
+    if (sim_sh->uart_bytes) {
+        printf("UART bytes sent       %12lu\n", sim_sh->uart_bytes);
+    }
+    if (sim_store()) {
+        printf("storage capacitor     %12.3f V at the end\n", sim_sh->v_store);
+    }
+    if (sim_sh->unhandled) {
+        printf("unhandled interrupts  %12lu\n", sim_sh->unhandled);
+    }
+    if (sim_sh->fram_errors || sim_sh->spi_errors) {
+        printf("clock errors          %12lu FRAM %lu SPI\n", sim_sh->fram_errors,
+               sim_sh->spi_errors);
+    }
+
+    printf("\n%-12s %14s %14s %14s\n", "phase", "active [s]", "asleep [s]", "energy [mJ]");
+    for (p = 0; p < SIM_PHASES; p++) {
+        printf("%-12s %14.6f %14.6f %14.6f\n", phase_names[p], sec(sim_sh->active[p]),
+               sec(sim_sh->sleep[p]), sim_sh->energy[p] * 1e3);
+    }
+
+    printf("\napplication time      %12.3f s\n", sec(sim_sh->app));
+    printf("wasted re-execution   %12.3f s  (rolled back by restores)\n", sec(sim_sh->wasted));
+    printf("not yet rolled back   %12.3f s  (after the last checkpoint)\n",
+           sec(sim_sh->progress - sim_sh->progress_at[sim_sh->last_slot]));
+    printf("forward progress      %12.3f s  (%.1f%% of application time)\n",
+           sec(sim_sh->app - sim_sh->wasted),
+           sim_sh->app ? 100.0 * (sim_sh->app - sim_sh->wasted) / sim_sh->app : 0.0);
+    printf("checkpoint + restore  %12.6f s  (%.3f%% of powered time)\n", sec(overhead),
+           on ? 100.0 * overhead / on : 0.0);
+    printf("CPU active            %12.3f s  (%.2f%% of powered time)\n", sec(active),
+           on ? 100.0 * active / on : 0.0);
+    mark_report();
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "usage: %s -t <trace> [options]\n"
+        "  -t, --trace <file>     supply voltage trace, \"<t [s]> <V>\" per line\n"
+        "  -d, --duration <s>     length of the run (default 300)\n"
+        "      --von <V>          power-up voltage (default 2.0)\n"
+        "      --voff <V>         brown-out voltage (default 1.8)\n"
+        "      --vcomp <V>        comparator threshold on P4.1 (default 2.5)\n"
+        "      --hyst <V>         comparator hysteresis (default 0.05)\n"
+        "      --cap <F>          run from a storage capacitor charged by the trace\n"
+        "      --rsrc <ohm>       harvester source resistance, with --cap (default 100)\n"
+        "      --vlo <Hz>         VLO frequency (default 9400)\n"
+        "      --wake supply|rf   power-up policy (default supply)\n"
+        "      --air-in <file>    packets on air, received by this node, once per\n"
+        "                         transmitter; <file>:<n> gives its packets RSSI n\n"
+        "      --air-out <file>   log of packets sent by this node\n"
+        "      --rssi <n>         RSSI byte of received packets (default 96)\n"
+        "      --loss <p>         fraction of the packets on air lost (default 0)\n"
+        "      --corrupt <p>      fraction of the packets on air with a bit error (default 0)\n"
+        "      --ber <p>          bit error rate of the packets on air (default 0)\n"
+        "      --seed <n>         of the losses and bit errors (default 1)\n"
+        "      --rf-bps <b>=<bps> bit rate of RF baud index b, for air times\n"
+        "      --fram-out <file>  FRAM variables (SIM_FRAM) at the end of the run, raw\n"
+        "      --uart <file>      bytes sent on eUSCI_A0, to a file or FIFO\n"
+        "      --timeout <s>      wall-clock limit per power-up (default 60)\n"
+        "  -v, --verbose          log power cycles, checkpoints and restores\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option opts[] = {
+        {"trace", required_argument, 0, 't'},
+        {"duration", required_argument, 0, 'd'},
+        {"von", required_argument, 0, 1},
+        {"voff", required_argument, 0, 2},
+        {"vcomp", required_argument, 0, 3},
+        {"hyst", required_argument, 0, 4},
+        {"vlo", required_argument, 0, 5},
+        {"wake", required_argument, 0, 6},
+        {"air-in", required_argument, 0, 7},
+        {"air-out", required_argument, 0, 8},
+        {"rssi", required_argument, 0, 9},
+        {"timeout", required_argument, 0, 10},
+        {"cap", required_argument, 0, 11},
+        {"rsrc", required_argument, 0, 12},
+        {"loss", required_argument, 0, 13},
+        {"seed", required_argument, 0, 14},
+        {"rf-bps", required_argument, 0, 15},
+        {"fram-out", required_argument, 0, 16},
+        {"uart", required_argument, 0, 17},
+        {"corrupt", required_argument, 0, 18},
+        {"ber", required_argument, 0, 19},
+        {"verbose", no_argument, 0, 'v'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+    const char *trace = NULL, *fram_out = NULL;
+    int timeout_s = 60;
+    uint64_t t = 0;
+    sim_end_t last = SIM_END_BROWNOUT;
+    int c, n;
+
+    while ((c = getopt_long(argc, argv, "t:d:vh", opts, NULL)) != -1) {
+        switch (c) {
+        case 't': trace = optarg; break;
+        case 'd': sim_cfg.duration = (uint64_t)(atof(optarg) * SIM_PS_PER_S); break;
+        case 1: sim_cfg.v_on = atof(optarg); break;
+        case 2: sim_cfg.v_off = atof(optarg); break;
+        case 3: sim_cfg.v_comp = atof(optarg); break;
+        case 4: sim_cfg.hyst = atof(optarg); break;
+        case 5: sim_cfg.vlo_hz = (uint32_t) atol(optarg); break;
+        case 6:
+            if (!strcmp(optarg, "rf")) {
+                sim_cfg.wake = SIM_WAKE_RF;
+            }
+            else if (strcmp(optarg, "supply")) {
+                usage(argv[0]);
+                return 2;
+            }
+            break;
+        case 7:
+            if (sim_radio_load(optarg)) {
+                return 1;
+            }
+            break;
+        case 8:
+            if (sim_radio_open_log(optarg)) {
+                return 1;
+            }
+            break;
+        case 9: sim_cfg.rssi = (uint8_t) atoi(optarg); break;
+        case 10: timeout_s = atoi(optarg); break;
+        case 11: sim_cfg.cap = atof(optarg); break;
+        case 12: sim_cfg.rsrc = atof(optarg); break;
+        case 13: sim_cfg.loss = atof(optarg); break;
+        case 14: sim_cfg.seed = (uint32_t) strtoul(optarg, NULL, 0); break;
+        case 15:
+            if (sim_radio_set_bps(optarg)) {
+                usage(argv[0]);
+                return 2;
+            }
+            break;
+        case 16: fram_out = optarg; break;
+        case 17:
+            if (sim_uart_open(optarg)) {
+                return 1;
+            }
+            break;
+        case 18: sim_cfg.corrupt = atof(optarg); break;
+        case 19: sim_cfg.ber = atof(optarg); break;
+        case 'v': sim_cfg.verbose = 1; break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if ((sim_cfg.cap < 0.0) || (sim_store() && (sim_cfg.rsrc <= 0.0)) || (sim_cfg.loss < 0.0)
+            || (sim_cfg.loss > 1.0) || (sim_cfg.corrupt < 0.0) || (sim_cfg.corrupt > 1.0)
+            || (sim_cfg.ber < 0.0) || (sim_cfg.ber > 0.5)) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (!trace || sim_trace_load(trace)) {
+        if (!trace) {
+            usage(argv[0]);
+        }
+        return 2;
+    }
+
+    // State shared with the node processes.
+    sim_sh = mmap(NULL, sizeof(*sim_sh), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+                  -1, 0);
+    if ((sim_sh == MAP_FAILED)
+            || (mmap(&sim_mem[SIM_FRAM_START], SIM_MEM_SIZE - SIM_FRAM_START,
+                     PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS | MAP_FIXED, -1, 0)
+                == MAP_FAILED)) {
+        perror("sim: mmap");
+        return 1;
+    }
+    memset(&sim_mem[SIM_FRAM_START], 0xFF, SIM_MEM_SIZE - SIM_FRAM_START);   // Erased FRAM.
+    sem_init(&sim_sh->done, 1, 0);
+    for (n = 0; n < SIM_SLOTS; n++) {
+        sem_init(&sim_sh->resume[n], 1, 0);
+    }
+    sim_sh->fram_vars_size = fram_vars_size();
+    if (sim_sh->fram_vars_size > SIM_FRAM_VARS_MAX) {
+        fprintf(stderr, "sim: SIM_FRAM variables too large\n");
+        return 1;
+    }
+    fram_vars_flush();      // Initial values, as programmed.
+    sim_radio_medium();
+    signal(SIGCHLD, SIG_IGN);
+
+    for (;;) {
+        pid_t pid;
+
+        t = next_boot(t, last);
+        if (t >= sim_cfg.duration) {
+            t = sim_cfg.duration;
+            break;
+        }
+        sim_sh->now = t;
+        sim_sh->boots++;
+        mark_boot(t);
+        fflush(NULL);
+        pid = fork();
+        if (pid < 0) {
+            perror("sim: fork");
+            return 1;
+        }
+        if (pid == 0) {
+            node();
+        }
+        if (wait_done(timeout_s)) {
+            fprintf(stderr, "sim: node hung (no power-off within %d s wall time) at %.6f s\n",
+                    timeout_s, sec(t));
+            kill(sim_sh->running, SIGKILL);
+            kill_images();
+            return 3;
+        }
+        t = sim_sh->now;
+        last = sim_sh->end;
+        if (last == SIM_END_TIME) {
+            break;
+        }
+    }
+    kill_images();
+    report(t);
+    if (fram_out) {
+        FILE *f = fopen(fram_out, "wb");
+
+        if (!f || (fwrite(sim_sh->fram_vars, 1, sim_sh->fram_vars_size, f)
+                   != sim_sh->fram_vars_size)) {
+            perror(fram_out);
+            return 1;
+        }
+        fclose(f);
+    }
+    return 0;
+}
@@ -0,0 +1,176 @@
+/*
+ * Supply voltage trace for the host simulator, by P. Krawiec.
+ *
+ * A trace is a text file of "<time [s]> <voltage [V]>" points, one per line, in increasing
+ * time order. Lines starting with '#' are comments. The voltage is interpolated linearly
+ * between points and held before the first and after the last one.
+ *
+ * With a storage capacitor (--cap) the node no longer runs straight off the trace. The trace
+ * is then the harvester's open-circuit voltage, which charges the capacitor through the
+ * source resistance (--rsrc) and a diode, and the node's load (MCU, ADC and radio, see
+ * sim_cpu.c) discharges it. Power-up and brown-out follow the capacitor, the external
+ * comparator keeps watching the harvester (the trace). The capacitor voltage is kept in
+ * the shared state, so that it carries over power cycles and snapshot images, and is
+ * advanced with the load as time is charged. Brown-out is checked every SIM_STORE_STEP_PS.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "sim.h"
+
+typedef struct {
+    uint64_t t;
+    double v;
+} sim_point_t;
+
+static sim_point_t *pts;
+static size_t npts;
+
+int sim_trace_load(const char *path)
+{
+    char line[256];
+    size_t cap = 0;
+    double ts, v;
+    FILE *f = fopen(path, "r");
+
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        if ((line[0] == '#') || (sscanf(line, "%lf %lf", &ts, &v) != 2)) {
+            continue;
+        }
+        if (npts == cap) {
+            cap = cap ? 2 * cap : 64;
+            pts = realloc(pts, cap * sizeof(*pts));
+        }
+        pts[npts].t = (uint64_t)(ts * SIM_PS_PER_S);
+        pts[npts].v = v;
+        if (npts && (pts[npts].t < pts[npts - 1].t)) {
+            fprintf(stderr, "%s: time goes backwards at %g s\n", path, ts);
+            fclose(f);
+            return -1;
+        }
+        npts++;
+    }
+    fclose(f);
+    if (!npts) {
+        fprintf(stderr, "%s: no points\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// Index of the last point at or before t (0 if t is before the first point).
+static size_t seg(uint64_t t)
+{
+    size_t lo = 0, hi = npts;
+
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (pts[mid].t <= t) {
+            lo = mid;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+double sim_trace_v(uint64_t t)
+{
+    size_t k = seg(t);
+
+    if ((t <= pts[0].t) || (k + 1 == npts)) {
+        return (t <= pts[0].t) ? pts[0].v : pts[k].v;
+    }
+    return pts[k].v + (pts[k + 1].v - pts[k].v) * (double)(t - pts[k].t)
+                    / (double)(pts[k + 1].t - pts[k].t);
+}
+
+/*
+ * First time >= from at which v >= level (rising) or v < level (falling), SIM_NEVER if the
+ * trace never gets there.
+ */
+uint64_t sim_trace_cross(uint64_t from, double level, int rising)
+{
+    size_t k;
+
+#define MET(v)  (rising ? ((v) >= level) : ((v) < level))
+
+    if (MET(sim_trace_v(from))) {
+        return from;
+    }
+    for (k = seg(from); k + 1 < npts; k++) {
+        uint64_t t0 = (pts[k].t > from) ? pts[k].t : from;
+        uint64_t t1 = pts[k + 1].t;
+        double v0 = sim_trace_v(t0);
+        double v1 = pts[k + 1].v;
+        uint64_t t;
+
+        if ((t1 <= from) || !MET(v1)) {
+            continue;
+        }
+        t = t0 + (uint64_t)((level - v0) / (v1 - v0) * (double)(t1 - t0)) + 1;
+        return (t < t1) ? t : t1;
+    }
+    return SIM_NEVER;
+#undef MET
+}
+
+//***** Storage capacitor *****************************************************************
+
+int sim_store(void)
+{
+    return sim_cfg.cap > 0.0;
+}
+
+/*
+ * Advance the capacitor to t with a constant load. The source voltage is taken at the middle
+ * of the interval, which is short (at most SIM_STORE_STEP_PS) while the node runs.
+ */
+void sim_store_draw(uint64_t t, double amps)
+{
+    double dt, vs, v, v_inf;
+
+    if (!sim_store() || (t <= sim_sh->t_store)) {
+        return;
+    }
+    dt = (double)(t - sim_sh->t_store) / SIM_PS_PER_S;
+    vs = sim_trace_v(sim_sh->t_store + (t - sim_sh->t_store) / 2);
+    v = sim_sh->v_store;
+    if (vs > v) {
+        v_inf = vs - amps * sim_cfg.rsrc;
+        v = v_inf + (v - v_inf) * exp(-dt / (sim_cfg.rsrc * sim_cfg.cap));
+    }
+    else {
+        v -= amps * dt / sim_cfg.cap;
+    }
+    sim_sh->v_store = (v > 0.0) ? v : 0.0;
+    sim_sh->t_store = t;
+}
+
+/*
+ * First time >= from at which the capacitor has reached level and the trace trace_min, with
+ * the node off. SIM_NEVER if not within the run. Charges it up to that time.
+ */
+uint64_t sim_store_charge(uint64_t from, double level, double trace_min)
+{
+    uint64_t t;
+
+    for (t = from; t < sim_cfg.duration; t += SIM_STORE_STEP_PS) {
+        sim_store_draw(t, 0.0);
+        if ((sim_sh->v_store >= level) && (sim_trace_v(t) >= trace_min)) {
+            return t;
+        }
+    }
+    return SIM_NEVER;
+}
+
+double sim_supply_v(uint64_t t)
+{
+    return sim_store() ? sim_sh->v_store : sim_trace_v(t);
+}
@@ -0,0 +1,551 @@
+/*
+ * Zeta+ stand-in for the host simulator, by P. Krawiec.
+ *
+ * Understands the AT commands sent by t1_zeta.c over SPI: ATM, ATR, ATS, ATA, ATH, ATB,
+ * ATP, ATE, ATQ, ATV, ATD and AT?. Transmitted packets are appended to the air log
+ * (--air-out) as "<start [us]> <channel> <RF baud> <payload hex>" lines. A receiving node
+ * replays such a log (--air-in): a packet is delivered as '#', 'R', <len>, <rssi>,
+ * <payload> when its air time ends, if the radio has been in receive mode (ATR) on the same
+ * channel, length and RF baud since before it started.
+ *
+ * The medium: --air-in may be given once per transmitter, "<file>[:<rssi>]", the RSSI byte
+ * of that transmitter's packets (--rssi otherwise). Packets from different logs that
+ * overlap on a channel collide and none of them is received. --loss drops a fraction of
+ * the rest, drawn from --seed when the logs are loaded, so every run and every power-up
+ * sees the same packets. Lost packets do not wake the node either (--wake rf), collided
+ * ones do. --corrupt flips a bit of a fraction of them, drawn the same way, and --ber each
+ * payload bit with that probability: the Zeta+ drops those with its CRC check on (ATE 1) and
+ * delivers them with it off, the default. Air time is (len + RADIO_OVERHEAD) bytes at the RF
+ * baud rate's bit rate, --rf-bps changes the rate of a baud index.
+ *
+ * The wake-up detector (sim_radio_detect()) is high while any packet not lost is on air, on
+ * any channel, whatever the radio is doing: t1_wake.h reads wake codes from it.
+ *
+ * nIRQ is low while the radio has bytes for the host (command responses and received
+ * packets, in order). Commands are accepted while the radio boots after SDN goes low, but
+ * reception only starts once it is up. ATB, as on the module, takes effect at the next
+ * wake-up from shutdown, and only if SDN was high for RADIO_SDN_MIN_PS: zeta_set_baud_rf()
+ * pulses SDN for that. A shorter pulse is counted as a lost baud change.
+ *
+ * Supply current (sim_radio_amps()): none in shutdown, RADIO_I_SLEEP_A in sleep mode (ATM 3),
+ * the transmit current of the power setting (ATP) for a packet's air time, RADIO_I_RX_A in
+ * receive mode and RADIO_I_READY_A otherwise. Figures from the Zeta+ and Si4455 data sheets,
+ * the same as ZETA_I_*_UA in t1_zeta.h.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "sim.h"
+
+#define RADIO_BOOT_PS       (10 * 1000 * SIM_PS_PER_US)     ///< SDN low to ready.
+#define RADIO_SDN_MIN_PS    (15 * 1000 * SIM_PS_PER_US)     ///< Shutdown that applies ATB.
+#define RADIO_OVERHEAD      11u     ///< Preamble, sync, length and CRC bytes on air.
+#define RADIO_MAX_PAYLOAD   64u
+
+#define RADIO_I_TX_MIN_A    8e-3    ///< Transmitting at power 0 [A].
+#define RADIO_I_TX_MAX_A    24e-3   ///< Transmitting at power 127 [A].
+#define RADIO_I_RX_A        12e-3
+#define RADIO_I_READY_A     2e-3
+#define RADIO_I_SLEEP_A     1e-6
+
+typedef struct {
+    uint64_t start;         ///< Start of the packet on air [ps].
+    uint64_t end;           ///< End of the packet on air [ps].
+    uint8_t ch;
+    uint8_t baud;           ///< RF baud rate index (ATB).
+    uint8_t len;
+    int rssi;               ///< RSSI byte, -1 for --rssi.
+    int log;                ///< --air-in it came from.
+    int collided;
+    int lost;
+    int corrupted;          ///< A payload bit flipped.
+    uint8_t payload[RADIO_MAX_PAYLOAD];
+} sim_packet_t;
+
+static uint32_t rf_bps[7] = {0, 4800, 9600, 38400, 128000, 256000, 500000};
+
+// Air log replayed by this node, loaded by the harness before the first boot.
+static sim_packet_t *air;
+static size_t nair;
+static int nlogs;
+static int air_fd = -1;
+
+// Wake-up detector: its edges, packet starts (up) and ends, in time order.
+typedef struct {
+    uint64_t t;
+    int up;
+} sim_edge_t;
+
+static sim_edge_t *det;
+static size_t ndet, det_next;
+static int det_on;          ///< Packets on air.
+
+// Radio state, lost with the node's power.
+static int shutdown;
+static uint64_t ready_at;
+static uint64_t sdn_at;
+static uint8_t baud, baud_next;
+static uint8_t power;
+static int sleeping;
+static uint64_t tx_end;
+static int rx_on;
+static uint8_t rx_ch, rx_len;
+static uint8_t rssi;        ///< Of the last packet received, for ATQ.
+static int ate;             ///< CRC check on (ATE).
+static uint64_t rx_since;
+static size_t next_pkt;
+static uint8_t cmd[5 + RADIO_MAX_PAYLOAD];
+static unsigned ncmd, need;
+static uint8_t queue[256];
+static uint8_t q_head, q_tail;
+
+static uint64_t airtime(uint8_t len, uint8_t b)
+{
+    return (uint64_t)(len + RADIO_OVERHEAD) * 8u * SIM_PS_PER_S / rf_bps[b];
+}
+
+//***** Air log ***************************************************************************
+
+int sim_radio_load(const char *arg)
+{
+    char path[256], line[512];
+    static size_t cap;
+    char *colon;
+    int rssi = -1;
+    FILE *f;
+
+    snprintf(path, sizeof(path), "%s", arg);
+    if ((colon = strrchr(path, ':')) != NULL) {
+        *colon = '\0';
+        rssi = atoi(colon + 1) & 0xFF;
+    }
+    if (!(f = fopen(path, "r"))) {
+        perror(path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long long t_us;
+        unsigned ch, b;
+        int off;
+        char *hex;
+        sim_packet_t *p;
+
+        if ((line[0] == '#') || (sscanf(line, "%llu %u %u %n", &t_us, &ch, &b, &off) != 3)
+                || (b < 1) || (b > 6)) {
+            continue;
+        }
+        if (nair == cap) {
+            cap = cap ? 2 * cap : 64;
+            air = realloc(air, cap * sizeof(*air));
+        }
+        p = &air[nair];
+        p->start = t_us * SIM_PS_PER_US;
+        p->ch = ch;
+        p->baud = b;
+        p->len = 0;
+        p->rssi = rssi;
+        p->log = nlogs;
+        p->collided = p->lost = p->corrupted = 0;
+        for (hex = line + off; (p->len < RADIO_MAX_PAYLOAD) && (sscanf(hex, "%2x", &ch) == 1);
+                hex += 2) {
+            p->payload[p->len++] = ch;
+        }
+        if (!p->len) {
+            continue;
+        }
+        nair++;
+    }
+    fclose(f);
+    nlogs++;
+    return 0;
+}
+
+int sim_radio_set_bps(const char *arg)
+{
+    unsigned b;
+    unsigned long bps;
+
+    if ((sscanf(arg, "%u=%lu", &b, &bps) != 2) || (b < 1) || (b > 6) || !bps) {
+        return -1;
+    }
+    rf_bps[b] = bps;
+    return 0;
+}
+
+static int by_time(const void *a, const void *b)
+{
+    const sim_edge_t *p = a, *q = b;
+
+    if (p->t != q->t) {
+        return (p->t < q->t) ? -1 : 1;
+    }
+    return p->up - q->up;   // Ends first.
+}
+
+static int by_end(const void *a, const void *b)
+{
+    const sim_packet_t *p = a, *q = b;
+
+    if (p->end != q->end) {
+        return (p->end < q->end) ? -1 : 1;
+    }
+    return p->log - q->log;
+}
+
+void sim_radio_medium(void)
+{
+    uint32_t x = sim_cfg.seed ? sim_cfg.seed : 1;
+    size_t k, j;
+    unsigned b;
+    int corrupted;
+
+    for (k = 0; k < nair; k++) {
+        air[k].end = air[k].start + airtime(air[k].len, air[k].baud);
+    }
+    qsort(air, nair, sizeof(*air), by_end);
+    for (k = 0; k < nair; k++) {
+        for (j = 0; j < nair; j++) {
+            if ((j != k) && (air[j].log != air[k].log) && (air[j].ch == air[k].ch)
+                    && (air[j].start < air[k].end) && (air[k].start < air[j].end)) {
+                air[k].collided = 1;
+                break;
+            }
+        }
+        x ^= x << 13;       // xorshift32
+        x ^= x >> 17;
+        x ^= x << 5;
+        air[k].lost = ((double) x / 4294967296.0) < sim_cfg.loss;
+        if ((sim_cfg.corrupt > 0.0) && air[k].len) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            air[k].corrupted = ((double) x / 4294967296.0) < sim_cfg.corrupt;
+            if (air[k].corrupted) {
+                air[k].payload[(x >> 3) % air[k].len] ^= 1u << (x & 7);
+            }
+            sim_sh->air_corrupted += air[k].corrupted;
+        }
+        if ((sim_cfg.ber > 0.0) && air[k].len) {
+            corrupted = air[k].corrupted;
+            for (b = 0; b < 8u * air[k].len; b++) {
+                x ^= x << 13;
+                x ^= x >> 17;
+                x ^= x << 5;
+                if (((double) x / 4294967296.0) < sim_cfg.ber) {
+                    air[k].payload[b >> 3] ^= 0x80u >> (b & 7u);
+                    air[k].corrupted = 1;
+                }
+            }
+            sim_sh->air_corrupted += air[k].corrupted && !corrupted;
+        }
+        sim_sh->air_packets++;
+        sim_sh->air_collided += air[k].collided;
+        sim_sh->air_lost += (air[k].lost && !air[k].collided);
+    }
+
+    det = realloc(det, (2 * nair + 1) * sizeof(*det));
+    for (k = 0, ndet = 0; k < nair; k++) {
+        if (!air[k].lost) {
+            det[ndet].t = air[k].start;
+            det[ndet++].up = 1;
+            det[ndet].t = air[k].end;
+            det[ndet++].up = 0;
+        }
+    }
+    qsort(det, ndet, sizeof(*det), by_time);
+}
+
+// Detector edges up to now.
+static void detect_update(void)
+{
+    for (; (det_next < ndet) && (det[det_next].t <= sim_time); det_next++) {
+        det_on += det[det_next].up ? 1 : -1;
+    }
+}
+
+int sim_radio_open_log(const char *path)
+{
+    air_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (air_fd < 0) {
+        perror(path);
+        return -1;
+    }
+    return 0;
+}
+
+uint64_t sim_radio_next_packet_end(uint64_t from)
+{
+    size_t k;
+
+    for (k = 0; k < nair; k++) {
+        if ((air[k].end > from) && !air[k].lost) {
+            return air[k].end;
+        }
+    }
+    return SIM_NEVER;
+}
+
+// Start of the packet that ends at end, end if there is none.
+uint64_t sim_radio_packet_start(uint64_t end)
+{
+    size_t k;
+
+    for (k = 0; k < nair; k++) {
+        if (air[k].end == end) {
+            return air[k].start;
+        }
+    }
+    return end;
+}
+
+//***** Radio *****************************************************************************
+
+static void push(uint8_t b)
+{
+    if ((uint8_t)(q_head + 1) != q_tail) {
+        queue[q_head++] = b;
+    }
+}
+
+static void transmit(void)
+{
+    char line[32 + 2 * RADIO_MAX_PAYLOAD];
+    unsigned k;
+    int n;
+
+    n = snprintf(line, sizeof(line), "%llu %u %u ",
+                 (unsigned long long)(sim_time / SIM_PS_PER_US), cmd[3], baud);
+    for (k = 0; k < need - 5; k++) {
+        n += snprintf(line + n, sizeof(line) - n, "%02x", cmd[5 + k]);
+    }
+    line[n++] = '\n';
+    if ((air_fd >= 0) && (write(air_fd, line, n) != n)) {
+        perror("air log");
+    }
+    tx_end = sim_time + airtime(need - 5, baud);
+    sim_sh->radio_tx++;
+}
+
+static void execute(void)
+{
+    sleeping = 0;
+    switch (cmd[2]) {
+    case 'M':               // Operating mode, leaves receive mode.
+    case 'D':               // Defaults.
+        rx_on = 0;
+        if (cmd[2] == 'D') {
+            baud = baud_next = 4;
+            power = 127;
+            ate = 0;
+        }
+        else {
+            sleeping = (cmd[3] == 3);
+        }
+        break;
+    case 'P':
+        power = cmd[3] & 0x7F;
+        break;
+    case 'R':
+        rx_on = 1;
+        rx_ch = cmd[3];
+        rx_len = cmd[4];
+        rx_since = (sim_time > ready_at) ? sim_time : ready_at;
+        break;
+    case 'B':               // From the next wake-up, see sim_radio_sdn().
+        if ((cmd[3] >= 1) && (cmd[3] <= 6)) {
+            baud_next = cmd[3];
+        }
+        break;
+    case 'S':
+        transmit();
+        rx_on = 0;
+        break;
+    case 'Q':
+        push('#');
+        push('Q');
+        push(rssi);
+        break;
+    case 'V':
+        push('#');
+        push('V');
+        push('4');
+        push('.');
+        push('0');
+        push('0');
+        break;
+    case '?':
+        push('#');
+        push('?');
+        push(rx_on ? 3 : 2);
+        push(rx_ch);
+        push(rx_len);
+        push(baud);
+        push(4);
+        push(power);
+        push(0);
+        push(0);
+        break;
+    case 'E':
+        ate = cmd[3] & 1;
+        break;
+    default:                // ATA, ATH: accepted, no effect here.
+        break;
+    }
+}
+
+static unsigned args(uint8_t c)
+{
+    switch (c) {
+    case 'M': case 'H': case 'B': case 'P': case 'E':
+        return 1;
+    case 'R': case 'S':
+        return 2;
+    case 'A':
+        return 4;
+    case 'D': case 'Q': case 'V': case '?':
+        return 0;
+    default:
+        return ~0u;
+    }
+}
+
+void sim_radio_reset(void)
+{
+    shutdown = 1;
+    sdn_at = sim_time;
+    baud = baud_next = 4;
+    power = 127;
+    rssi = sim_cfg.rssi;
+    ate = 0;
+    sleeping = 0;
+    tx_end = 0;
+    rx_on = 0;
+    ncmd = 0;
+    q_head = q_tail = 0;
+    for (next_pkt = 0; (next_pkt < nair) && (air[next_pkt].end <= sim_time); next_pkt++)
+        ;
+    det_next = 0;
+    det_on = 0;
+    detect_update();
+}
+
+void sim_radio_sdn(int high)
+{
+    if (high && !shutdown) {
+        shutdown = 1;
+        sdn_at = sim_time;
+        sleeping = 0;
+        tx_end = 0;
+        rx_on = 0;
+        ncmd = 0;
+        q_head = q_tail = 0;
+    }
+    else if (!high && shutdown) {
+        shutdown = 0;
+        ready_at = sim_time + RADIO_BOOT_PS;
+        if (baud_next != baud) {
+            if (sim_time - sdn_at >= RADIO_SDN_MIN_PS) {
+                baud = baud_next;
+            }
+            else {
+                sim_sh->radio_baud_lost++;
+                baud_next = baud;
+            }
+        }
+    }
+}
+
+uint8_t sim_radio_xfer(uint8_t mosi)
+{
+    if (shutdown) {
+        return 0;
+    }
+    if (!ncmd && (mosi != 'A')) {
+        // Host is clocking out a response byte.
+        return (q_head != q_tail) ? queue[q_tail++] : 0;
+    }
+
+    cmd[ncmd++] = mosi;
+    if ((ncmd == 2) && (mosi != 'T')) {
+        ncmd = 0;
+    }
+    else if (ncmd == 3) {
+        if (args(mosi) == ~0u) {
+            ncmd = 0;       // Unknown command, resynchronise on the next 'A'.
+            return 0;
+        }
+        need = 3 + args(mosi);
+    }
+    else if ((ncmd == 5) && (cmd[2] == 'S')) {
+        need = 5 + ((cmd[4] <= RADIO_MAX_PAYLOAD) ? cmd[4] : RADIO_MAX_PAYLOAD);
+    }
+    if ((ncmd >= 3) && (ncmd >= need)) {
+        execute();
+        ncmd = 0;
+    }
+    return 0;
+}
+
+uint64_t sim_radio_next_event(void)
+{
+    uint64_t t = (rx_on && (next_pkt < nair)) ? air[next_pkt].end : SIM_NEVER;
+
+    return ((tx_end > sim_time) && (tx_end < t)) ? tx_end : t;
+}
+
+void sim_radio_update(void)
+{
+    detect_update();
+    for (; (next_pkt < nair) && (air[next_pkt].end <= sim_time); next_pkt++) {
+        const sim_packet_t *p = &air[next_pkt];
+        unsigned k;
+
+        if (!rx_on || shutdown || p->collided || p->lost || (rx_since > p->start)
+                || (p->ch != rx_ch) || (p->len != rx_len) || (p->baud != baud)
+                || (p->corrupted && ate)) {
+            continue;
+        }
+        sim_sh->radio_rx_bad += p->corrupted;
+        push('#');
+        push('R');
+        push(p->len);
+        rssi = (p->rssi >= 0) ? p->rssi : sim_cfg.rssi;
+        push(rssi);
+        for (k = 0; k < p->len; k++) {
+            push(p->payload[k]);
+        }
+        sim_sh->radio_rx++;
+    }
+}
+
+uint64_t sim_radio_next_detect(void)
+{
+    return (det_next < ndet) ? det[det_next].t : SIM_NEVER;
+}
+
+int sim_radio_detect(void)
+{
+    return det_on > 0;
+}
+
+int sim_radio_nirq(void)
+{
+    return shutdown || (q_head == q_tail);
+}
+
+double sim_radio_amps(void)
+{
+    if (shutdown) {
+        return 0.0;
+    }
+    if (tx_end > sim_time) {
+        return RADIO_I_TX_MIN_A + (RADIO_I_TX_MAX_A - RADIO_I_TX_MIN_A) * power / 127.0;
+    }
+    if (rx_on) {
+        return RADIO_I_RX_A;
+    }
+    return sleeping ? RADIO_I_SLEEP_A : RADIO_I_READY_A;
+}
@@ -0,0 +1,108 @@
+/*
+ * Decoder for FRAM field statistics dumps, by P. Krawiec.
+ *
+ * Reads a raw little-endian dump holding field_stats (see Proj_library/h_files/t1_stats.h),
+ * saved from the CCS Memory Browser or written by the simulator's --fram-out, and prints
+ * the counters and the RSSI histogram. The dump may be of the block alone or of any FRAM
+ * range that contains it, the decoder looks for its header. Fields are read byte by byte,
+ * so the host's struct layout does not matter.
+ *
+ * Usage: stats_decode <dump.bin>
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define STATS_MAGIC     0x5346
+#define STATS_VERSION   1u
+#define STATS_HEADER    8u      ///< Bytes before the counters.
+#define STATS_COUNTERS  9u
+#define STATS_RSSI_BINS 32u
+#define STATS_RSSI_STEP (256u / STATS_RSSI_BINS)
+#define STATS_LEN       (STATS_HEADER + 4u * STATS_COUNTERS + 2u * STATS_RSSI_BINS)
+#define BAR             40u     ///< Characters of the fullest bin.
+
+static const char *names[STATS_COUNTERS] = {
+    "power-ups", "packets received", "rx timeouts", "CRC rejects", "auth rejects",
+    "bad frames", "mailbox full", "restores", "restores failed"
+};
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return get16(p) | ((uint32_t) get16(p + 2) << 16);
+}
+
+int main(int argc, char **argv)
+{
+    static uint8_t buf[0x20000];
+    const uint8_t *blk = NULL;
+    uint32_t total = 0, sum = 0;
+    uint16_t bin[STATS_RSSI_BINS], most = 0;
+    unsigned k, j;
+    size_t n, off;
+    FILE *f;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <dump.bin>\n", argv[0]);
+        return 2;
+    }
+    f = fopen(argv[1], "rb");
+    if (!f) {
+        perror(argv[1]);
+        return 1;
+    }
+    n = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+
+    for (off = 0; off + STATS_LEN <= n; off += 2) {
+        if ((get16(buf + off) == STATS_MAGIC) && (get16(buf + off + 2) == STATS_VERSION)
+                && (buf[off + 4] == STATS_COUNTERS) && (buf[off + 5] == STATS_RSSI_BINS)) {
+            blk = buf + off;
+            break;
+        }
+    }
+    if (!blk) {
+        fprintf(stderr, "stats_decode: no field_stats (magic 0x%04x, version %u) in the dump\n",
+                STATS_MAGIC, STATS_VERSION);
+        return 1;
+    }
+
+    for (k = 0; k < STATS_COUNTERS; k++) {
+        printf("%-16s %10lu\n", names[k], (unsigned long) get32(blk + STATS_HEADER + 4u * k));
+    }
+    if (get16(blk + 6)) {
+        printf("(a restore was in flight when the dump was taken)\n");
+    }
+
+    for (k = 0; k < STATS_RSSI_BINS; k++) {
+        bin[k] = get16(blk + STATS_HEADER + 4u * STATS_COUNTERS + 2u * k);
+        total += bin[k];
+        sum += bin[k] * (k * STATS_RSSI_STEP + STATS_RSSI_STEP / 2u);
+        if (bin[k] > most) {
+            most = bin[k];
+        }
+    }
+    printf("\nRSSI histogram, %lu packets", (unsigned long) total);
+    if (!total) {
+        printf("\n");
+        return 0;
+    }
+    printf(", mean %.1f\n", (double) sum / total);
+    for (k = 0; k < STATS_RSSI_BINS; k++) {
+        if (!bin[k]) {
+            continue;
+        }
+        printf("%3u-%-3u %6u  ", k * STATS_RSSI_STEP, (k + 1) * STATS_RSSI_STEP - 1, bin[k]);
+        for (j = 0; j < (bin[k] * BAR + most - 1) / most; j++) {
+            putchar('#');
+        }
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+/*
+ * Host test of the software timers (t1_timer.c), by P. Krawiec.
+ *
+ * An application for the power simulator, like vlo_test.c. With the CPU asleep in LPM3 it
+ * runs at once:
+ *   a periodic timer every 250 ms,
+ *   one-shot timers at 100, 700 and 1300 ms,
+ *   a one-shot timer at 900 ms, cancelled by the 700 ms one before it expires,
+ *   a one-shot timer at 20.1 s, more than one Timer_B0 period away, which ends the test.
+ * Every expiry is checked against the simulated clock (0.5% plus one and a half ACLK
+ * periods), and the CPU must have been awake for under 1% of the time.
+ *
+ *     ./timer_test -t traces/steady.txt -d 30 --vlo 9400
+ */
+
+#include <stdio.h>
+#include <Proj_library/h_files/t1_util.h>
+#include <Proj_library/h_files/t1_timer.h>
+#include "sim.h"
+
+#define TOL_PPM         5000u
+#define PERIOD_MS       250u
+#define END_MS          20100u  ///< not a multiple of PERIOD_MS, so the count is exact
+#define FIRES_MAX       100u
+
+static uint64_t t0;
+static uint64_t fired[5];
+static uint64_t periodic[FIRES_MAX];
+static unsigned nperiodic;
+static timer_id_t cancelled = TIMER_NONE;
+static volatile uint8_t done;
+static int fails;
+
+static uint8_t tick(void)
+{
+    if (nperiodic < FIRES_MAX) {
+        periodic[nperiodic++] = sim_time;
+    }
+    return 0;
+}
+
+static uint8_t at_100(void)
+{
+    fired[0] = sim_time;
+    return 0;
+}
+
+static uint8_t at_700(void)
+{
+    fired[1] = sim_time;
+    timer_cancel(&cancelled);
+    return 0;
+}
+
+static uint8_t at_900(void)
+{
+    fired[2] = sim_time;
+    return 0;
+}
+
+static uint8_t at_1300(void)
+{
+    fired[3] = sim_time;
+    return 0;
+}
+
+static uint8_t at_end(void)
+{
+    fired[4] = sim_time;
+    done = 1;
+    return 1;
+}
+
+static void check(const char *what, uint32_t ms, uint64_t t)
+{
+    double got = (double)(t - t0) / (SIM_PS_PER_S / 1000);
+    double tol = ms * TOL_PPM / 1e6 + 1500.0 / sim_cfg.vlo_hz;
+    int ok = t && (got >= ms - tol) && (got <= ms + tol);
+
+    printf("  %-14s %5u ms: %10.3f ms  %s\n", what, (unsigned) ms, t ? got : 0.0,
+           ok ? "ok" : "FAIL");
+    fails += !ok;
+}
+
+int main(void)
+{
+    timer_id_t id[5];
+    uint64_t awake;
+    unsigned k;
+
+    PM5CTL0 &= ~(LOCKLPM5);
+    WDTCTL = WDTPW | WDTHOLD;
+    io_init();
+    clock_init();
+    P4IE = 0;
+
+    printf("VLO %u Hz, calibrated %u Hz\n", sim_cfg.vlo_hz, vlo_cal.hz);
+    t0 = sim_time;
+    awake = sim_sh->active[SIM_PHASE_APP];
+    timer_add(&id[0], PERIOD_MS, PERIOD_MS, tick);
+    timer_add(&id[1], 100, 0, at_100);
+    timer_add(&id[2], 700, 0, at_700);
+    timer_add(&cancelled, 900, 0, at_900);
+    timer_add(&id[3], 1300, 0, at_1300);
+    timer_add(&id[4], END_MS, 0, at_end);
+
+    __disable_interrupt();
+    while (!done) {
+        __bis_SR_register(LPM3_bits + GIE);
+        __disable_interrupt();
+    }
+    __enable_interrupt();
+    awake = sim_sh->active[SIM_PHASE_APP] - awake;
+    timer_cancel(&id[0]);
+
+    check("one-shot", 100, fired[0]);
+    check("one-shot", 700, fired[1]);
+    printf("  %-14s %5u ms: %s  %s\n", "cancelled", 900u, fired[2] ? "fired" : "not fired",
+           fired[2] ? "FAIL" : "ok");
+    fails += !!fired[2];
+    check("one-shot", 1300, fired[3]);
+    check("one-shot", END_MS, fired[4]);
+    printf("  %-14s %5u x: %10u     %s\n", "periodic", END_MS / PERIOD_MS, nperiodic,
+           (nperiodic == END_MS / PERIOD_MS) ? "ok" : "FAIL");
+    fails += (nperiodic != END_MS / PERIOD_MS);
+    for (k = 0; k < nperiodic; k++) {
+        double got = (double)(periodic[k] - t0) / (SIM_PS_PER_S / 1000);
+        double want = (k + 1) * PERIOD_MS;
+        double tol = want * TOL_PPM / 1e6 + 1500.0 / sim_cfg.vlo_hz;
+
+        if ((got < want - tol) || (got > want + tol)) {
+            printf("  %-14s %5u ms: %10.3f ms  FAIL\n", "periodic", (unsigned) want, got);
+            fails++;
+        }
+    }
+    printf("  %-14s %12.3f ms awake  %s\n", "LPM3", (double) awake / (SIM_PS_PER_S / 1000),
+           (awake * 100 < (uint64_t) END_MS * (SIM_PS_PER_S / 1000)) ? "ok" : "FAIL");
+    fails += !(awake * 100 < (uint64_t) END_MS * (SIM_PS_PER_S / 1000));
+    printf("%s\n", fails ? "FAIL" : "PASS");
+
+    fflush(stdout);
+    return 0;
+}
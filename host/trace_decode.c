@@ -0,0 +1,174 @@
+/*
+ * Decoder for FRAM event trace dumps, by P. Krawiec.
+ *
+ * Reads a raw little-endian dump holding trace_ring (see Proj_library/h_files/t1_trace.h),
+ * saved from the CCS Memory Browser or written by the simulator's --fram-out, and prints
+ * the records oldest first as a timeline: power-up, time since that power-up's timer_init()
+ * and since the record before, event and argument. The dump may be of the ring alone or of
+ * any FRAM range that contains it, the decoder looks for its header. Fields are read byte
+ * by byte, so the host's struct layout does not matter.
+ *
+ * Usage: trace_decode [-s] <dump.bin>
+ *   -s    only the number of records of each event
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRACE_MAGIC     0x5254
+#define TRACE_VERSION   1u
+#define TRACE_HEADER    12u     ///< Bytes before the records.
+#define TRACE_REC       8u      ///< Bytes per record.
+#define TRACE_IDS       11u
+#define VLO_NOMINAL_HZ  9400u   ///< For power-ups whose TRACE_BOOT record is overwritten.
+
+static const char *id_names[TRACE_IDS] = {
+    "?", "boot", "zeta cmd", "zeta wait", "zeta irq", "zeta timeout", "mailbox push",
+    "mailbox pop", "hibernate", "restore", "power off"
+};
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return get16(p) | ((uint32_t) get16(p + 2) << 16);
+}
+
+static void print_arg(uint8_t id, uint16_t arg)
+{
+    uint8_t lo = arg & 0xFF, hi = arg >> 8;
+
+    switch (id) {
+    case 1:
+        printf("VLO %u Hz", arg);
+        break;
+    case 2:
+        if ((lo == 'D') || (lo == 'Q') || (lo == 'V') || (lo == '?')) {
+            printf("AT%c", lo);
+        }
+        else {
+            printf("AT%c %u", (lo >= ' ') && (lo < 0x7F) ? lo : '?', hi);
+        }
+        break;
+    case 4:
+        printf("%s", arg ? "timeout" : "ok");
+        break;
+    case 6:
+    case 7:
+        if (hi && (id == 6)) {
+            printf("full, 0x%02x lost", lo);
+        }
+        else if (hi) {
+            printf("empty");
+        }
+        else {
+            printf("0x%02x", lo);
+        }
+        break;
+    case 8:
+        printf("%s", arg ? "delta" : "image");
+        break;
+    case 3: case 5: case 9: case 10:
+        break;
+    default:
+        printf("0x%04x", arg);
+        break;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    static uint8_t buf[0x20000];
+    static uint16_t hz[256];
+    unsigned long per_id[TRACE_IDS + 1] = {0};
+    const uint8_t *ring = NULL, *rec;
+    uint32_t count, first, k, ticks, prev = 0;
+    uint16_t len, boots;
+    int summary = 0, prev_boot = -1;
+    size_t n, off;
+    FILE *f;
+
+    if ((argc == 3) && !strcmp(argv[1], "-s")) {
+        summary = 1;
+        argv++;
+        argc--;
+    }
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s [-s] <dump.bin>\n", argv[0]);
+        return 2;
+    }
+    f = fopen(argv[1], "rb");
+    if (!f) {
+        perror(argv[1]);
+        return 1;
+    }
+    n = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+
+    for (off = 0; off + TRACE_HEADER <= n; off += 2) {
+        len = get16(buf + off + 4);
+        if ((get16(buf + off) == TRACE_MAGIC) && (get16(buf + off + 2) == TRACE_VERSION)
+                && len && !(len & (len - 1)) && (off + TRACE_HEADER + len * TRACE_REC <= n)) {
+            ring = buf + off;
+            break;
+        }
+    }
+    if (!ring) {
+        fprintf(stderr, "trace_decode: no trace_ring (magic 0x%04x, version %u) in the dump\n",
+                TRACE_MAGIC, TRACE_VERSION);
+        return 1;
+    }
+    len = get16(ring + 4);
+    boots = get16(ring + 6);
+    count = get32(ring + 8);
+    first = (count > len) ? count - len : 0;
+    printf("%lu records written, %lu kept, %u power-ups\n", (unsigned long) count,
+           (unsigned long)(count - first), boots);
+
+    // Each power-up's VLO frequency, from its boot record.
+    for (k = 0; k < 256; k++) {
+        hz[k] = VLO_NOMINAL_HZ;
+    }
+    for (k = first; k < count; k++) {
+        rec = ring + TRACE_HEADER + (k & (len - 1)) * TRACE_REC;
+        if ((rec[4] == 1) && get16(rec + 6)) {
+            hz[rec[5]] = get16(rec + 6);
+        }
+    }
+
+    if (!summary) {
+        printf("\n%4s %12s %12s  %-14s %s\n", "boot", "time [ms]", "delta [ms]", "event", "arg");
+    }
+    for (k = first; k < count; k++) {
+        rec = ring + TRACE_HEADER + (k & (len - 1)) * TRACE_REC;
+        ticks = get32(rec);
+        per_id[(rec[4] < TRACE_IDS) ? rec[4] : TRACE_IDS]++;
+        if (summary) {
+            continue;
+        }
+        if (rec[5] != prev_boot) {
+            prev = ticks;
+            prev_boot = rec[5];
+        }
+        printf("%4u %12.3f %12.3f  %-14s ", rec[5], ticks * 1000.0 / hz[rec[5]],
+               (double)(int32_t)(ticks - prev) * 1000.0 / hz[rec[5]],
+               (rec[4] < TRACE_IDS) ? id_names[rec[4]] : "?");
+        print_arg(rec[4], get16(rec + 6));
+        printf("\n");
+        prev = ticks;
+    }
+
+    if (summary) {
+        for (k = 1; k <= TRACE_IDS; k++) {
+            if (per_id[k]) {
+                printf("%-14s %8lu\n", (k < TRACE_IDS) ? id_names[k] : "unknown", per_id[k]);
+            }
+        }
+    }
+    return 0;
+}
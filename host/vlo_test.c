@@ -0,0 +1,79 @@
+/*
+ * Host test of the VLO calibration and the millisecond timer API, by P. Krawiec.
+ *
+ * An application for the power simulator (built like sim_tx, see the Makefile): it powers
+ * up, lets clock_init() calibrate the VLO against SMCLK, then times wait_ms() and a one-shot
+ * software timer on the simulated clock. Run it with a steady supply and the VLO frequency
+ * under test:
+ *
+ *     ./vlo_test -t traces/steady.txt -d 60 --vlo 6000
+ *
+ * Prints one line per check and "FAIL" on any that is out of tolerance: the calibration
+ * within 0.5%, a wait within 0.5% plus one and a half ACLK periods (rounding to whole periods,
+ * and the phase of ACLK when the timer starts).
+ */
+
+#include <stdio.h>
+#include <Proj_library/h_files/t1_util.h>
+#include <Proj_library/h_files/t1_timer.h>
+#include "sim.h"
+
+#define CAL_TOL_PPM     5000u
+#define TIMEOUT_MS      3000u
+
+static volatile uint8_t timeout;
+
+static uint8_t expired(void)
+{
+    timeout = 1;
+    return 1;
+}
+
+static int check(const char *what, uint16_t ms, uint64_t ps)
+{
+    double got = (double) ps / (SIM_PS_PER_S / 1000);
+    double tol = ms * CAL_TOL_PPM / 1e6 + 1500.0 / sim_cfg.vlo_hz;
+    int ok = (got >= ms - tol) && (got <= ms + tol);
+
+    printf("  %-14s %5u ms: %10.3f ms  %s\n", what, ms, got, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main(void)
+{
+    static const uint16_t waits[] = {1, 10, 100, 1000, 3000, 9000};
+    timer_id_t id;
+    uint64_t t0;
+    unsigned k;
+    long err_ppm;
+
+    PM5CTL0 &= ~(LOCKLPM5);
+    WDTCTL = WDTPW | WDTHOLD;
+    io_init();
+    clock_init();
+
+    err_ppm = ((long) vlo_cal.hz - (long) sim_cfg.vlo_hz) * 1000000L / (long) sim_cfg.vlo_hz;
+    printf("VLO %u Hz: calibrated %u Hz (%+ld ppm)  %s\n", sim_cfg.vlo_hz, vlo_cal.hz, err_ppm,
+           ((err_ppm <= (long) CAL_TOL_PPM) && (err_ppm >= -(long) CAL_TOL_PPM)) ? "ok" : "FAIL");
+
+    for (k = 0; k < sizeof(waits) / sizeof(waits[0]); k++) {
+        t0 = sim_time;
+        wait_ms(waits[k]);
+        check("wait_ms", waits[k], sim_time - t0);
+    }
+
+    // Timeout, as zeta_wait_irq() uses it.
+    timeout = 0;
+    t0 = sim_time;
+    timer_add(&id, TIMEOUT_MS, 0, expired);
+    __disable_interrupt();
+    while (!timeout) {
+        __bis_SR_register(LPM3_bits + GIE);
+        __disable_interrupt();
+    }
+    __enable_interrupt();
+    check("timer_add", TIMEOUT_MS, sim_time - t0);
+
+    fflush(stdout);
+    return 0;
+}
@@ -65,7 +65,8 @@ MEMORY
     INFOA                   : origin = 0x1980, length = 0x80
     RAM                     : origin = 0x1C00, length = 0x1000
     FRAM_VARS				: origin = 0x4000, length = 0x1000	// Created a space for pointer variables to be saved
-    FRAM                    : origin = 0x5000, length = 0xAF80  // previously origin = 0x4000, length = 0xBF80
+    HIBERNUS                : origin = 0x5000, length = 0x1800  // Hibernus checkpoint image and delta
+    FRAM                    : origin = 0x6800, length = 0x9780  // previously origin = 0x4000, length = 0xBF80
     FRAM2                   : origin = 0x10000,length = 0x33FF8 /* Boundaries changed to fix CPU47 */
     JTAGSIGNATURE           : origin = 0xFF80, length = 0x0004, fill = 0xFFFF
     BSLSIGNATURE            : origin = 0xFF84, length = 0x0004, fill = 0xFFFF
@@ -191,12 +192,14 @@ SECTIONS
     .text             : {} >> FRAM2 | FRAM  /* Code                              */
 #endif
 
+    /* RAMFUNC code (T1_RAMFUNC in t1_util.h) runs from the start of RAM, where Hibernus
+     * knows to leave it out of its image: RAM is saved from hib_ramfunc_end. */
     #ifdef __TI_COMPILER_VERSION__
         #if __TI_COMPILER_VERSION__ >= 15009000
             #ifndef __LARGE_CODE_MODEL__
-                .TI.ramfunc : {} load=FRAM, run=RAM, table(BINIT)
+                .TI.ramfunc : {} load=FRAM, run=0x1C00, palign(4), table(BINIT), RUN_END(hib_ramfunc_end)
             #else
-                .TI.ramfunc : {} load=FRAM | FRAM2, run=RAM, table(BINIT)
+                .TI.ramfunc : {} load=FRAM | FRAM2, run=0x1C00, palign(4), table(BINIT), RUN_END(hib_ramfunc_end)
             #endif
         #endif
     #endif
@@ -212,9 +215,14 @@ SECTIONS
 
 	.fram_vars  : {}  > FRAM_VARS type=NOINIT		// Telling compiler to not initialise these
 													// values, we want to keep them the same!
-    .bss        : {} > RAM                  /* Global & static vars              */
-    .data       : {} > RAM                  /* Global & static vars              */
-    .TI.noinit  : {} > RAM                  /* For #pragma noinit                */
+	.hibernus   : {}  > HIBERNUS type=NOINIT		// Checkpoint image, validated by its header.
+													// Can move to FRAM2 with the large data model.
+    GROUP
+    {
+        .bss        : {}                    /* Global & static vars              */
+        .data       : {}                    /* Global & static vars              */
+        .TI.noinit  : {}                    /* For #pragma noinit                */
+    } > RAM, RUN_END(hib_ram_used_end)      /* Saved by a Hibernus delta         */
     .stack      : {} > RAM (HIGH)           /* Software system stack             */
 
     .tinyram    : {} > TINYRAM              /* Tiny RAM                          */
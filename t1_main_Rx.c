@@ -1,6 +1,15 @@
 #include <Proj_library/hibernus/hibernation_5994.h> //hibernus by D.Balsamo (1)
 #include <Proj_library/h_files/t1_util.h>   //system set up (pins, functions etc.)
 #include <Proj_library/h_files/t1_zeta.h>   //radio functions
+#include <Proj_library/h_files/t1_timer.h>  //software timers
+#include <Proj_library/h_files/t1_event.h>  //event loop (2)
+#include <Proj_library/h_files/t1_uart.h>   //telemetry (3)
+#include <Proj_library/h_files/t1_aes.h>    //payload encryption (4)
+#include <Proj_library/h_files/t1_crc.h>    //packet CRC (5)
+#include <Proj_library/h_files/t1_frame.h>  //payload frames (6)
+#include <Proj_library/h_files/t1_delta.h>  //compressed data (7)
+#include <Proj_library/h_files/t1_wake.h>   //wake codes (8)
+#include <Proj_library/h_files/t1_stats.h>  //field statistics (9)
 
 /* (1) Hibernus was originally implemented on the msp430fr5739 platform, this
  * implementation is now available on the msp430fr5994 platform, coded by P. Krawiec.
@@ -37,15 +46,113 @@
  *      At this point, wait until there is again enough charge across the Energy storage
  *      supplied by the EH until the Comparator turns the MCU back on. And the process
  *      restarts again.
+ *
+ * (2) Reception runs on the event loop (t1_event.h). The CPU sleeps in LPM3 until the
+ * radio's nIRQ falls (EVENT_RADIO) or ZETA_TIMEOUT_MS pass, instead of polling nIRQ. The
+ * packet goes into the mailbox, and whatever the mailbox holds is shown (EVENT_MAILBOX),
+ * including entries left by a wake-up that lost power before showing them.
+ *
+ * With RX_BURST the radio stays in receive mode after a packet and every packet of the
+ * burst goes into the mailbox, until one of:
+ *      the end-of-burst packet (BURST_END, see t1_main_Tx.c TX_BURST),
+ *      RX_BURST_IDLE_MS without a packet,
+ *      the comparator output falling (the supply is running out).
+ * The mailbox is in FRAM, packets received before a power loss are shown at the next wake-up.
+ *
+ * SIM_MARK() marks the stages of the wake-up for the host simulator's latency report ('make
+ * latency' in host/), it compiles away on the target.
+ *
+ * (3) With T1_TELEMETRY (t1_uart.h) the receiver sends on the UART the RSSI of each packet,
+ * the mailbox before it is shown, and at the end of the wake-up its counters and the trace
+ * records not sent yet. It waits for the UART only then, before switching itself off.
+ *
+ * (4) With T1_AES (t1_aes.h), for a transmitter built with it, the data packets are checked
+ * and decrypted by zeta_rx_packet(). One that fails (ERROR_AUTH) ends the wake-up as a
+ * timeout does, nothing goes into the mailbox.
+ *
+ * (5) With T1_CRC (t1_crc.h) zeta_rx_packet() checks the CRC while it reads the packet. A
+ * packet with bit errors (ERROR_CRC) ends the wake-up the same way, before it is decrypted
+ * or anything is written to FRAM. The Zeta+'s own check (ATE) stays off.
+ *
+ * (6) With T1_FRAME (t1_frame.h) a data packet is a frame, checked whole by frame_open()
+ * before its records are read in place: each FRAME_DATA value goes into the mailbox,
+ * FRAME_END ends a burst. A malformed frame ends the wake-up as a timeout does.
+ *
+ * (7) A FRAME_DELTA record, from a transmitter built with T1_DELTA (t1_delta.h), is a burst
+ * of values in one packet, decompressed as it is read into the mailbox. Build the receiver
+ * with T1_DELTA too, for the length of its packets, and with T1_DELTA_RICE if the sender is.
+ *
+ * (8) With T1_WAKE (t1_wake.h) every power-up first reads the wake code from the wake-up
+ * detector, straight after clock_start(). A wake-up for another node, or a power-up by any
+ * other packet, powers off there: no VLO calibration, no SPI, no radio, WAKE_CHECK_MS in
+ * LPM3 at most. Only a wake-up with WAKE_CODE goes on, to vlo_check() and to receive. The transmitter must be built with T1_WAKE too.
+ *
+ * (9) With T1_STATS (t1_stats.h) the receiver counts in FRAM the packets it reads, the
+ * wake-ups that time out without one, the packets zeta_rx_packet() rejects, the frames
+ * take_payload() rejects and the values the mailbox has no room for, and adds each packet's
+ * RSSI to a histogram. With T1_TELEMETRY as well they go out on the UART at the end of
+ * each wake-up, after the S line.
  */
 
-uint8_t i;
-uint8_t j;
+//#define RX_BURST  ///< "Uncomment" to receive a whole burst of packets per wake-up.
+
+#define RX_BURST_IDLE_MS 500u   ///< RX_BURST: the burst is over after this long without a packet.
+
+// EVENT_TIMER args.
+enum {
+    RX_TIMEOUT = 0,     ///< No packet within ZETA_TIMEOUT_MS.
+    RX_IDLE,            ///< RX_BURST: none for RX_BURST_IDLE_MS, the burst is over.
+    SHOW_DONE           ///< Received data shown for a second.
+};
+
+static timer_id_t rx_timer = TIMER_NONE;
+static timer_id_t show_timer = TIMER_NONE;
+static uint8_t rx_over;     ///< Packet received or given up on.
+
+static uint8_t rx_timeout(void)
+{
+    return event_post(EVENT_TIMER, RX_TIMEOUT) == ERROR_OK;
+}
+
+#ifdef RX_BURST
+static uint8_t rx_idle(void)
+{
+    return event_post(EVENT_TIMER, RX_IDLE) == ERROR_OK;
+}
+#endif // RX_BURST
+
+static uint8_t show_expired(void)
+{
+    return event_post(EVENT_TIMER, SHOW_DONE) == ERROR_OK;
+}
+
+static void receive_done(void)
+{
+    rx_over = 1;
+    if (show_timer != TIMER_NONE) {
+        return;     // Finish showing first.
+    }
+#ifdef T1_TELEMETRY
+    telemetry_stats();
+    while (telemetry_field()) {
+        uart_drain();
+    }
+    while (telemetry_trace()) {
+        uart_drain();
+    }
+    uart_drain();
+#endif // T1_TELEMETRY
+    if(!COMPARATOR_ON){
+        power_off();
+    }
+    event_stop();
+}
 
 // ***** Receive Packet ************************************************************
-void receive_packet(void){
+static void receive_start(void){
     //initialise radio
     zeta_init();
+    SIM_MARK("zeta_init");
 
     // Set zeta operating mode 2 (ATM Ready)
     zeta_select_mode(0x2);
@@ -53,31 +160,154 @@ void receive_packet(void){
     //Indicate receiver function is running
     P1OUT |= BIT1;
 
-    uint8_t incoming_packet[1u + 4u] = {0};
-    uint8_t data_in = 0;
-
     // Receive mode: ATR - Channel, Packet Length
-    zeta_rx_mode(CHANNEL, 1u);
+    zeta_rx_mode(CHANNEL, ZETA_AIR_LEN(FRAME_DATA_LEN));
+    SIM_MARK("zeta_rx_mode");
+
+    // Sleep until the radio has a packet, or give up.
+    timer_add(&rx_timer, ZETA_TIMEOUT_MS, 0, rx_timeout);
+    event_radio_arm();
+}
 
-    __delay_cycles(100);
+static void take(uint8_t value)
+{
+    if (mailbox_push(value) != ERROR_OK) {
+        STATS(STATS_MAILBOX_FULL);
+    }
+}
 
-    if(zeta_rx_packet(incoming_packet)){
-        ;
+// Data of a packet's payload into the mailbox: ERROR_OK, ERROR_NOBUFS for the end of a
+// burst, ERROR_RANGE for a malformed frame.
+static error_t take_payload(const uint8_t *payload, uint8_t len)
+{
+#ifdef T1_FRAME
+    frame_reader_t frame;
+    frame_rec_t rec;
+    delta_dec_t delta;
+    error_t status = ERROR_OK;
+    int16_t sample;
+    uint8_t k;
+
+    if (frame_open(&frame, payload, len) != ERROR_OK) {
+        return ERROR_RANGE;
+    }
+    while (frame_next(&frame, &rec) == ERROR_OK) {
+        if (rec.type == FRAME_DATA) {
+            for (k = 0; k < rec.len; k++) {
+                take(rec.value[k]);
+            }
+        }
+        else if (rec.type == FRAME_DELTA) {
+            delta_open(&delta, rec.value, rec.len);
+            while ((status = delta_get(&delta, &sample)) == ERROR_OK) {
+                take((uint8_t) sample);
+            }
+            if (status == ERROR_RANGE) {
+                return ERROR_RANGE;     // Cut short, the values after it are lost.
+            }
+            status = ERROR_OK;
+        }
+        else if (rec.type == FRAME_END) {
+            status = ERROR_NOBUFS;
+        }
+    }
+    return status;
+#else
+#ifdef RX_BURST
+    if (payload[0] == BURST_END) {
+        return ERROR_NOBUFS;
+    }
+#endif // RX_BURST
+    take(payload[0]);
+    return ERROR_OK;
+#endif // T1_FRAME
+}
+
+// ***** Events ********************************************************************
+static void on_radio(uint8_t arg)
+{
+    uint8_t incoming_packet[4u + ZETA_BUF_LEN(FRAME_DATA_LEN)] = {0};
+    error_t status;
+
+    if (rx_over) {
+        return;     // Burst already ended, the packet is left in the radio.
+    }
+    timer_cancel(&rx_timer);
+    status = zeta_rx_packet(incoming_packet);
+    if(status != ERROR_OK){
+        STATS((status == ERROR_CRC) ? STATS_CRC
+              : (status == ERROR_AUTH) ? STATS_AUTH : STATS_TIMEOUTS);
+        receive_done();
+        return;
+    }
+    SIM_MARK("payload");
+    STATS(STATS_RX);
+    STATS_RSSI(incoming_packet[3]);
+#ifdef T1_TELEMETRY
+    telemetry_rssi(incoming_packet[3]);
+#endif // T1_TELEMETRY
+    status = take_payload(&incoming_packet[4], incoming_packet[2]);
+    if (status == ERROR_RANGE) {
+        STATS(STATS_BAD_FRAMES);
+    }
+#ifdef RX_BURST
+    if (status != ERROR_OK) {
+        receive_done();
+        return;
     }
-    else{
-        mailbox_push(incoming_packet[4]);
-        mailbox_pop(&data_in);
-        led_set(data_in);
 
-        // Take data contents of the packet and display them
-        wait_one_second();
+    // Stay in receive mode for the rest of the burst.
+    timer_add(&rx_timer, RX_BURST_IDLE_MS, 0, rx_idle);
+    event_radio_arm();
+#else
+    /* EVENT_MAILBOX only runs once the loop is idle: leave the power-off to SHOW_DONE, a
+     * second after the value is shown, unless there is nothing to show. */
+    rx_over = 1;
+    if (!mailbox_count()) {
+        receive_done();
+    }
+#endif // RX_BURST
+}
+
+#ifdef RX_BURST
+static void on_comparator(uint8_t level)
+{
+    if (!level && !rx_over) {
+        timer_cancel(&rx_timer);
+        receive_done();
+    }
+}
+#endif // RX_BURST
+
+static void on_mailbox(uint8_t arg)
+{
+    uint8_t data_in = 0;
 
+#ifdef T1_TELEMETRY
+    telemetry_mailbox();
+#endif // T1_TELEMETRY
+    // Take data contents of the packet and display them, the latest if there are more.
+    while (mailbox_pop(&data_in) == ERROR_OK)
+        ;
+    led_set(data_in);
+    timer_cancel(&show_timer);
+    timer_add(&show_timer, 1000, 0, show_expired);
+}
+
+static void on_timer(uint8_t arg)
+{
+    if (arg == SHOW_DONE) {
         // clear output
         led_clear();
+        if (rx_over) {
+            receive_done();
+        }
     }
-
-    if(!COMPARATOR_ON){
-        power_off();
+    else {
+        if (arg == RX_TIMEOUT) {
+            STATS(STATS_TIMEOUTS);
+        }
+        receive_done();
     }
 }
 
@@ -93,10 +323,38 @@ int main(void)
 
     //  Initialise system
     io_init();
+    SIM_MARK("io_init");
+#ifdef T1_WAKE
+    clock_start();
+    SIM_MARK("clock_init");
+    if (wake_check(WAKE_CODE) != ERROR_OK) {
+        SIM_MARK("foreign");
+        if(!COMPARATOR_ON){
+            power_off();
+        }
+        return 0;
+    }
+    SIM_MARK("wake_code");
+    vlo_check();
+#else
     clock_init();
+    SIM_MARK("clock_init");
+#endif // T1_WAKE
     spi_init();
+    SIM_MARK("spi_init");
+#ifdef T1_TELEMETRY
+    uart_init();
+#endif // T1_TELEMETRY
 
     if(!COMPARATOR_ON){
-        receive_packet();
+        event_init();
+        event_handler(EVENT_RADIO, on_radio);
+        event_handler(EVENT_MAILBOX, on_mailbox);
+        event_handler(EVENT_TIMER, on_timer);
+#ifdef RX_BURST
+        event_handler(EVENT_COMPARATOR, on_comparator);
+#endif // RX_BURST
+        receive_start();
+        event_run();
     }
 }
@@ -1,6 +1,14 @@
 #include <Proj_library/hibernus/hibernation_5994.h> //hibernus by D.Balsamo (1)
 #include <Proj_library/h_files/t1_util.h>   //system set up (pins, functions etc.)
 #include <Proj_library/h_files/t1_zeta.h>   //radio functions
+#include <Proj_library/h_files/t1_timer.h>  //software timers
+#include <Proj_library/h_files/t1_event.h>  //event loop (2)
+#include <Proj_library/h_files/t1_energy.h> //stored energy (4)
+#include <Proj_library/h_files/t1_aes.h>    //payload encryption (5)
+#include <Proj_library/h_files/t1_crc.h>    //packet CRC (6)
+#include <Proj_library/h_files/t1_frame.h>  //payload frames (7)
+#include <Proj_library/h_files/t1_delta.h>  //compressed data (8)
+#include <Proj_library/h_files/t1_wake.h>   //wake codes (9)
 
 /* (1) Hibernus was originally implemented on the msp430fr5739 platform, this
  * implementation is now available on the msp430fr5994 platform, coded by P. Krawiec.
@@ -38,28 +46,229 @@
  *      At this point, wait until there is again enough charge across the Energy storage
  *      supplied by the EH until the Comparator turns the MCU back on. And the process
  *      restarts again.
+ *
+ * (2) Both operations run on the event loop (t1_event.h): each step is a handler for a
+ * timer or comparator event, and the CPU sleeps in LPM3 between steps. The LED count stops
+ * as soon as the comparator output goes low, not at the end of a 16-step round.
+ *
+ * (3) With TX_BURST the data packet of each pair is a burst of TX_BURST_LEN packets,
+ * TX_BURST_GAP_MS apart, followed by an end-of-burst packet (BURST_END), for a receiver
+ * built with RX_BURST (t1_main_Rx.c) to take in one wake-up.
+ *
+ * (4) With TX_SCHEDULE the data values wait in the mailbox, in FRAM, until they have been
+ * sent. Each transmission first tops the mailbox up with new values. Before the radio is
+ * switched on, and before each wake/data pair, the supply is measured and the pair is
+ * only started if the energy stored above STORE_MIN_MV covers it: two packets at the radio's
+ * power and baud rate, and the radio ready for TX_PAIR_MS (t1_energy.h). Otherwise the
+ * node powers off with the rest queued, and sends it after the comparator has turned it
+ * back on, instead of browning out between a wake-up packet and its data packet.
+ *
+ * (5) With T1_AES (t1_aes.h) the data packets, and the end-of-burst packets, are encrypted
+ * and authenticated, ZETA_AIR_LEN(FRAME_DATA_LEN) bytes on air. The wake-up packet stays a
+ * plain '0', it only has to switch the receiver on. The receiver must be built with T1_AES
+ * too.
+ *
+ * (6) With T1_CRC (t1_crc.h) the same packets carry a CRC from the CRC module, after the
+ * encryption if there is any. The receiver must be built with T1_CRC too.
+ *
+ * (7) With T1_FRAME (t1_frame.h) a data packet is a frame: node ID, a sequence number kept
+ * in FRAM and a FRAME_DATA record holding the value itself, not offset by 0x21. The end of
+ * a burst is a FRAME_END record of the same length, its value the packets of the burst.
+ * The receiver must be built with T1_FRAME too.
+ *
+ * (8) With T1_DELTA (t1_delta.h) and TX_BURST the burst is one packet instead of
+ * TX_BURST_LEN + 1: its values delta compressed into a FRAME_DELTA record, written in place,
+ * then its FRAME_END. The receiver must be built with T1_DELTA too.
+ *
+ * (9) With T1_WAKE (t1_wake.h) the wake-up packet is followed by the code of the receiver
+ * meant, WAKE_DEST, as pulses for its wake-up detector. Other receivers built with T1_WAKE
+ * power off again before switching their radio on.
  */
 
-uint8_t i;
-uint8_t j;
-//***** Active operation ***********************************************************
-void active_operation(void)
+//#define TX_BURST  ///< "Uncomment" to send a burst of data packets per wake-up packet (3).
+//#define TX_SCHEDULE   ///< "Uncomment" to send only the pairs the stored energy covers (4).
+
+#define TX_PAIRS 16u     ///< Wake/data packet pairs per transmission.
+#define TX_BURST_LEN 4u         ///< TX_BURST: data packets per burst.
+#define TX_BURST_GAP_MS 50u     ///< TX_BURST: time between the packets of a burst.
+#define TX_SETUP_MS 5000u       ///< Radio set up before the first pair.
+#define TX_PAIR_MS 12000u       ///< From a wake-up packet to the next one.
+
+#if defined(T1_DELTA) && !defined(TX_BURST)
+#error "T1_DELTA compresses a burst into one packet, define TX_BURST too"
+#endif
+
+// EVENT_TIMER args.
+enum {
+    TICK = 0,   ///< Next step of the LED count.
+    TX_STEP     ///< Next step of the transmission.
+};
+
+// Transmission steps, each one waits for a timer before the next.
+enum {
+    S_RADIO = 0,    ///< Radio set up, 5 seconds before the first pair.
+    S_WAKE_OFF,     ///< Wake-up packet sent.
+    S_DATA,         ///< 2 seconds after the wake-up packet, send the data packet.
+    S_BURST,        ///< TX_BURST: next packet of the burst, or the end of it.
+    S_DATA_OFF,     ///< Data packet sent.
+    S_NEXT          ///< 10 seconds after the data packet, next pair or done.
+};
+
+static timer_id_t tick_timer = TIMER_NONE;
+static timer_id_t step_timer = TIMER_NONE;
+static uint8_t count;      ///< Active operation LED count.
+static uint8_t data;       ///< Next data value to transmit.
+static uint8_t pairs;      ///< Wake/data pairs transmitted.
+#if defined(TX_BURST) && !defined(T1_DELTA)
+static uint8_t burst;      ///< Data packets of the burst sent.
+#endif
+#ifdef TX_SCHEDULE
+#pragma PERSISTENT (tx_next)
+static uint8_t tx_next SIM_FRAM = 1;   ///< Next data value to queue.
+#endif // TX_SCHEDULE
+#ifdef T1_FRAME
+#pragma PERSISTENT (tx_seq)
+static uint8_t tx_seq SIM_FRAM = 0;    ///< Sequence number of the next frame.
+#endif // T1_FRAME
+static uint8_t step;       ///< Transmission step the timer is running for.
+static uint8_t sending;    ///< Transmission under way.
+
+static uint8_t tick_expired(void)
 {
-    // Hibernus
-    //__bis_SR_register(GIE);
-    Hibernus();
+    return event_post(EVENT_TIMER, TICK) == ERROR_OK;
+}
 
+static uint8_t step_expired(void)
+{
+    return event_post(EVENT_TIMER, TX_STEP) == ERROR_OK;
+}
+
+//***** Active operation ***********************************************************
+static void count_step(void)
+{
     // "Active operation" Indicated by LED count in Binary using Port 8 Pins 0,1,2,3.
-    while(COMPARATOR_ON){
-        for(i=0;i<16;i++){
-            led_set(i);
-            wait_one_second();
-        }
-    }
+    count = (count + 1) & 0x0F;
+    led_set(count);
+    Hibernus_safe_point();  // Nothing is half-done here, see HIBERNUS_HYBRID.
 }
 
 // ***** Transmit Packet ***********************************************************
-void transmit_packet(void){
+static void next_step(uint8_t s, uint16_t ms)
+{
+    step = s;
+    timer_add(&step_timer, ms, 0, step_expired);
+}
+
+static void send_byte(uint8_t byte)
+{
+    zeta_send_open(CHANNEL,1u);
+    zeta_write_byte(byte);
+    zeta_send_close();
+}
+
+#ifdef T1_DELTA
+// The burst from first on in one packet, compressed.
+static void send_burst(uint8_t first)
+{
+    uint8_t packet[ZETA_BUF_LEN(FRAME_DATA_LEN)], n = 0, *stream;
+    delta_enc_t delta;
+    frame_t f;
+
+    frame_begin(&f, packet, sizeof(packet), FRAME_NODE_ID, tx_seq++);
+    stream = frame_reserve(&f, FRAME_DELTA, FRAME_DELTA_MAX);
+    delta_begin(&delta, stream, FRAME_DELTA_MAX);
+    while ((n < TX_BURST_LEN) && (delta_put(&delta, (uint8_t)(first + n)) == ERROR_OK)) {
+        n++;
+    }
+    frame_trim(&f, stream, delta_end(&delta));
+    frame_put(&f, FRAME_END, &n, 1u);
+    frame_pad(&f, FRAME_DATA_LEN);
+    zeta_send_packet(packet, FRAME_DATA_LEN);
+}
+#else
+// Data packet, a record of the given type (FRAME_DATA or FRAME_END) or the raw byte.
+static void send_data(uint8_t type, uint8_t value)
+{
+    uint8_t packet[ZETA_BUF_LEN(FRAME_DATA_LEN)];
+#ifdef T1_FRAME
+    frame_t f;
+
+    frame_begin(&f, packet, sizeof(packet), FRAME_NODE_ID, tx_seq++);
+    frame_put(&f, type, &value, 1u);
+#else
+    // Offset by hex 21 for ascii format.
+    packet[0] = (type == FRAME_END) ? BURST_END : (uint8_t)(value + 0x21);
+#endif // T1_FRAME
+    zeta_send_packet(packet, FRAME_DATA_LEN);
+}
+#endif // T1_DELTA
+
+static void send_wake(void)
+{
+    /* Transmit dummy packet with data value 0 (i.e. nothing important) in it as a wake up signal to Rx!
+     * Transmit Mode: ATS - specify the channel & Packet Length
+     * (Packet length is in 8 bit bytes - i.e PL(1) = 0xFF, PL(2) = 0xFFFF, etc) */
+    send_byte('0');
+#ifdef T1_WAKE
+    wake_send(WAKE_DEST);
+#endif // T1_WAKE
+    led_set(0x0F);
+
+    // Wait 2 seconds for wake up packet to turn on & configure MCU-radio for packet to be received.
+    next_step(S_WAKE_OFF, 1000);
+}
+
+static void transmit_done(void)
+{
+    sending = 0;
+    if(!COMPARATOR_ON){
+        power_off();
+    }
+    event_stop();
+}
+
+#ifdef TX_SCHEDULE
+// Whether the stored energy covers ms of set up and a wake/data pair.
+static uint8_t can_send(uint16_t ms)
+{
+    uint16_t mv;
+    uint32_t need;
+
+    if (supply_mv(&mv) != ERROR_OK) {
+        return 0;
+    }
+    need = WAKE_PACKETS * energy_tx(1u, ZETA_RF_BAUD, ZETA_RF_POWER, mv)
+         + energy_tx(ZETA_AIR_LEN(FRAME_DATA_LEN), ZETA_RF_BAUD, ZETA_RF_POWER, mv)
+         + energy_wait(ZETA_I_READY_UA, (uint32_t) ms + TX_PAIR_MS, mv);
+    return energy_available(mv) >= need;
+}
+
+// Next queued value, if there is one and the energy for it.
+static void next_pair(void)
+{
+    if ((mailbox_peek(&data) != ERROR_OK) || !can_send(0)) {
+        transmit_done();
+        return;
+    }
+    send_wake();
+}
+#endif // TX_SCHEDULE
+
+static void transmit_start(void)
+{
+    sending = 1;
+    timer_cancel(&tick_timer);
+
+#ifdef TX_SCHEDULE
+    while (mailbox_push(tx_next) == ERROR_OK) {
+        tx_next = (tx_next & 0x0F) + 1;     // 1 to 16, as without TX_SCHEDULE.
+    }
+    if (!can_send(TX_SETUP_MS)) {
+        transmit_done();    // Not even one pair, leave the radio off.
+        return;
+    }
+#endif // TX_SCHEDULE
+
     //initialise radio.
     zeta_init();
 
@@ -71,57 +280,96 @@ void transmit_packet(void){
     led_clear();    // clear previous active operation LEDs.
 
     //wait 5 seconds
-    for(i=0;i<5;i++){
-        wait_one_second();
-    }
-
-    // Set zeta operating mode 2 for transmitting (ATM READY)
-    zeta_select_mode(0x2);
-
-    uint8_t data = 0x1;
-
-    for(i=0;i<16;i++){
-
-        /* Transmit dummy packet with data value 0 (i.e. nothing important) in it as a wake up signal to Rx!
-         * Transmit Mode: ATS - specify the channel & Packet Length
-         * (Packet length is in 8 bit bytes - i.e PL(1) = 0xFF, PL(2) = 0xFFFF, etc) */
-        zeta_send_open(CHANNEL,1u);
-        zeta_write_byte('0');
-        zeta_send_close();
-        led_set(0x0F);
+    next_step(S_RADIO, 5000);
+}
 
-        // Wait 2 seconds for wake up packet to turn on & configure MCU-radio for packet to be received.
-        wait_one_second();
+static void transmit_step(void)
+{
+    switch (step) {
+    case S_RADIO:
+        // Set zeta operating mode 2 for transmitting (ATM READY)
+        zeta_select_mode(0x2);
+        pairs = 0;
+#ifdef TX_SCHEDULE
+        next_pair();
+#else
+        data = 0x1;
+        send_wake();
+#endif // TX_SCHEDULE
+        break;
+    case S_WAKE_OFF:
         led_clear();
-        wait_one_second();
-
-        // Prepare data packet to be sent
-        uint8_t data_out = data + 0x21;         // offset by hex 21 for ascii format
-        uint8_t write_out[1u] = {data_out};
-
+        next_step(S_DATA, 1000);
+        break;
+    case S_DATA:
+#ifdef T1_DELTA
+        // Transmit the burst, one packet
+        send_burst(data);
+        led_set(data);
+#else
         // Transmit Data packet
-        zeta_send_open(CHANNEL,1u);
-        zeta_write_byte(write_out[0]);
-        zeta_send_close();
+        send_data(FRAME_DATA, data);
         led_set(data);
-
-        // Wait 10 seconds to indicate if packet received and to shut down Rx.
-        for(j=0;j<2;j++){
-            wait_one_second();
+#ifdef TX_BURST
+        burst = 1;
+        next_step(S_BURST, TX_BURST_GAP_MS);
+        break;
+    case S_BURST:
+        if (burst < TX_BURST_LEN) {
+            send_data(FRAME_DATA, data + burst);
+            burst++;
+            next_step(S_BURST, TX_BURST_GAP_MS);
+            break;
         }
+        send_data(FRAME_END, TX_BURST_LEN);
+#endif // TX_BURST
+#endif // T1_DELTA
+#ifdef TX_SCHEDULE
+        mailbox_pop(&data);     // Sent, off the queue.
+#endif // TX_SCHEDULE
 
+        // Wait 10 seconds to indicate if packet received and to shut down Rx.
+        next_step(S_DATA_OFF, 2000);
+        break;
+    case S_DATA_OFF:
         led_clear();
-
-        for(j=0;j<8;j++){
-            wait_one_second();
+        next_step(S_NEXT, 8000);
+        break;
+    case S_NEXT:
+#ifdef TX_SCHEDULE
+        if (++pairs < TX_PAIRS) {
+            next_pair();
+            break;
         }
-
-        // Clear led output
+#else
         data = data + 0x01;
+        if (++pairs < TX_PAIRS) {
+            send_wake();
+            break;
+        }
+#endif // TX_SCHEDULE
+        transmit_done();
+        break;
+    default:
+        break;
     }
+}
 
-    if(!COMPARATOR_ON){
-        power_off();
+// ***** Events ********************************************************************
+static void on_timer(uint8_t arg)
+{
+    if (arg == TICK) {
+        count_step();
+    }
+    else {
+        transmit_step();
+    }
+}
+
+static void on_comparator(uint8_t level)
+{
+    if (!level && !sending) {
+        transmit_start();
     }
 }
 
@@ -140,9 +388,19 @@ int main(void)
     clock_init();
     spi_init();
 
-    active_operation();
+    // Hibernus, a restored image carries on in its own event loop.
+    Hibernus();
 
-    if(!COMPARATOR_ON){
-        transmit_packet();
+    event_init();
+    event_handler(EVENT_TIMER, on_timer);
+    event_handler(EVENT_COMPARATOR, on_comparator);
+
+    if(COMPARATOR_ON){
+        led_set(count);
+        timer_add(&tick_timer, 1000, 1000, tick_expired);
+    }
+    else{
+        transmit_start();
     }
+    event_run();
 }
@@ -0,0 +1,182 @@
+#include <Proj_library/tasks/tasks.h>       //task-based runtime (1)
+#include <Proj_library/h_files/t1_util.h>   //system set up (pins, functions etc.)
+#include <Proj_library/h_files/t1_zeta.h>   //radio functions
+#include <Proj_library/h_files/t1_frame.h>  //payload frames (2)
+#include <Proj_library/h_files/t1_wake.h>   //wake codes (3)
+
+/* (1) The transmitter of t1_main_Tx.c on the task-based runtime instead of Hibernus,
+ * by P. Krawiec. Build one of the two mains, not both. See Proj_library/tasks/tasks.h.
+ *
+ * The active operation and the transmit sequence are split into tasks. Each task ends
+ * by committing the few variables the sequence needs (tx_vars_t) and naming the next
+ * task. After a power loss the node resumes at the task that was cut short:
+ *
+ *      T_COUNT     one step of the LED count, while the comparator output is high.
+ *      T_RADIO     comparator output low: prepare the radio (5 seconds).
+ *      T_WAKE      transmit the dummy wake-up packet, wait 2 seconds.
+ *      T_DATA      transmit the data packet, wait 10 seconds. 16 wake/data pairs.
+ *      T_DONE      turn off the power to the MCU, or go back to counting if the
+ *                  comparator output is high again.
+ *
+ * A pair cut short is sent again, so the receiver may see a data packet twice.
+ *
+ * (2) With T1_FRAME (t1_frame.h) the data packet is a frame, as from t1_main_Tx.c. Its
+ * sequence number is committed with the task state, so a packet sent again carries the
+ * same one and the receiver can tell it apart.
+ *
+ * (3) With T1_WAKE (t1_wake.h) the wake-up packet is followed by WAKE_DEST's code, as from
+ * t1_main_Tx.c. A wake-up cut short is sent again whole, code and all.
+ */
+
+//***** Tasks *********************************************************************
+enum {
+    T_COUNT = 0, T_RADIO, T_WAKE, T_DATA, T_DONE, TX_TASKS
+};
+
+typedef struct {
+    uint8_t count;      ///< Active operation LED count.
+    uint8_t data;       ///< Next data value to transmit.
+    uint8_t pairs;      ///< Wake/data pairs transmitted.
+#ifdef T1_FRAME
+    uint8_t seq;        ///< Sequence number of the next frame.
+#endif // T1_FRAME
+} tx_vars_t;
+
+#define TX_VARS ((tx_vars_t *) task_vars)
+
+// Radio set up in this power cycle. Kept in RAM, the radio loses its set up with power.
+static uint8_t radio_ready;
+
+static void radio_up(void)
+{
+    if (!radio_ready) {
+        zeta_init();
+        zeta_select_mode(0x2);  // Transmitting (ATM READY).
+        radio_ready = 1;
+    }
+}
+
+// ***** Active operation **********************************************************
+static void task_count(void)
+{
+    // "Active operation" Indicated by LED count in Binary using Port 8 Pins 0,1,2,3.
+    led_set(TX_VARS->count);
+    wait_one_second();
+    TX_VARS->count = (TX_VARS->count + 1) & 0x0F;
+
+    task_next(COMPARATOR_ON ? T_COUNT : T_RADIO);
+}
+
+// ***** Transmit Packet ***********************************************************
+static void task_radio(void)
+{
+    uint8_t k;
+
+    // Turning off Comparator Interrupt, there is no Hibernus to serve it.
+    P4IE &= ~(EXT_COMP);
+
+    // For debugging, Indicate function is running by setting P1.0 on.
+    P1OUT |= BIT1;
+    led_clear();    // clear previous active operation LEDs.
+
+    //wait 5 seconds
+    for(k=0;k<5;k++){
+        wait_one_second();
+    }
+    radio_up();
+
+    TX_VARS->data = 0x1;
+    TX_VARS->pairs = 0;
+    task_next(T_WAKE);
+}
+
+static void task_wake(void)
+{
+    radio_up();
+
+    // Dummy packet as a wake up signal to Rx.
+    zeta_send_open(CHANNEL,1u);
+    zeta_write_byte('0');
+    zeta_send_close();
+#ifdef T1_WAKE
+    wake_send(WAKE_DEST);
+#endif // T1_WAKE
+    led_set(0x0F);
+
+    // Wait 2 seconds for wake up packet to turn on & configure MCU-radio for packet to be received.
+    wait_one_second();
+    led_clear();
+    wait_one_second();
+
+    task_next(T_DATA);
+}
+
+static void task_data(void)
+{
+    uint8_t packet[ZETA_BUF_LEN(FRAME_DATA_LEN)];
+    uint8_t k;
+#ifdef T1_FRAME
+    frame_t f;
+
+    frame_begin(&f, packet, sizeof(packet), FRAME_NODE_ID, TX_VARS->seq);
+    frame_put(&f, FRAME_DATA, &TX_VARS->data, 1u);
+    frame_pad(&f, FRAME_DATA_LEN);
+#else
+    packet[0] = TX_VARS->data + 0x21;   // Offset by hex 21 for ascii format.
+#endif // T1_FRAME
+
+    radio_up();
+
+    // Data packet. Encrypted with T1_AES (t1_aes.h), a packet sent again goes with a new
+    // nonce.
+    zeta_send_packet(packet, FRAME_DATA_LEN);
+    led_set(TX_VARS->data);
+
+    // Wait 10 seconds to indicate if packet received and to shut down Rx.
+    for(k=0;k<2;k++){
+        wait_one_second();
+    }
+    led_clear();
+    for(k=0;k<8;k++){
+        wait_one_second();
+    }
+
+    TX_VARS->data++;
+    TX_VARS->pairs++;
+#ifdef T1_FRAME
+    TX_VARS->seq++;
+#endif // T1_FRAME
+    task_next((TX_VARS->pairs < 16) ? T_WAKE : T_DONE);
+}
+
+static void task_done(void)
+{
+    if(!COMPARATOR_ON){
+        power_off();
+    }
+
+    P1OUT &= ~BIT1;
+    task_next(T_COUNT);
+}
+
+static const task_t tx_tasks[TX_TASKS] = {
+    task_count, task_radio, task_wake, task_data, task_done
+};
+
+// ***** Main Program **************************************************************
+
+int main(void)
+{
+    // Disable the GPIO power-on default high-impedance mode on configured port settings.
+    PM5CTL0 &= ~(LOCKLPM5);
+
+    //  stop watchdog timer
+    WDTCTL = WDTPW | WDTHOLD;
+
+    //  Initialise system.
+    io_init();
+    clock_init();
+    spi_init();
+
+    task_run(tx_tasks, TX_TASKS, sizeof(tx_vars_t));
+}
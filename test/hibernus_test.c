@@ -18,8 +18,6 @@
 #include <Proj_library/hibernus/hibernation_5994.h> //hibernus by D.Balsamo (1)
 #include <Proj_library/h_files/t1_util.h>   //system set up (pins, functions etc.)
 
-volatile uint8_t timerB_exit = 0;
-
 int main (void){
 
     // Disable the GPIO power-on default high-impedance mode on configured port settings.
@@ -43,21 +41,8 @@ int main (void){
             //__delay_cycles(8e5);
 
             // wait 1 second
-            timerB_start();
-            while(!timerB_exit){
-                ;   // do nothing while timerB_exit = 0, exit on timerB_exit = 1.
-            }
-            timerB_exit = 0;
+            wait_one_second();
 
         }
     }
 }
-
-#pragma vector=TIMER0_B0_VECTOR
-__interrupt void TIMER0_B0_ISR(void)
-{
-    /* Timer to count 1 seconds */
-
-    timerB_stop();  // Stop & reset timer.
-    timerB_exit = 1; // Assert exit flag.
-}
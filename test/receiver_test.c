@@ -27,11 +27,11 @@ int main(void)
         //Indicate receiver function is running
         P1OUT |= BIT1;
 
-        uint8_t incoming_packet[1u + 4u] = {0};
+        uint8_t incoming_packet[4u + ZETA_BUF_LEN(1u)] = {0};
         uint8_t data_in = 0;
 
         // Receive mode: ATR - Channel, Packet Length
-        zeta_rx_mode(CHANNEL, sizeof(incoming_packet) - 4u);
+        zeta_rx_mode(CHANNEL, ZETA_AIR_LEN(1u));
 
         if(zeta_rx_packet(incoming_packet)){
             ;